@@ -0,0 +1,228 @@
+// MIT License
+//
+// Copyright (c) 2024 superKoder (github.com/superKoder/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The ABOVE COPYRIGHT notice and this permission notice SHALL BE INCLUDED in all
+// copies or substantial portions of the Software.
+//
+// The software is provided "as is", without warranty of any kind, express or
+// implied, including but not limited to the warranties of merchantability,
+// fitness for a particular purpose and noninfringement. In no event shall the
+// authors or copyright holders be liable for any claim, damages or other
+// liability, whether in an action of contract, tort or otherwise, arising from,
+// out of or in connection with the software or the use or other dealings in the
+// software.
+
+#ifndef HANDY_MP_BENCH_ROM_H_
+#define HANDY_MP_BENCH_ROM_H_
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * A small BS93 homebrew program, so the benchmark can run without any
+ * cartridge at hand. Every frame it:
+ *
+ *  - does some CPU work, including decimal mode and the Suzy multiplier,
+ *  - reprograms and paints a list of 8 sprites, one of every sprite type,
+ *    packed and literal, 1 to 4 bpp, scaled, tilted and clipped,
+ *  - cycles a palette entry,
+ *  - then idles until the frame interrupt.
+ *
+ * Audio channel 0 runs throughout. Holding button A pauses everything but
+ * the idle loop.
+ *
+ * Most of the image is zeros, so only the parts that aren't are kept here.
+ */
+struct BenchRomSegment
+{
+    uint16_t address;
+    uint8_t const *data;
+    size_t size;
+};
+
+static uint8_t const kBenchRomProgram[] = {
+    0x80, 0x08, 0x02, 0x00, 0x2f, 0xdd, 0x42, 0x53, 0x39, 0x33, 0x78, 0xd8, 0xa2, 0xff, 0x9a, 0xa9,
+    0x08, 0x8d, 0xf9, 0xff, 0xa9, 0xb8, 0x8d, 0xfe, 0xff, 0xa9, 0x03, 0x8d, 0xff, 0xff, 0xa9, 0xb8,
+    0x8d, 0xfa, 0xff, 0xa9, 0x03, 0x8d, 0xfb, 0xff, 0xa9, 0x01, 0x8d, 0x90, 0xfc, 0xa9, 0x00, 0x8d,
+    0x92, 0xfc, 0xa9, 0xf3, 0x8d, 0x83, 0xfc, 0xa9, 0x00, 0x8d, 0x08, 0xfc, 0xa9, 0xc0, 0x8d, 0x09,
+    0xfc, 0xa9, 0x00, 0x8d, 0x0a, 0xfc, 0xa9, 0xa0, 0x8d, 0x0b, 0xfc, 0xa9, 0x00, 0x8d, 0x04, 0xfc,
+    0xa9, 0x00, 0x8d, 0x05, 0xfc, 0xa9, 0x00, 0x8d, 0x06, 0xfc, 0xa9, 0x00, 0x8d, 0x07, 0xfc, 0xa9,
+    0x7f, 0x8d, 0x28, 0xfc, 0xa9, 0x00, 0x8d, 0x29, 0xfc, 0xa9, 0x7f, 0x8d, 0x2a, 0xfc, 0xa9, 0x00,
+    0x8d, 0x2b, 0xfc, 0xa9, 0x20, 0x8d, 0x24, 0xfc, 0xa9, 0x00, 0x8d, 0x25, 0xfc, 0xa9, 0x00, 0x8d,
+    0x94, 0xfd, 0xa9, 0xc0, 0x8d, 0x95, 0xfd, 0xa2, 0x00, 0xbd, 0xc4, 0x03, 0x9d, 0xa0, 0xfd, 0xbd,
+    0xd4, 0x03, 0x9d, 0xb0, 0xfd, 0xe8, 0xe0, 0x10, 0xd0, 0xef, 0xa9, 0x9f, 0x8d, 0x09, 0xfd, 0xa9,
+    0x40, 0x8d, 0x20, 0xfd, 0xa9, 0x31, 0x8d, 0x21, 0xfd, 0xa9, 0x57, 0x8d, 0x23, 0xfd, 0xa9, 0x40,
+    0x8d, 0x24, 0xfd, 0xa9, 0x1c, 0x8d, 0x25, 0xfd, 0x9c, 0x50, 0xfd, 0xa9, 0x00, 0x8d, 0x80, 0x00,
+    0x8d, 0x82, 0x00, 0x8d, 0x83, 0x00, 0x58, 0xad, 0xb0, 0xfc, 0x29, 0x01, 0xf0, 0x0b, 0xad, 0x80,
+    0x00, 0xcd, 0x80, 0x00, 0xf0, 0xfb, 0x4c, 0xbd, 0x02, 0xad, 0x80, 0x00, 0x18, 0x6d, 0x82, 0x00,
+    0x8d, 0x82, 0x00, 0xf8, 0xad, 0x83, 0x00, 0x18, 0x69, 0x19, 0x8d, 0x83, 0x00, 0xe9, 0x07, 0xd8,
+    0x4d, 0x82, 0x00, 0x2a, 0x8d, 0x84, 0x00, 0x6e, 0x82, 0x00, 0x0e, 0x84, 0x00, 0x4e, 0x83, 0x00,
+    0x2c, 0x84, 0x00, 0x50, 0x03, 0xee, 0x82, 0x00, 0xa0, 0x28, 0x98, 0x6d, 0x84, 0x00, 0x8d, 0x84,
+    0x00, 0x88, 0xd0, 0xf6, 0xad, 0x80, 0x00, 0x8d, 0x52, 0xfc, 0xa9, 0x13, 0x8d, 0x53, 0xfc, 0xad,
+    0x84, 0x00, 0x8d, 0x54, 0xfc, 0xa9, 0x03, 0x8d, 0x55, 0xfc, 0xad, 0x60, 0xfc, 0x4d, 0x82, 0x00,
+    0x8d, 0x82, 0x00, 0xad, 0xb0, 0xfc, 0x8d, 0x88, 0x00, 0x29, 0x10, 0xf0, 0x03, 0xce, 0x47, 0x30,
+    0xad, 0x88, 0x00, 0x29, 0x20, 0xf0, 0x03, 0xee, 0x47, 0x30, 0xad, 0x88, 0x00, 0x29, 0x40, 0xf0,
+    0x03, 0xce, 0x49, 0x30, 0xad, 0x88, 0x00, 0x29, 0x80, 0xf0, 0x03, 0xee, 0x49, 0x30, 0xee, 0x87,
+    0x30, 0xad, 0x87, 0x30, 0xc9, 0xbe, 0xd0, 0x0a, 0xa9, 0xe0, 0x8d, 0x87, 0x30, 0xa9, 0xff, 0x8d,
+    0x88, 0x30, 0xad, 0x87, 0x30, 0xd0, 0x03, 0x9c, 0x88, 0x30, 0xad, 0x80, 0x00, 0x29, 0x3f, 0x8d,
+    0x51, 0x31, 0xad, 0x80, 0x00, 0x4a, 0x8d, 0x09, 0x31, 0xad, 0x80, 0x00, 0x29, 0x07, 0x09, 0x01,
+    0x8d, 0x0c, 0x30, 0xad, 0x80, 0x00, 0x8d, 0xa5, 0xfd, 0xa9, 0x00, 0x8d, 0x10, 0xfc, 0xa9, 0x30,
+    0x8d, 0x11, 0xfc, 0xa9, 0x05, 0x8d, 0x91, 0xfc, 0x9c, 0x90, 0xfd, 0x9c, 0x91, 0xfd, 0xad, 0x20,
+    0x30, 0x4d, 0x82, 0x00, 0x8d, 0x82, 0x00, 0xad, 0x80, 0x00, 0xcd, 0x80, 0x00, 0xf0, 0xfb, 0x4c,
+    0xbd, 0x02, 0x48, 0xad, 0x81, 0xfd, 0x8d, 0x80, 0xfd, 0xee, 0x80, 0x00, 0x68, 0x40, 0x00, 0x03,
+    0x06, 0x09, 0x0c, 0x0f, 0x02, 0x05, 0x08, 0x0b, 0x0e, 0x01, 0x04, 0x07, 0x0a, 0x0d, 0x0f, 0x5e,
+    0xad, 0xfc, 0x4b, 0x9a, 0xe9, 0x38, 0x87, 0xd6, 0x25, 0x74, 0xc3, 0x12, 0x61, 0xb0,
+};
+
+static uint8_t const kBenchRomSprites[] = {
+    0x0b, 0x12, 0x34, 0x56, 0x78, 0x9a, 0xbc, 0xde, 0xf1, 0x23, 0x45, 0x00, 0x00, 0x0c, 0xf8, 0x09,
+    0x1a, 0x2b, 0x3c, 0x4d, 0x5e, 0x6f, 0x78, 0x00, 0x00, 0x0c, 0xf8, 0x81, 0x92, 0xa3, 0xb4, 0xc5,
+    0xd6, 0xe7, 0xf0, 0x00, 0x00, 0x0c, 0xf9, 0x18, 0x0b, 0x3a, 0x2d, 0x5c, 0x4f, 0x7e, 0x68, 0x00,
+    0x00, 0x0c, 0xf9, 0x90, 0x83, 0xb2, 0xa5, 0xd4, 0xc7, 0xf6, 0xe0, 0x00, 0x00, 0x0c, 0xfa, 0x2b,
+    0x38, 0x09, 0x1e, 0x6f, 0x7c, 0x4d, 0x58, 0x00, 0x00, 0x0c, 0xfa, 0xa3, 0xb0, 0x81, 0x96, 0xe7,
+    0xf4, 0xc5, 0xd0, 0x00, 0x00, 0x0c, 0xfb, 0x3a, 0x29, 0x18, 0x0f, 0x7e, 0x6d, 0x5c, 0x48, 0x00,
+    0x00, 0x0c, 0xfb, 0xb2, 0xa1, 0x90, 0x87, 0xf6, 0xe5, 0xd4, 0xc0, 0x00, 0x00, 0x0c, 0xfc, 0x4d,
+    0x5e, 0x6f, 0x78, 0x09, 0x1a, 0x2b, 0x38, 0x00, 0x00, 0x0c, 0xfc, 0xc5, 0xd6, 0xe7, 0xf0, 0x81,
+    0x92, 0xa3, 0xb0, 0x00, 0x00, 0x0c, 0xfd, 0x5c, 0x4f, 0x7e, 0x69, 0x18, 0x0b, 0x3a, 0x28, 0x00,
+    0x00, 0x0c, 0xfd, 0xd4, 0xc7, 0xf6, 0xe1, 0x90, 0x83, 0xb2, 0xa0, 0x00, 0x00, 0x0c, 0xfe, 0x6f,
+    0x7c, 0x4d, 0x5a, 0x2b, 0x38, 0x09, 0x18, 0x00, 0x00, 0x0c, 0xfe, 0xe7, 0xf4, 0xc5, 0xd2, 0xa3,
+    0xb0, 0x81, 0x90, 0x00, 0x00, 0x0c, 0xff, 0x7e, 0x6d, 0x5c, 0x4b, 0x3a, 0x29, 0x18, 0x08, 0x00,
+    0x00, 0x0c, 0xff, 0xf6, 0xe5, 0xd4, 0xc3, 0xb2, 0xa1, 0x90, 0x80, 0x00, 0x00, 0x00, 0x00, 0x07,
+    0xd8, 0xd8, 0xd8, 0xd8, 0x00, 0x00, 0x07, 0xdb, 0x63, 0x63, 0x60, 0x00, 0x00, 0x07, 0xdd, 0x8d,
+    0x8d, 0x88, 0x00, 0x00, 0x07, 0xde, 0x36, 0x36, 0x30, 0x00, 0x00, 0x07, 0xd8, 0xd8, 0xd8, 0xd8,
+    0x00, 0x00, 0x07, 0xdb, 0x63, 0x63, 0x60, 0x00, 0x00, 0x07, 0xdd, 0x8d, 0x8d, 0x88, 0x00, 0x00,
+    0x07, 0xde, 0x36, 0x36, 0x30, 0x00, 0x00, 0x07, 0xd8, 0xd8, 0xd8, 0xd8, 0x00, 0x00, 0x07, 0xdb,
+    0x63, 0x63, 0x60, 0x00, 0x00, 0x00, 0x00, 0x03, 0x33, 0x33, 0x03, 0xcc, 0xcc, 0x03, 0x33, 0x33,
+    0x03, 0xcc, 0xcc, 0x03, 0x33, 0x33, 0x03, 0xcc, 0xcc, 0x03, 0x33, 0x33, 0x03, 0xcc, 0xcc, 0x00,
+    0x00, 0x04, 0x48, 0x00, 0x00, 0x07, 0xc8, 0x29, 0xcb, 0xb8, 0x20, 0x00, 0x07, 0xc8, 0x53, 0x05,
+    0x30, 0x40, 0x00, 0x07, 0xc8, 0x78, 0xce, 0xa8, 0x60, 0x00, 0x07, 0xc8, 0x82, 0x08, 0x20, 0x80,
+    0x00, 0x07, 0xc8, 0xab, 0xc3, 0x98, 0xa0, 0x00, 0x01, 0x07, 0xb8, 0x29, 0xcb, 0xb8, 0x00, 0x00,
+    0x07, 0xba, 0x72, 0xee, 0x08, 0x00, 0x00, 0x07, 0xbc, 0xbb, 0x82, 0x98, 0x00, 0x00, 0x07, 0xbe,
+    0xe0, 0xa7, 0x28, 0x00, 0x00, 0x07, 0xb8, 0x29, 0xcb, 0xb8, 0x00, 0x00, 0x00, 0x00, 0x08, 0xbf,
+    0x89, 0x1a, 0x2b, 0x78, 0x00, 0x00, 0x08, 0xbf, 0x91, 0xa2, 0xb3, 0xf8, 0x00, 0x00, 0x08, 0xbf,
+    0x9a, 0x2b, 0x3c, 0x78, 0x00, 0x00, 0x08, 0xbf, 0xa2, 0xb3, 0xc4, 0xf8, 0x00, 0x00, 0x08, 0xbf,
+    0xab, 0x3c, 0x4d, 0x78, 0x00, 0x00, 0x08, 0xbf, 0xb3, 0xc4, 0xd5, 0xf8, 0x00, 0x00, 0x08, 0xbf,
+    0xbc, 0x4d, 0x5e, 0x78, 0x00, 0x00, 0x08, 0xbf, 0xc4, 0xd5, 0xe6, 0xf8, 0x00, 0x00, 0x08, 0xbf,
+    0xcd, 0x5e, 0x6f, 0x78, 0x00, 0x00, 0x08, 0xaf, 0xd5, 0xe6, 0xf0, 0x7c, 0x00, 0x00, 0x08, 0xbf,
+    0xde, 0x6f, 0x78, 0x78, 0x00, 0x00, 0x08, 0xbf, 0xe6, 0xf7, 0x80, 0xf8, 0x00, 0x00, 0x00, 0x00,
+    0x07, 0xaf, 0x09, 0x72, 0x28, 0x00, 0x00, 0x07, 0xa8, 0x0f, 0x1a, 0x70, 0x00, 0x00, 0x07, 0xa8,
+    0x71, 0x1f, 0x28, 0x00, 0x00, 0x07, 0xaf, 0x09, 0x72, 0x28, 0x00, 0x00, 0x07, 0xa8, 0x0f, 0x1a,
+    0x70, 0x00, 0x00, 0x07, 0xa8, 0x71, 0x1f, 0x28, 0x00, 0x00, 0x00, 0x00, 0x0e, 0x10, 0x08, 0x44,
+    0x42, 0x31, 0x20, 0x94, 0x4c, 0x27, 0x14, 0x0a, 0x40, 0x00, 0x0e, 0x10, 0x88, 0x84, 0x62, 0x41,
+    0x28, 0x98, 0x4e, 0x28, 0x14, 0x8a, 0x80, 0x00, 0x0e, 0x11, 0x08, 0xc4, 0x82, 0x51, 0x30, 0x9c,
+    0x50, 0x29, 0x15, 0x0a, 0xc0, 0x00, 0x0e, 0x11, 0x89, 0x04, 0xa2, 0x61, 0x38, 0xa0, 0x52, 0x2a,
+    0x15, 0x8b, 0x00, 0x00, 0x0e, 0x12, 0x09, 0x44, 0xc2, 0x71, 0x40, 0xa4, 0x54, 0x2b, 0x16, 0x0b,
+    0x40, 0x00, 0x0e, 0x12, 0x89, 0x84, 0xe2, 0x81, 0x48, 0xa8, 0x56, 0x2c, 0x16, 0x8b, 0x80, 0x00,
+    0x0e, 0x13, 0x09, 0xc5, 0x02, 0x91, 0x50, 0xac, 0x58, 0x2d, 0x17, 0x0b, 0xc0, 0x00, 0x0e, 0x13,
+    0x8a, 0x05, 0x22, 0xa1, 0x58, 0xb0, 0x5a, 0x2e, 0x17, 0x88, 0x00, 0x00, 0x0e, 0x14, 0x0a, 0x45,
+    0x42, 0xb1, 0x60, 0xb4, 0x5c, 0x2f, 0x10, 0x08, 0x40, 0x00, 0x0e, 0x14, 0x8a, 0x85, 0x62, 0xc1,
+    0x68, 0xb8, 0x5e, 0x20, 0x10, 0x88, 0x80, 0x00, 0x0e, 0x15, 0x0a, 0xc5, 0x82, 0xd1, 0x70, 0xbc,
+    0x40, 0x21, 0x11, 0x08, 0xc0, 0x00, 0x0e, 0x15, 0x8b, 0x05, 0xa2, 0xe1, 0x78, 0x80, 0x42, 0x22,
+    0x11, 0x89, 0x00, 0x00, 0x0e, 0x16, 0x0b, 0x45, 0xc2, 0xf1, 0x00, 0x84, 0x44, 0x23, 0x12, 0x09,
+    0x40, 0x00, 0x0e, 0x16, 0x8b, 0x85, 0xe2, 0x01, 0x08, 0x88, 0x46, 0x24, 0x12, 0x89, 0x80, 0x00,
+    0x0e, 0x17, 0x0b, 0xc4, 0x02, 0x11, 0x10, 0x8c, 0x48, 0x25, 0x13, 0x09, 0xc0, 0x00, 0x0e, 0x17,
+    0x88, 0x04, 0x22, 0x21, 0x18, 0x90, 0x4a, 0x26, 0x13, 0x8a, 0x00, 0x00, 0x0e, 0x10, 0x08, 0x44,
+    0x42, 0x31, 0x20, 0x94, 0x4c, 0x27, 0x14, 0x0a, 0x40, 0x00, 0x0e, 0x10, 0x88, 0x84, 0x62, 0x41,
+    0x28, 0x98, 0x4e, 0x28, 0x14, 0x8a, 0x80, 0x00, 0x0e, 0x11, 0x08, 0xc4, 0x82, 0x51, 0x30, 0x9c,
+    0x50, 0x29, 0x15, 0x0a, 0xc0, 0x00, 0x0e, 0x11, 0x89, 0x04, 0xa2, 0x61, 0x38, 0xa0, 0x52, 0x2a,
+    0x15, 0x8b,
+};
+
+static uint8_t const kBenchRomScb0[] = {
+    0xc1, 0x90, 0x20, 0x40, 0x30, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x00, 0x66, 0x01,
+    0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef,
+};
+
+static uint8_t const kBenchRomScb1[] = {
+    0xc4, 0x00, 0x02, 0x80, 0x30, 0x0d, 0x20, 0x28, 0x00, 0x1e, 0x00, 0x01, 0x23, 0x45, 0x67, 0x89,
+    0xab, 0xcd, 0xef,
+};
+
+static uint8_t const kBenchRomScb2[] = {
+    0x42, 0x00, 0x03, 0xc0, 0x30, 0xcf, 0x20, 0x64, 0x00, 0x32, 0x00, 0x01, 0x23, 0x45, 0x67, 0x89,
+    0xab, 0xcd, 0xef,
+};
+
+static uint8_t const kBenchRomScb3[] = {
+    0x26, 0xa0, 0x04, 0x00, 0x31, 0x17, 0x21, 0x50, 0x00, 0x14, 0x00, 0x00, 0x02, 0x00, 0x02, 0x10,
+    0x00, 0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef,
+};
+
+static uint8_t const kBenchRomScb4[] = {
+    0x87, 0x00, 0x05, 0x40, 0x31, 0x31, 0x21, 0x78, 0x00, 0x3c, 0x00, 0x01, 0x23, 0x45, 0x67, 0x89,
+    0xab, 0xcd, 0xef,
+};
+
+static uint8_t const kBenchRomScb5[] = {
+    0xc3, 0x30, 0x06, 0x80, 0x31, 0x7e, 0x21, 0x14, 0x00, 0x46, 0x00, 0x80, 0x01, 0x80, 0x02, 0x08,
+    0x00, 0x40, 0x00, 0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef,
+};
+
+static uint8_t const kBenchRomScb6[] = {
+    0xc0, 0x00, 0x07, 0xc0, 0x31, 0xe0, 0x21, 0x96, 0x00, 0x5a, 0x00, 0x01, 0x23, 0x45, 0x67, 0x89,
+    0xab, 0xcd, 0xef,
+};
+
+static uint8_t const kBenchRomScb7[] = {
+    0xc5, 0x00, 0x08, 0x00, 0x00, 0x0c, 0x22, 0xf6, 0xff, 0xfb, 0xff, 0x01, 0x23, 0x45, 0x67, 0x89,
+    0xab, 0xcd, 0xef,
+};
+
+static BenchRomSegment const kBenchRomSegments[] = {
+    {0x01f6, kBenchRomProgram, sizeof(kBenchRomProgram)},
+    {0x2000, kBenchRomSprites, sizeof(kBenchRomSprites)},
+    {0x3000, kBenchRomScb0, sizeof(kBenchRomScb0)},
+    {0x3040, kBenchRomScb1, sizeof(kBenchRomScb1)},
+    {0x3080, kBenchRomScb2, sizeof(kBenchRomScb2)},
+    {0x30c0, kBenchRomScb3, sizeof(kBenchRomScb3)},
+    {0x3100, kBenchRomScb4, sizeof(kBenchRomScb4)},
+    {0x3140, kBenchRomScb5, sizeof(kBenchRomScb5)},
+    {0x3180, kBenchRomScb6, sizeof(kBenchRomScb6)},
+    {0x31c0, kBenchRomScb7, sizeof(kBenchRomScb7)},
+};
+
+static uint16_t const kBenchRomLoadAddress = 0x01f6;
+static uint16_t const kBenchRomEnd = 0x31d3;
+
+/**
+ * The complete BS93 image, as it would be read from disk.
+ */
+inline std::vector<uint8_t> BenchRomImage()
+{
+    std::vector<uint8_t> image(kBenchRomEnd - kBenchRomLoadAddress);
+    for (auto const &segment : kBenchRomSegments) {
+        std::copy(segment.data,
+                  segment.data + segment.size,
+                  image.begin() + (segment.address - kBenchRomLoadAddress));
+    }
+    return image;
+}
+
+/**
+ * A BS93 program that only keeps the CPU busy: a fixed mix of loads,
+ * stores, arithmetic (binary and decimal), shifts, stack operations,
+ * branches and subroutine calls, in an endless loop with interrupts off.
+ */
+static uint8_t const kOpcodeMixImage[] = {
+    0x80, 0x08, 0x02, 0x00, 0x00, 0x74, 0x42, 0x53, 0x39, 0x33, 0x78, 0xd8, 0xa2, 0xff, 0x9a, 0xa9,
+    0x00, 0x85, 0x84, 0xa9, 0x04, 0x85, 0x85, 0xa5, 0x80, 0x18, 0x69, 0x13, 0x85, 0x80, 0xa2, 0x10,
+    0xbd, 0x00, 0x03, 0x4d, 0x80, 0x00, 0x9d, 0x00, 0x03, 0x0a, 0x2e, 0x81, 0x00, 0xca, 0xd0, 0xf0,
+    0xa0, 0x08, 0x20, 0x64, 0x02, 0xe6, 0x82, 0x2c, 0x82, 0x00, 0x30, 0x01, 0xea, 0xb1, 0x84, 0x09,
+    0x01, 0x91, 0x84, 0x08, 0x68, 0x29, 0xc3, 0xaa, 0x8a, 0x48, 0x28, 0xf8, 0x69, 0x05, 0xed, 0x81,
+    0x00, 0xd8, 0xda, 0x5a, 0x7a, 0xfa, 0x1a, 0x3a, 0x0c, 0x83, 0x00, 0x1c, 0x83, 0x00, 0xa5, 0x81,
+    0x4a, 0x6a, 0xc9, 0x40, 0xb0, 0x05, 0x38, 0xe9, 0x03, 0x85, 0x81, 0x4c, 0x0d, 0x02, 0xc8, 0xc0,
+    0x20, 0x90, 0xfb, 0x60
+};
+
+#endif // HANDY_MP_BENCH_ROM_H_
@@ -0,0 +1,843 @@
+// MIT License
+//
+// Copyright (c) 2024 superKoder (github.com/superKoder/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The ABOVE COPYRIGHT notice and this permission notice SHALL BE INCLUDED in all
+// copies or substantial portions of the Software.
+//
+// The software is provided "as is", without warranty of any kind, express or
+// implied, including but not limited to the warranties of merchantability,
+// fitness for a particular purpose and noninfringement. In no event shall the
+// authors or copyright holders be liable for any claim, damages or other
+// liability, whether in an action of contract, tort or otherwise, arising from,
+// out of or in connection with the software or the use or other dealings in the
+// software.
+
+// Headless benchmark for the emulation core.
+//
+// Boots a cartridge (or the bundled test program) for a number of players,
+// runs it for a number of frames the same way `retro_run()` does and prints
+// how fast that went. Every run starts from a fresh boot, so runs of the
+// same build on the same machine do the same work and can be compared.
+//
+//   handy_bench [options] [game.lnx|game.o]
+//
+// Run `handy_bench --help` for the options.
+
+#include "handy.h"
+#include "multi/multi_system.h"
+#include "multi/layout.h"
+#include "bench_rom.h"
+
+#if HANDY_CPU_PROFILE
+#include <streams/file_stream.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options
+{
+    std::string game_path;
+    std::string bios_path;
+    std::string profile_path;
+    int breakpoint = -1;
+    int watchpoint = -1;
+    int players = 1;
+    int frames = 3000;
+    int warmup = 75;
+    int repeat = 3;
+    unsigned threads = 1;
+    bool video = true;
+    bool audio = true;
+    bool comlynx = false;
+    bool idle_skip = false;
+    bool predecode = false;
+    bool sprite_cache = false;
+    bool simd = true;
+    bool jit = false;
+    bool verify = false;
+    bool dispatch = false;
+    bool compare_jit = false;
+    bool compare_display = false;
+    bool verbose = false;
+};
+
+/**
+ * Where the time of a frame went. `emulate` is everything the consoles do
+ * (CPU, Mikey timers and line rendering, Suzy sprites), `audio` is fetching
+ * and mixing the samples and `video` is the work done on the screens after
+ * the frame, like the dirty tracking.
+ */
+struct Phases
+{
+    double emulate = 0;
+    double audio = 0;
+    double video = 0;
+
+    double Total() const { return emulate + audio + video; }
+};
+
+/**
+ * What a run produced, so two runs can be compared.
+ */
+struct Digest
+{
+    uint64_t video = 0;
+    uint64_t audio = 0;
+    uint64_t state = 0;
+
+    bool operator==(Digest const &other) const
+    {
+        return video == other.video && audio == other.audio && state == other.state;
+    }
+};
+
+struct RunResult
+{
+    Phases ns;  // per frame
+    Digest digest;
+    double idle_skipped = 0;  // share of the emulated cycles
+    double predecode_hits = 0;  // share of the instruction fetches
+    uint64_t debug_hits = 0;  // breakpoint and watchpoint hits, all consoles
+    CSusieStats sprites = {};  // all consoles, measured frames only
+    double cycles = 0;  // emulated during the measured frames, all consoles
+};
+
+bool g_verbose = false;
+
+uint64_t Fnv1a(void const *data, size_t size, uint64_t hash = 1469598103934665603ull)
+{
+    auto const *bytes = static_cast<uint8_t const *>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+double NanosecondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+ButtonState NoButtons(int player)
+{
+    return 0;
+}
+
+bool ReadFile(std::string const &path, std::vector<uint8_t> &data)
+{
+    FILE *file = fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    data.clear();
+    uint8_t chunk[64 * 1024];
+    size_t got;
+    while ((got = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        data.insert(data.end(), chunk, chunk + got);
+    }
+    fclose(file);
+    return !data.empty();
+}
+
+RunResult Run(Options const &options,
+              std::vector<uint8_t> const &game,
+              unsigned threads,
+              bool threaded_dispatch)
+{
+    Layout const layout(options.players, HANDY_SCREEN_WIDTH, HANDY_SCREEN_HEIGHT);
+    unsigned const pitch = HANDY_SCREEN_WIDTH * sizeof(uint32_t);
+    std::vector<uint8_t> framebuffer(layout.total_pixels.x * layout.total_pixels.y * sizeof(uint32_t));
+    DisplayBufferPointer const framebuffer_data = framebuffer.data();
+
+    MultiSystem lynxes(layout, options.bios_path.c_str(), "", options.bios_path.empty(), NoButtons);
+    lynxes.BootGame(options.game_path.c_str(), game.data(), game.size(), options.comlynx);
+    lynxes.SetThreadCount(threads);
+    for (int i = 0; i < options.players; ++i) {
+        lynxes.GetSystem(i)->mCpu->SetThreadedDispatch(threaded_dispatch);
+    }
+    lynxes.SetIdleLoopSkip(options.idle_skip);
+    lynxes.SetPredecode(options.predecode);
+    lynxes.SetJit(options.jit);
+    lynxes.SetSpriteCache(options.sprite_cache);
+    lynxes.SetDisplaySimd(options.simd);
+
+    // Every hit is counted and the CPU carries on, so the results stay
+    // comparable with a run that has no debugger attached.
+    std::vector<uint64_t> debug_hits(options.players);
+    for (int i = 0; i < options.players; ++i) {
+        C65C02 *cpu = lynxes.GetSystem(i)->mCpu;
+        if (options.breakpoint >= 0) {
+            cpu->SetBreakpoint(options.breakpoint);
+        }
+        if (options.watchpoint >= 0) {
+            cpu->SetWatchpoint(options.watchpoint, CPU_WATCH_READ | CPU_WATCH_WRITE);
+        }
+        cpu->SetDebugCallback([](void *context, int, ULONG) {
+                                  ++*static_cast<uint64_t *>(context);
+                                  return false;
+                              },
+                              &debug_hits[i]);
+    }
+    lynxes.DisplaySetAttributes(Layout::Orientation::None,
+                                PixelFormat::RGB32,
+                                pitch,
+                                [framebuffer_data] { return framebuffer_data; });
+    if (!options.video) {
+        // Keep every console skipping its frames. Mikey still does the line
+        // DMA (and its timing), it just never draws anything.
+        for (int i = 0; i < options.players; ++i) {
+            CSystem *system = lynxes.GetSystem(i);
+            system->DisplaySetAttributes(MIKIE_NO_ROTATE,
+                                         MIKIE_PIXEL_FORMAT_32BPP,
+                                         layout.FramebufferPitchForPlayer(i, pitch),
+                                         [system, framebuffer_data](ULONG) {
+                                             system->mSkipFrame = TRUE;
+                                             return framebuffer_data;
+                                         },
+                                         i);
+            system->mSkipFrame = TRUE;
+        }
+    }
+    for (int i = 0; i < options.players; ++i) {
+        lynxes.SetPlayerAudio(i, 1.0f / options.players, 0.0f);
+    }
+    lynxes.SetAudioEnabled(options.audio);
+
+    ULONG const cycles_per_frame = HANDY_SYSTEM_FREQ / 75;
+    RunResult result;
+
+    auto const run_frames = [&](int frames, Phases *phases) {
+        for (int frame = 0; frame < frames; ++frame) {
+            auto start = Clock::now();
+            lynxes.UpdateButtons();
+            lynxes.NoteLastCycleCounts();
+            lynxes.CatchUpAllSystems(cycles_per_frame, 0);
+            double const emulate = NanosecondsSince(start);
+
+            start = Clock::now();
+            bool const dirty = lynxes.IsAnyDisplayDirty();
+            lynxes.ClearDisplayDirty();
+            double const video = NanosecondsSince(start);
+
+            start = Clock::now();
+            lynxes.FetchAudioSamples();
+            ULONG const samples = lynxes.GetAudioBufferPointer();
+            lynxes.SetAudioBufferPointer(0);
+            double const audio = NanosecondsSince(start);
+
+            if (phases) {
+                phases->emulate += emulate;
+                phases->video += video;
+                phases->audio += audio;
+            }
+            result.digest.audio = Fnv1a(lynxes.GetAudioBuffer(), samples * sizeof(int16_t), result.digest.audio);
+            result.digest.video = Fnv1a(&dirty, sizeof(dirty), result.digest.video);
+        }
+    };
+
+    run_frames(options.warmup, nullptr);
+    lynxes.ClearSpriteStats();
+    for (int i = 0; i < options.players; ++i) {
+        result.cycles -= lynxes.GetSystem(i)->mSystemCycleCount;
+    }
+    run_frames(options.frames, &result.ns);
+    for (int i = 0; i < options.players; ++i) {
+        CSusieStats const stats = lynxes.GetSpriteStats(i);
+        result.sprites.paints += stats.paints;
+        result.sprites.sprites += stats.sprites;
+        result.sprites.skipped += stats.skipped;
+        result.sprites.superclipped += stats.superclipped;
+        result.sprites.pixels += stats.pixels;
+        result.sprites.collision_reads += stats.collision_reads;
+        result.sprites.collision_writes += stats.collision_writes;
+        result.sprites.cache_hits += stats.cache_hits;
+        result.sprites.cache_misses += stats.cache_misses;
+        result.sprites.cycles += stats.cycles;
+        result.sprites.host_ns += stats.host_ns;
+        result.cycles += lynxes.GetSystem(i)->mSystemCycleCount;
+    }
+    result.ns.emulate /= options.frames;
+    result.ns.audio /= options.frames;
+    result.ns.video /= options.frames;
+
+    result.digest.video = Fnv1a(framebuffer.data(), framebuffer.size(), result.digest.video);
+    double cycles = 0;
+    double skipped = 0;
+    double hits = 0;
+    double misses = 0;
+    for (int i = 0; i < options.players; ++i) {
+        C65C02 *cpu = lynxes.GetSystem(i)->mCpu;
+        cycles += lynxes.GetSystem(i)->mSystemCycleCount;
+        skipped += cpu->GetIdleLoopCyclesSkipped();
+        hits += cpu->GetPredecodeHits();
+        misses += cpu->GetPredecodeMisses();
+    }
+    result.idle_skipped = cycles ? skipped / cycles : 0;
+    result.predecode_hits = hits + misses ? hits / (hits + misses) : 0;
+    for (uint64_t const count : debug_hits) {
+        result.debug_hits += count;
+    }
+#if HANDY_CPU_PROFILE
+    if (!options.profile_path.empty()) {
+        RFILE *fe = filestream_open(options.profile_path.c_str(), RETRO_VFS_FILE_ACCESS_WRITE, RETRO_VFS_FILE_ACCESS_HINT_NONE);
+        if (fe) {
+            for (int i = 0; i < options.players; ++i) {
+                filestream_printf(fe, "Player %d\n", i + 1);
+                lynxes.GetSystem(i)->mCpu->ProfileReport(fe);
+            }
+            filestream_close(fe);
+        }
+    }
+#endif
+    std::vector<UBYTE> state(lynxes.ContextSize());
+    LSS_FILE fp = {state.data(), 0, static_cast<ULONG>(state.size()), 0};
+    if (lynxes.ContextSave(&fp)) {
+        result.digest.state = Fnv1a(state.data(), fp.index);
+    }
+    return result;
+}
+
+void PrintDigest(char const *label, Digest const &digest)
+{
+    printf("%-10s video %016llx  audio %016llx  state %016llx\n",
+           label,
+           static_cast<unsigned long long>(digest.video),
+           static_cast<unsigned long long>(digest.audio),
+           static_cast<unsigned long long>(digest.state));
+}
+
+/**
+ * Runs `options.repeat` times and returns the runs, fastest first.
+ */
+std::vector<RunResult> Measure(Options const &options,
+                               std::vector<uint8_t> const &game,
+                               unsigned threads,
+                               bool threaded_dispatch)
+{
+    std::vector<RunResult> runs;
+    for (int i = 0; i < options.repeat; ++i) {
+        runs.push_back(Run(options, game, threads, threaded_dispatch));
+        auto const &ns = runs.back().ns;
+        printf("run %-3d %12.0f ns/frame %10.1f fps\n", i + 1, ns.Total(), 1e9 / ns.Total());
+    }
+    std::sort(runs.begin(), runs.end(), [](RunResult const &a, RunResult const &b) {
+        return a.ns.Total() < b.ns.Total();
+    });
+    return runs;
+}
+
+bool IsConsistent(std::vector<RunResult> const &runs)
+{
+    for (auto const &run : runs) {
+        if (!(run.digest == runs.front().digest)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * The CPU on its own, with the switch and with threaded dispatch.
+ */
+int CompareDispatch(Options options)
+{
+    std::vector<uint8_t> const game(kOpcodeMixImage, kOpcodeMixImage + sizeof(kOpcodeMixImage));
+    options.game_path = "opcode-mix.o";
+    options.players = 1;
+    options.video = false;
+    options.audio = false;
+    options.comlynx = false;
+
+    printf("opcode mix, %d run(s) of %d frames after %d warmup frames\n",
+           options.repeat, options.frames, options.warmup);
+    if (!HANDY_THREADED_DISPATCH) {
+        printf("threaded dispatch isn't available in this build\n");
+    }
+
+    printf("\nswitch\n");
+    auto const switched = Measure(options, game, 1, false);
+    if (!HANDY_THREADED_DISPATCH) {
+        return 0;
+    }
+    printf("\nthreaded\n");
+    auto const threaded = Measure(options, game, 1, true);
+
+    double const switch_ns = switched[switched.size() / 2].ns.Total();
+    double const threaded_ns = threaded[threaded.size() / 2].ns.Total();
+    printf("\nswitch   %12.0f ns/frame\n", switch_ns);
+    printf("threaded %12.0f ns/frame  (%+.1f%%)\n\n", threaded_ns, 100.0 * (threaded_ns - switch_ns) / switch_ns);
+
+    PrintDigest("switch", switched.front().digest);
+    PrintDigest("threaded", threaded.front().digest);
+    if (!IsConsistent(switched) || !IsConsistent(threaded) ||
+        !(switched.front().digest == threaded.front().digest)) {
+        fprintf(stderr, "handy_bench: the two dispatch methods came out different\n");
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * Keeps an interpreted console next to one running with the JIT. After
+ * every translated block the interpreted one is run up to the same cycle,
+ * then the registers and all of RAM have to be the same.
+ */
+struct Lockstep
+{
+    CSystem *jit = nullptr;
+    CSystem *reference = nullptr;
+    uint64_t blocks = 0;
+    bool failed = false;
+
+    bool Compare()
+    {
+        C6502_REGS a;
+        C6502_REGS b;
+        jit->mCpu->GetRegs(a);
+        reference->mCpu->GetRegs(b);
+        bool const same = jit->mSystemCycleCount == reference->mSystemCycleCount &&
+                          a.PC == b.PC && a.PS == b.PS && a.A == b.A && a.X == b.X && a.Y == b.Y && a.SP == b.SP &&
+                          !memcmp(jit->GetRamPointer(), reference->GetRamPointer(), RAM_SIZE);
+        if (!same) {
+            fprintf(stderr,
+                    "handy_bench: the JIT went wrong after %llu blocks\n"
+                    "  jit         cycle %u  PC %04x  PS %02x  A %02x  X %02x  Y %02x  SP %02x\n"
+                    "  interpreter cycle %u  PC %04x  PS %02x  A %02x  X %02x  Y %02x  SP %02x\n",
+                    static_cast<unsigned long long>(blocks),
+                    jit->mSystemCycleCount, a.PC, a.PS, a.A, a.X, a.Y, a.SP,
+                    reference->mSystemCycleCount, b.PC, b.PS, b.A, b.X, b.Y, b.SP);
+            for (int addr = 0; addr < RAM_SIZE; ++addr) {
+                if (jit->GetRamPointer()[addr] != reference->GetRamPointer()[addr]) {
+                    fprintf(stderr, "  first RAM difference at %04x: %02x, should be %02x\n",
+                            addr, jit->GetRamPointer()[addr], reference->GetRamPointer()[addr]);
+                    break;
+                }
+            }
+        }
+        return same;
+    }
+
+    static void AfterBlock(void *context)
+    {
+        auto &lockstep = *static_cast<Lockstep *>(context);
+        if (lockstep.failed) {
+            return;
+        }
+        lockstep.reference->RunUntil(lockstep.jit->mSystemCycleCount);
+        ++lockstep.blocks;
+        lockstep.failed = !lockstep.Compare();
+    }
+};
+
+/**
+ * Checks the JIT against the interpreter in lockstep on the first console,
+ * then times both.
+ */
+int CompareJit(Options options, std::vector<uint8_t> const &game)
+{
+    if (!HANDY_JIT) {
+        printf("the JIT isn't available in this build\n");
+        return 0;
+    }
+
+    printf("game %s, lockstep check of %d frames\n", options.game_path.c_str(), options.warmup + options.frames);
+    Layout const layout(1, HANDY_SCREEN_WIDTH, HANDY_SCREEN_HEIGHT);
+    std::vector<uint8_t> framebuffer(HANDY_SCREEN_WIDTH * HANDY_SCREEN_HEIGHT * sizeof(uint32_t));
+    DisplayBufferPointer const framebuffer_data = framebuffer.data();
+    MultiSystem jit(layout, options.bios_path.c_str(), "", options.bios_path.empty(), NoButtons);
+    MultiSystem reference(layout, options.bios_path.c_str(), "", options.bios_path.empty(), NoButtons);
+    for (MultiSystem *lynxes : {&jit, &reference}) {
+        lynxes->BootGame(options.game_path.c_str(), game.data(), game.size(), false);
+        lynxes->DisplaySetAttributes(Layout::Orientation::None,
+                                     PixelFormat::RGB32,
+                                     HANDY_SCREEN_WIDTH * sizeof(uint32_t),
+                                     [framebuffer_data] { return framebuffer_data; });
+        lynxes->SetIdleLoopSkip(options.idle_skip);
+    }
+    jit.SetJit(true);
+    if (!jit.GetSystem(0)->mCpu->GetJit()) {
+        printf("the JIT couldn't get executable memory\n");
+        return 0;
+    }
+
+    Lockstep lockstep;
+    lockstep.jit = jit.GetSystem(0);
+    lockstep.reference = reference.GetSystem(0);
+    lockstep.jit->mCpu->SetJitBlockHook(Lockstep::AfterBlock, &lockstep);
+    ULONG target = lockstep.jit->mSystemCycleCount;
+    for (int frame = 0; frame < options.warmup + options.frames && !lockstep.failed; ++frame) {
+        target += HANDY_SYSTEM_FREQ / 75;
+        lockstep.jit->RunUntil(target);
+        lockstep.reference->RunUntil(lockstep.jit->mSystemCycleCount);
+        lockstep.failed = lockstep.failed || !lockstep.Compare();
+    }
+    C65C02Jit *engine = lockstep.jit->mCpu->GetJitEngine();
+    printf("%llu blocks compared, %u translated, %u invalidated pages, %u flushes\n\n",
+           static_cast<unsigned long long>(lockstep.blocks),
+           engine->GetBlocksCompiled(),
+           engine->GetInvalidations(),
+           engine->GetFlushes());
+    if (lockstep.failed) {
+        return 1;
+    }
+
+    printf("%d player(s), %d run(s) of %d frames after %d warmup frames\n",
+           options.players, options.repeat, options.frames, options.warmup);
+    printf("\ninterpreter\n");
+    options.jit = false;
+    auto const interpreted = Measure(options, game, options.threads, HANDY_THREADED_DISPATCH);
+    printf("\njit\n");
+    options.jit = true;
+    auto const translated = Measure(options, game, options.threads, HANDY_THREADED_DISPATCH);
+
+    double const interpreted_ns = interpreted[interpreted.size() / 2].ns.Total();
+    double const translated_ns = translated[translated.size() / 2].ns.Total();
+    printf("\ninterpreter %12.0f ns/frame\n", interpreted_ns);
+    printf("jit         %12.0f ns/frame  (%+.1f%%)\n\n", translated_ns, 100.0 * (translated_ns - interpreted_ns) / interpreted_ns);
+
+    PrintDigest("interp", interpreted.front().digest);
+    PrintDigest("jit", translated.front().digest);
+    if (!IsConsistent(interpreted) || !IsConsistent(translated) ||
+        !(interpreted.front().digest == translated.front().digest)) {
+        fprintf(stderr, "handy_bench: the JIT and the interpreter came out different\n");
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * Renders random screen lines with random palettes through Mikey's SIMD
+ * and plain line renderers, in every pixel format the SIMD one covers,
+ * and checks that they agree. The first and last lines of RAM are always
+ * among them, for the wrap-around at either end.
+ */
+int CompareDisplay(Options const &options, std::vector<uint8_t> const &game)
+{
+    if (!CMikie::DisplayHasSimd()) {
+        printf("SIMD screen rendering isn't available on this host\n");
+        return 0;
+    }
+
+    Layout const layout(1, HANDY_SCREEN_WIDTH, HANDY_SCREEN_HEIGHT);
+    MultiSystem lynxes(layout, options.bios_path.c_str(), "", options.bios_path.empty(), NoButtons);
+    lynxes.BootGame(options.game_path.c_str(), game.data(), game.size(), false);
+    CSystem *const system = lynxes.GetSystem(0);
+    CMikie *const mikie = system->mMikie;
+    UBYTE *const ram = system->GetRamPointer();
+
+    struct Format
+    {
+        char const *name;
+        ULONG format;
+        ULONG size;
+    };
+    Format const formats[] = {
+        {"16 bit 555", MIKIE_PIXEL_FORMAT_16BPP_555, 2},
+        {"16 bit BGR555", MIKIE_PIXEL_FORMAT_16BPP_BGR555, 2},
+        {"16 bit 565", MIKIE_PIXEL_FORMAT_16BPP_565, 2},
+        {"32 bit", MIKIE_PIXEL_FORMAT_32BPP, 4},
+    };
+    ULONG const edges[] = {0x0000, 0x0001, 0x004e, 0x004f, 0xffb0, 0xffb1, 0xfffe, 0xffff};
+    int const palettes = 1000;
+    int const lines_per_palette = 16;
+
+    std::mt19937 random(0x4c796e78);
+    std::vector<uint8_t> framebuffer(HANDY_SCREEN_WIDTH * HANDY_SCREEN_HEIGHT * sizeof(uint32_t));
+    UBYTE *const framebuffer_data = framebuffer.data();
+    uint64_t lines = 0;
+    for (Format const &format : formats) {
+        system->DisplaySetAttributes(MIKIE_NO_ROTATE, format.format, HANDY_SCREEN_WIDTH * format.size,
+                                     [framebuffer_data](ULONG) { return framebuffer_data; }, 0);
+        for (int addr = 0; addr < RAM_SIZE; ++addr) {
+            ram[addr] = static_cast<UBYTE>(random());
+        }
+        for (int palette = 0; palette < palettes; ++palette) {
+            for (ULONG pen = 0; pen < 16; ++pen) {
+                mikie->Poke(GREEN0 + pen, static_cast<UBYTE>(random()));
+                mikie->Poke(BLUERED0 + pen, static_cast<UBYTE>(random()));
+            }
+            for (int line = 0; line < lines_per_palette; ++line) {
+                ULONG const addr = line < static_cast<int>(sizeof(edges) / sizeof(edges[0]))
+                                       ? edges[line]
+                                       : random() & 0xffff;
+                if (!mikie->DisplayCheckSimd(addr)) {
+                    fprintf(stderr, "handy_bench: the SIMD renderer went wrong on the %s line at %04x\n",
+                            format.name, addr);
+                    return 1;
+                }
+                ++lines;
+            }
+        }
+    }
+    printf("%llu lines rendered both ways up by both renderers, no differences\n",
+           static_cast<unsigned long long>(lines));
+    return 0;
+}
+
+void PrintUsage()
+{
+    printf("usage: handy_bench [options] [game.lnx|game.o]\n"
+           "\n"
+           "Without a game, a bundled homebrew test program is used.\n"
+           "\n"
+           "  --players N     consoles to run (1-16, default 1)\n"
+           "  --frames N      frames to measure per run (default 3000)\n"
+           "  --warmup N      frames to run before measuring (default 75)\n"
+           "  --repeat N      runs, each from a fresh boot (default 3)\n"
+           "  --threads N     worker threads including this one (default 1)\n"
+           "  --video on|off  render the screens (default on)\n"
+           "  --audio on|off  synthesize and mix audio (default on)\n"
+           "  --comlynx       link the consoles\n"
+           "  --idle-skip on|off\n"
+           "                  fast-forward the CPU's idle loops (default off)\n"
+           "  --predecode on|off\n"
+           "                  run the CPU from its predecode cache (default off)\n"
+           "  --sprite-cache on|off\n"
+           "                  keep the sprite lines Suzy decodes (default off)\n"
+           "  --simd on|off   render the screens with SSSE3 or NEON where the host\n"
+           "                  has it (default on)\n"
+           "  --bios PATH     boot through a real lynxboot.img\n"
+           "  --break ADDR    count the CPU reaching ADDR (hex) with a breakpoint\n"
+           "  --watch ADDR    count the CPU's accesses to ADDR (hex) with a watchpoint\n"
+           "  --profile PATH  write the CPU profile of the last run to PATH\n"
+           "                  (needs a build with CPU_PROFILE=1)\n"
+           "  --verify        also run single threaded and compare the results\n"
+           "  --dispatch      compare the CPU's opcode dispatch methods on a fixed\n"
+           "                  opcode mix instead\n"
+           "  --jit           check the JIT against the interpreter in lockstep,\n"
+           "                  then time both\n"
+           "  --display       check the SIMD screen rendering against the plain one\n"
+           "                  on random screens and palettes\n"
+           "  --verbose       show the core's log\n");
+}
+
+bool ParseSwitch(char const *value, bool &out)
+{
+    if (!value) {
+        return false;
+    }
+    if (!strcmp(value, "on")) {
+        out = true;
+        return true;
+    }
+    if (!strcmp(value, "off")) {
+        out = false;
+        return true;
+    }
+    return false;
+}
+
+bool ParseOptions(int argc, char **argv, Options &options)
+{
+    for (int i = 1; i < argc; ++i) {
+        char const *arg = argv[i];
+        char const *value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        bool consumed = true;
+
+        if (!strcmp(arg, "--players") && value) {
+            options.players = atoi(value);
+        } else if (!strcmp(arg, "--frames") && value) {
+            options.frames = atoi(value);
+        } else if (!strcmp(arg, "--warmup") && value) {
+            options.warmup = atoi(value);
+        } else if (!strcmp(arg, "--repeat") && value) {
+            options.repeat = atoi(value);
+        } else if (!strcmp(arg, "--threads") && value) {
+            options.threads = static_cast<unsigned>(atoi(value));
+        } else if (!strcmp(arg, "--video")) {
+            if (!ParseSwitch(value, options.video)) {
+                return false;
+            }
+        } else if (!strcmp(arg, "--audio")) {
+            if (!ParseSwitch(value, options.audio)) {
+                return false;
+            }
+        } else if (!strcmp(arg, "--idle-skip")) {
+            if (!ParseSwitch(value, options.idle_skip)) {
+                return false;
+            }
+        } else if (!strcmp(arg, "--predecode")) {
+            if (!ParseSwitch(value, options.predecode)) {
+                return false;
+            }
+        } else if (!strcmp(arg, "--sprite-cache")) {
+            if (!ParseSwitch(value, options.sprite_cache)) {
+                return false;
+            }
+        } else if (!strcmp(arg, "--simd")) {
+            if (!ParseSwitch(value, options.simd)) {
+                return false;
+            }
+        } else if (!strcmp(arg, "--bios") && value) {
+            options.bios_path = value;
+        } else if (!strcmp(arg, "--break") && value) {
+            options.breakpoint = static_cast<int>(strtoul(value, nullptr, 16) & 0xffff);
+        } else if (!strcmp(arg, "--watch") && value) {
+            options.watchpoint = static_cast<int>(strtoul(value, nullptr, 16) & 0xffff);
+        } else if (!strcmp(arg, "--profile") && value) {
+            if (!HANDY_CPU_PROFILE) {
+                fprintf(stderr, "handy_bench: --profile needs a build with CPU_PROFILE=1\n");
+                return false;
+            }
+            options.profile_path = value;
+        } else {
+            consumed = false;
+            if (!strcmp(arg, "--comlynx")) {
+                options.comlynx = true;
+            } else if (!strcmp(arg, "--verify")) {
+                options.verify = true;
+            } else if (!strcmp(arg, "--dispatch")) {
+                options.dispatch = true;
+            } else if (!strcmp(arg, "--jit")) {
+                options.compare_jit = true;
+            } else if (!strcmp(arg, "--display")) {
+                options.compare_display = true;
+            } else if (!strcmp(arg, "--verbose")) {
+                options.verbose = true;
+            } else if (arg[0] != '-' && options.game_path.empty()) {
+                options.game_path = arg;
+            } else {
+                return false;
+            }
+        }
+        if (consumed) {
+            ++i;
+        }
+    }
+    return options.players >= 1 && options.players <= 16 &&
+           options.frames > 0 && options.warmup >= 0 && options.repeat > 0;
+}
+
+}  // namespace
+
+void handy_log(enum retro_log_level level, const char *format, ...)
+{
+    if (!g_verbose && level < RETRO_LOG_WARN) {
+        return;
+    }
+    va_list ap;
+    va_start(ap, format);
+    vfprintf(stderr, format, ap);
+    va_end(ap);
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        PrintUsage();
+        return 2;
+    }
+    g_verbose = options.verbose;
+
+    if (options.dispatch) {
+        return CompareDispatch(options);
+    }
+
+    std::vector<uint8_t> game;
+    if (options.game_path.empty()) {
+        game = BenchRomImage();
+        options.game_path = "bench.o";
+    } else if (!ReadFile(options.game_path, game)) {
+        fprintf(stderr, "handy_bench: can't read %s\n", options.game_path.c_str());
+        return 1;
+    }
+
+    if (options.compare_jit) {
+        return CompareJit(options, game);
+    }
+    if (options.compare_display) {
+        return CompareDisplay(options, game);
+    }
+
+    printf("game %s, %d player(s), %u thread(s), video %s, audio %s, idle skip %s, predecode %s, sprite cache %s, simd %s%s\n",
+           options.game_path.c_str(),
+           options.players,
+           options.threads,
+           options.video ? "on" : "off",
+           options.audio ? "on" : "off",
+           options.idle_skip ? "on" : "off",
+           options.predecode ? "on" : "off",
+           options.sprite_cache ? "on" : "off",
+           options.simd ? "on" : "off",
+           options.comlynx ? ", linked" : "");
+    printf("%d run(s) of %d frames after %d warmup frames\n\n",
+           options.repeat, options.frames, options.warmup);
+
+    auto const runs = Measure(options, game, options.threads, HANDY_THREADED_DISPATCH);
+
+    // The median run is the one reported, it's the least sensitive to
+    // whatever else the machine was doing.
+    RunResult const &median = runs[runs.size() / 2];
+    double const total = median.ns.Total();
+
+    printf("\nemulated frames/sec %12.1f  (%.2fx realtime)\n", 1e9 / total, 1e9 / total / 75.0);
+    printf("host ns/frame       %12.0f  (best %.0f)\n", total, runs.front().ns.Total());
+    printf("  emulate           %12.0f  %5.1f%%\n", median.ns.emulate, 100.0 * median.ns.emulate / total);
+    printf("  audio             %12.0f  %5.1f%%\n", median.ns.audio, 100.0 * median.ns.audio / total);
+    printf("  video             %12.0f  %5.1f%%\n", median.ns.video, 100.0 * median.ns.video / total);
+    printf("idle cycles skipped               %5.1f%%\n", 100.0 * median.idle_skipped);
+    if (options.predecode) {
+        printf("predecode hits                    %5.1f%%\n", 100.0 * median.predecode_hits);
+    }
+
+    // Suzy, per frame and console
+    double const per_frame = 1.0 / (options.frames * options.players);
+    CSusieStats const &sprites = median.sprites;
+    printf("sprites/frame              %12.1f  (%.1f skipped, %.1f superclipped)\n",
+           sprites.sprites * per_frame, sprites.skipped * per_frame, sprites.superclipped * per_frame);
+    printf("pixels/frame               %12.0f  (collision %.0f read, %.0f written)\n",
+           sprites.pixels * per_frame, sprites.collision_reads * per_frame, sprites.collision_writes * per_frame);
+    printf("sprite cycles                     %5.1f%%  of the emulated cycles\n",
+           median.cycles ? 100.0 * sprites.cycles / median.cycles : 0.0);
+    printf("sprite ns/frame            %12.0f  (%.1f%% of emulate)\n",
+           sprites.host_ns * per_frame, 100.0 * sprites.host_ns / options.frames / median.ns.emulate);
+    if (options.sprite_cache) {
+        double const lines = sprites.cache_hits + sprites.cache_misses;
+        printf("sprite cache hits                 %5.1f%%  of %.0f lines/frame\n",
+               lines ? 100.0 * sprites.cache_hits / lines : 0.0, lines * per_frame);
+    }
+    if (options.breakpoint >= 0 || options.watchpoint >= 0) {
+        printf("debugger hits              %12llu\n", static_cast<unsigned long long>(median.debug_hits));
+    }
+    printf("\n");
+
+    bool const consistent = IsConsistent(runs);
+    PrintDigest(consistent ? "digest" : "digest(!)", median.digest);
+    if (!consistent) {
+        fprintf(stderr, "handy_bench: runs of the same configuration came out different\n");
+        return 1;
+    }
+
+    if (options.verify) {
+        Digest const reference = Run(options, game, 1, HANDY_THREADED_DISPATCH).digest;
+        PrintDigest("1 thread", reference);
+        if (!(reference == median.digest)) {
+            fprintf(stderr, "handy_bench: %u thread(s) and 1 thread came out different\n", options.threads);
+            return 1;
+        }
+    }
+    return 0;
+}
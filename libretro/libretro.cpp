@@ -9,6 +9,9 @@
 #include "multi/multi_system.h"
 #include "multi/layout.h"
 
+#include <math.h>
+#include <thread>
+
 #define PLAYERS 4
 #define ENABLE_COMLYNX false
 
@@ -138,6 +141,7 @@ static map btn_map_rot_90[] = {
 static map* btn_map;
 
 static bool libretro_supports_input_bitmasks;
+static bool libretro_supports_dupe = false;
 static bool select_button;
 
 /* Frameskipping Support START */
@@ -160,6 +164,52 @@ static bool libretro_supports_option_categories = false;
 
 static unsigned retro_overclock = 1;
 
+static unsigned retro_threads = 0;
+static bool retro_idle_loop_skip = false;
+static bool retro_jit = false;
+static bool retro_sprite_cache = false;
+
+#if HANDY_CPU_PROFILE
+/* <save_dir>/<content_name>.profile, written on unload */
+static char profile_file[PATH_MAX_LENGTH];
+#endif
+
+typedef enum
+{
+   AUDIO_MIX_ALL = 0,
+   AUDIO_MIX_SPREAD,
+   AUDIO_MIX_PLAYER1
+} lynx_audio_mix_t;
+
+static lynx_audio_mix_t lynx_audio_mix = AUDIO_MIX_ALL;
+
+static void update_audio_mix(void)
+{
+   if (!lynxes)
+      return;
+
+   /* Leave some headroom so that a full house doesn't just clip */
+   float volume = 1.0f / sqrtf((float)layout.players);
+
+   for (int i = 0; i < layout.players; ++i)
+   {
+      switch (lynx_audio_mix)
+      {
+      case AUDIO_MIX_PLAYER1:
+         lynxes->SetPlayerAudio(i, (i == 0) ? 1.0f : 0.0f, 0.0f);
+         break;
+      case AUDIO_MIX_SPREAD:
+         lynxes->SetPlayerAudio(i, volume,
+               (layout.players > 1) ? -1.0f + 2.0f * i / (layout.players - 1) : 0.0f);
+         break;
+      case AUDIO_MIX_ALL:
+      default:
+         lynxes->SetPlayerAudio(i, volume, 0.0f);
+         break;
+      }
+   }
+}
+
 static void retro_audio_buff_status_cb(
     bool active, unsigned occupancy, bool underrun_likely)
 {
@@ -826,6 +876,68 @@ static void check_variables(void)
    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value) {
       retro_overclock = atoi(var.value);
    }
+
+   retro_threads = 0;
+   var.key       = "handy_threads";
+   var.value     = NULL;
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+   {
+      if (strcmp(var.value, "auto") == 0)
+         retro_threads = std::thread::hardware_concurrency();
+      else if (strcmp(var.value, "disabled") != 0)
+         retro_threads = strtol(var.value, NULL, 10);
+   }
+
+   if (retro_threads > (unsigned)layout.players)
+      retro_threads = layout.players;
+
+   if (lynxes)
+      lynxes->SetThreadCount(retro_threads);
+
+   retro_idle_loop_skip = false;
+   var.key              = "handy_idle_loop_skip";
+   var.value            = NULL;
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+      retro_idle_loop_skip = (strcmp(var.value, "enabled") == 0);
+
+   if (lynxes)
+      lynxes->SetIdleLoopSkip(retro_idle_loop_skip);
+
+   retro_jit = false;
+   var.key   = "handy_jit";
+   var.value = NULL;
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+      retro_jit = (strcmp(var.value, "enabled") == 0);
+
+   if (lynxes)
+      lynxes->SetJit(retro_jit);
+
+   retro_sprite_cache = false;
+   var.key            = "handy_sprite_cache";
+   var.value          = NULL;
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+      retro_sprite_cache = (strcmp(var.value, "enabled") == 0);
+
+   if (lynxes)
+      lynxes->SetSpriteCache(retro_sprite_cache);
+
+   lynx_audio_mix = AUDIO_MIX_ALL;
+   var.key        = "handy_audio_mix";
+   var.value      = NULL;
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+   {
+      if (strcmp(var.value, "spread") == 0)
+         lynx_audio_mix = AUDIO_MIX_SPREAD;
+      else if (strcmp(var.value, "player1") == 0)
+         lynx_audio_mix = AUDIO_MIX_PLAYER1;
+   }
+
+   update_audio_mix();
 }
 
 void retro_init(void)
@@ -842,6 +954,9 @@ void retro_init(void)
    if (environ_cb(RETRO_ENVIRONMENT_GET_INPUT_BITMASKS, NULL))
       libretro_supports_input_bitmasks = true;
 
+   if (!environ_cb(RETRO_ENVIRONMENT_GET_CAN_DUPE, &libretro_supports_dupe))
+      libretro_supports_dupe = false;
+
    frameskip_type             = 0;
    frameskip_threshold        = 0;
    frameskip_counter          = 0;
@@ -879,6 +994,7 @@ void retro_deinit(void)
    lcd_ghosting_deinit();
 
    libretro_supports_input_bitmasks = false;
+   libretro_supports_dupe           = false;
    lynx_rotation_pending            = ROTATION_PENDING_NONE;
    lynx_rotation_button_down        = false;
    lynx_rot                         = RETRO_LYNX_ROTATE_AUTO;
@@ -1017,6 +1133,40 @@ Layout::Orientation next_rot(Layout::Orientation rotation) {
    }
 }
 
+/* The RAM retro_get_memory_data() hands out can be written behind the
+ * CPU's back, by frontend cheats for instance. With the recompiler or the
+ * sprite cache on, it is compared against a copy taken after the last
+ * frame and every byte that changed is passed on to the CPU, so nothing
+ * decoded from the old contents stays in use. */
+static UBYTE frontend_ram[1024 * 64];
+static bool frontend_ram_valid = false;
+
+static void check_frontend_ram(void)
+{
+   const UBYTE *ram = lynxes->GetRamPointer();
+   C65C02 *cpu      = lynxes->GetSystem(0)->mCpu;
+   ULONG page;
+   ULONG addr;
+
+   if (!frontend_ram_valid)
+      return;
+
+   for (page = 0; page < sizeof(frontend_ram); page += 0x100)
+   {
+      if (!memcmp(ram + page, frontend_ram + page, 0x100))
+         continue;
+      for (addr = page; addr < page + 0x100; addr++)
+         if (ram[addr] != frontend_ram[addr])
+            cpu->RamWritten(addr);
+   }
+}
+
+static void copy_frontend_ram(void)
+{
+   memcpy(frontend_ram, lynxes->GetRamPointer(), sizeof(frontend_ram));
+   frontend_ram_valid = true;
+}
+
 void retro_run(void)
 {
    static uint64_t run = 0;
@@ -1027,6 +1177,11 @@ void retro_run(void)
       check_variables();
    }
 
+   if (retro_jit || retro_sprite_cache)
+      check_frontend_ram();
+   else
+      frontend_ram_valid = false;
+
    input_poll_cb();
    lynxes->UpdateButtons();
 
@@ -1098,8 +1253,12 @@ void retro_run(void)
       lynxes->CatchUpAllSystems(retro_cycles_per_frame, retro_overclock);
    }
 
-   video_cb(framebuffer, lynx_multi_width, lynx_multi_height,
-               RETRO_LYNX_MP_WIDTH * RETRO_PIX_BYTES);
+   /* Nothing was drawn any different on any screen, so the
+    * frontend can just show the last frame again */
+   video_cb((libretro_supports_dupe && !lynxes->IsAnyDisplayDirty()) ? NULL : framebuffer,
+            lynx_multi_width, lynx_multi_height,
+            RETRO_LYNX_MP_WIDTH * RETRO_PIX_BYTES);
+   lynxes->ClearDisplayDirty();
 
    lynxes->FetchAudioSamples();
 
@@ -1107,6 +1266,9 @@ void retro_run(void)
    // TODO: lynx2
    audio_batch_cb(soundBuffer, lynxes->GetAudioBufferPointer() >> 1);
    lynxes->SetAudioBufferPointer(0);
+
+   if (retro_jit || retro_sprite_cache)
+      copy_frontend_ram();
 }
 
 size_t retro_serialize_size(void)
@@ -1263,9 +1425,24 @@ bool retro_load_game(const struct retro_game_info *info)
       lynxes = nullptr;
    }
 
+#if HANDY_CPU_PROFILE
+   profile_file[0] = '\0';
+   if (!string_is_empty(eeprom_file))
+   {
+      strlcpy(profile_file, eeprom_file, sizeof(profile_file));
+      path_remove_extension(profile_file);
+      strlcat(profile_file, ".profile", sizeof(profile_file));
+   }
+#endif
+
    lynxes = new MultiSystem (layout, bios_file, eeprom_file, !bios_found, process_input_for_player);
    lynxes->BootGame(content_path, content_data, content_size, ENABLE_COMLYNX);
+   lynxes->SetThreadCount(retro_threads);
+   lynxes->SetIdleLoopSkip(retro_idle_loop_skip);
+   lynxes->SetJit(retro_jit);
+   lynxes->SetSpriteCache(retro_sprite_cache);
 
+   update_audio_mix();
    lynxes->SetAudioEnabled(true);
    soundBuffer   = lynxes->GetAudioBuffer();
    btn_map       = btn_map_no_rot;
@@ -1294,8 +1471,41 @@ bool retro_load_game_special(unsigned, const struct retro_game_info*, size_t)
    return false;
 }
 
+#if HANDY_CPU_PROFILE
+/* Each player's CPU profile goes to the profile file, or to the log when
+ * there's no save directory */
+static void report_cpu_profile(void)
+{
+   RFILE *fe = NULL;
+
+   if (!string_is_empty(profile_file))
+      fe = filestream_open(profile_file, RETRO_VFS_FILE_ACCESS_WRITE,
+            RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   for (int i = 0; i < layout.players; i++)
+   {
+      if (fe)
+         filestream_printf(fe, "Player %d\n", i + 1);
+      else
+         handy_log(RETRO_LOG_INFO, "Player %d\n", i + 1);
+      lynxes->GetSystem(i)->mCpu->ProfileReport(fe);
+   }
+
+   if (fe)
+   {
+      handy_log(RETRO_LOG_INFO, "CPU PROFILE %s\n", profile_file);
+      filestream_close(fe);
+   }
+}
+#endif
+
 void retro_unload_game(void)
 {
+#if HANDY_CPU_PROFILE
+   if (lynxes)
+      report_cpu_profile();
+#endif
+   frontend_ram_valid = false;
    initialized = false;
 }
 
@@ -147,6 +147,81 @@ struct retro_core_option_v2_definition option_defs_us[] = {
       },
       "1"
    },
+   {
+      "handy_threads",
+      "Multi-Console Threads",
+      NULL,
+      "Run the emulated consoles in parallel, each console's frame on its own CPU core. Only has an effect with more than one player and without ComLynx. 'Auto' uses all available cores.",
+      NULL,
+      NULL,
+      {
+         { "disabled", NULL },
+         { "auto",     "Auto" },
+         { "2",        NULL },
+         { "4",        NULL },
+         { "8",        NULL },
+         { "16",       NULL },
+         { NULL, NULL },
+      },
+      "disabled"
+   },
+   {
+      "handy_idle_loop_skip",
+      "Idle Loop Skip",
+      NULL,
+      "Skip ahead when a game is only waiting for the next timer or display interrupt. Emulation stays exact, this only saves host CPU time. Not used while ComLynx links the consoles.",
+      NULL,
+      NULL,
+      {
+         { "disabled", NULL },
+         { "enabled",  NULL },
+         { NULL, NULL },
+      },
+      "disabled"
+   },
+   {
+      "handy_jit",
+      "CPU Recompiler",
+      NULL,
+      "Translate the game's 65C02 code into native x86-64 code instead of interpreting it. Emulation stays exact. Only available on 64-bit x86 Linux and FreeBSD; elsewhere this does nothing.",
+      NULL,
+      NULL,
+      {
+         { "disabled", NULL },
+         { "enabled",  NULL },
+         { NULL, NULL },
+      },
+      "disabled"
+   },
+   {
+      "handy_sprite_cache",
+      "Sprite Cache",
+      NULL,
+      "Keep the sprite graphics the game draws unpacked, so they don't have to be unpacked again every frame. Emulation stays exact.",
+      NULL,
+      NULL,
+      {
+         { "disabled", NULL },
+         { "enabled",  NULL },
+         { NULL, NULL },
+      },
+      "disabled"
+   },
+   {
+      "handy_audio_mix",
+      "Multi-Console Audio",
+      NULL,
+      "Which consoles can be heard. 'All Players' mixes every console in the center, 'All Players, Spread' places them from left to right across the stereo field.",
+      NULL,
+      NULL,
+      {
+         { "all",      "All Players" },
+         { "spread",   "All Players, Spread" },
+         { "player1",  "Player 1 Only" },
+         { NULL, NULL },
+      },
+      "all"
+   },
    {
       "handy_frameskip",
       "Frameskip",
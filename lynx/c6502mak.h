@@ -48,18 +48,18 @@
 //
 
 #define	xIMMEDIATE()			{mOperand=mPC;mPC++;}
-#define	xABSOLUTE()				{mOperand=CPU_PEEKW(mPC);mPC+=2;}
-#define xZEROPAGE()				{mOperand=CPU_PEEK(mPC);mPC++;}
-#define xZEROPAGE_X()			{mOperand=CPU_PEEK(mPC)+mX;mPC++;mOperand&=0xff;}
-#define xZEROPAGE_Y()			{mOperand=CPU_PEEK(mPC)+mY;mPC++;mOperand&=0xff;}
-#define xABSOLUTE_X()			{mOperand=CPU_PEEKW(mPC);mPC+=2;mOperand+=mX;mOperand&=0xffff;}
-#define	xABSOLUTE_Y()			{mOperand=CPU_PEEKW(mPC);mPC+=2;mOperand+=mY;mOperand&=0xffff;}
-#define xINDIRECT_ABSOLUTE_X()	{mOperand=CPU_PEEKW(mPC);mPC+=2;mOperand+=mX;mOperand&=0xffff;mOperand=CPU_PEEKW(mOperand);}
-#define xRELATIVE()				{mOperand=CPU_PEEK(mPC);mPC++;mOperand=(mPC+mOperand)&0xffff;}
-#define xINDIRECT_X()			{mOperand=CPU_PEEK(mPC);mPC++;mOperand=mOperand+mX;mOperand&=0x00ff;mOperand=CPU_PEEKW(mOperand);}
-#define xINDIRECT_Y()			{mOperand=CPU_PEEK(mPC);mPC++;mOperand=CPU_PEEKW(mOperand);mOperand=mOperand+mY;mOperand&=0xffff;}
-#define xINDIRECT_ABSOLUTE()	{mOperand=CPU_PEEKW(mPC);mPC+=2;mOperand=CPU_PEEKW(mOperand);}
-#define xINDIRECT()				{mOperand=CPU_PEEK(mPC);mPC++;mOperand=CPU_PEEKW(mOperand);}
+#define	xABSOLUTE()				{mOperand=CPU_FETCHW();mPC+=2;}
+#define xZEROPAGE()				{mOperand=CPU_FETCH();mPC++;}
+#define xZEROPAGE_X()			{mOperand=CPU_FETCH()+mX;mPC++;mOperand&=0xff;}
+#define xZEROPAGE_Y()			{mOperand=CPU_FETCH()+mY;mPC++;mOperand&=0xff;}
+#define xABSOLUTE_X()			{mOperand=CPU_FETCHW();mPC+=2;mOperand+=mX;mOperand&=0xffff;}
+#define	xABSOLUTE_Y()			{mOperand=CPU_FETCHW();mPC+=2;mOperand+=mY;mOperand&=0xffff;}
+#define xINDIRECT_ABSOLUTE_X()	{mOperand=CPU_FETCHW();mPC+=2;mOperand+=mX;mOperand&=0xffff;mOperand=CPU_PEEKW(mOperand);}
+#define xRELATIVE()				{mOperand=CPU_FETCH();mPC++;mOperand=(mPC+mOperand)&0xffff;}
+#define xINDIRECT_X()			{mOperand=CPU_FETCH();mPC++;mOperand=mOperand+mX;mOperand&=0x00ff;mOperand=CPU_PEEKW(mOperand);}
+#define xINDIRECT_Y()			{mOperand=CPU_FETCH();mPC++;mOperand=CPU_PEEKW(mOperand);mOperand=mOperand+mY;mOperand&=0xffff;}
+#define xINDIRECT_ABSOLUTE()	{mOperand=CPU_FETCHW();mPC+=2;mOperand=CPU_PEEKW(mOperand);}
+#define xINDIRECT()				{mOperand=CPU_FETCH();mPC++;mOperand=CPU_PEEKW(mOperand);}
 
 //
 // Helper Macros
@@ -67,11 +67,14 @@
 //#define SET_Z(m)				{ mZ=(m)?false:true; }
 //#define SET_N(m)				{ mN=(m&0x80)?true:false; }
 //#define SET_NZ(m)				SET_Z(m) SET_N(m)
-#define SET_Z(m)				{ mZ=!(m); }
-#define SET_N(m)				{ mN=(m)&0x80; }
-#define SET_NZ(m)				{ mZ=!(m); mN=(m)&0x80; }
+#define SET_Z(m)				{ SetNZ(FlagN(),!(m)); }
+#define SET_N(m)				{ SetNZ((m)&0x80,FlagZ()); }
+#define SET_NZ(m)				{ mNZ=(m); }
 #define PULL(m)					{ mSP++; mSP&=0xff; m=CPU_PEEK(mSP+0x0100); }
 #define PUSH(m)					{ CPU_POKE(0x0100+mSP,m); mSP--; mSP&=0xff; }
+
+// A backward branch or jump may be closing an idle loop
+#define IDLE_LOOP_CHECK(offset)	{ if((offset)<0 && mIdleLoopSkip && !debug) IdleLoop(mPC,mPC-(offset)); }
 //
 // Opcode execution 
 //
@@ -160,10 +163,11 @@
 {\
 	if(!mC)\
 	{\
-		int offset=(signed char)CPU_PEEK(mPC);\
+		int offset=(signed char)CPU_FETCH();\
 		mPC++;\
 		mPC+=offset;\
 		mPC&=0xffff;\
+		IDLE_LOOP_CHECK(offset);\
 	}\
 	else\
 	{\
@@ -176,10 +180,11 @@
 {\
 	if(mC)\
 	{\
-		int offset=(signed char)CPU_PEEK(mPC);\
+		int offset=(signed char)CPU_FETCH();\
 		mPC++;\
 		mPC+=offset;\
 		mPC&=0xffff;\
+		IDLE_LOOP_CHECK(offset);\
 	}\
 	else\
 	{\
@@ -190,12 +195,13 @@
 
 #define	xBEQ()\
 {\
-	if(mZ)\
+	if(FlagZ())\
 	{\
-		int offset=(signed char)CPU_PEEK(mPC);\
+		int offset=(signed char)CPU_FETCH();\
 		mPC++;\
 		mPC+=offset;\
 		mPC&=0xffff;\
+		IDLE_LOOP_CHECK(offset);\
 	}\
 	else\
 	{\
@@ -211,13 +217,15 @@
 #define	xBIT()\
 {\
 	int value=CPU_PEEK(mOperand);\
-	SET_Z(mA&value);\
-\
 	if(mOpcode!=0x89)\
 	{\
-		mN=value&0x80;\
+		SetNZ(value&0x80,!(mA&value));\
 		mV=value&0x40;\
 	}\
+	else\
+	{\
+		SET_Z(mA&value);\
+	}\
 }
 
 //
@@ -234,12 +242,13 @@
 
 #define	xBMI()\
 {\
-	if(mN)\
+	if(FlagN())\
 	{\
-		int offset=(signed char)CPU_PEEK(mPC);\
+		int offset=(signed char)CPU_FETCH();\
 		mPC++;\
 		mPC+=offset;\
 		mPC&=0xffff;\
+		IDLE_LOOP_CHECK(offset);\
 	}\
 	else\
 	{\
@@ -250,12 +259,13 @@
 
 #define	xBNE()\
 {\
-	if(!mZ)\
+	if(!FlagZ())\
 	{\
-		int offset=(signed char)CPU_PEEK(mPC);\
+		int offset=(signed char)CPU_FETCH();\
 		mPC++;\
 		mPC+=offset;\
 		mPC&=0xffff;\
+		IDLE_LOOP_CHECK(offset);\
 	}\
 	else\
 	{\
@@ -266,12 +276,13 @@
 
 #define	xBPL()\
 {\
-	if(!mN)\
+	if(!FlagN())\
 	{\
-		int offset=(signed char)CPU_PEEK(mPC);\
+		int offset=(signed char)CPU_FETCH();\
 		mPC++;\
 		mPC+=offset;\
 		mPC&=0xffff;\
+		IDLE_LOOP_CHECK(offset);\
 	}\
 	else\
 	{\
@@ -282,10 +293,11 @@
 
 #define	xBRA()\
 {\
-	int offset=(signed char)CPU_PEEK(mPC);\
+	int offset=(signed char)CPU_FETCH();\
 	mPC++;\
 	mPC+=offset;\
 	mPC&=0xffff;\
+	IDLE_LOOP_CHECK(offset);\
 }
 
 //#define	xBRK()\
@@ -318,10 +330,11 @@
 {\
 	if(!mV)\
 	{\
-		int offset=(signed char)CPU_PEEK(mPC);\
+		int offset=(signed char)CPU_FETCH();\
 		mPC++;\
 		mPC+=offset;\
 		mPC&=0xffff;\
+		IDLE_LOOP_CHECK(offset);\
 	}\
 	else\
 	{\
@@ -334,10 +347,11 @@
 {\
 	if(mV)\
 	{\
-		int offset=(signed char)CPU_PEEK(mPC);\
+		int offset=(signed char)CPU_FETCH();\
 		mPC++;\
 		mPC+=offset;\
 		mPC&=0xffff;\
+		IDLE_LOOP_CHECK(offset);\
 	}\
 	else\
 	{\
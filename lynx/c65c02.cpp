@@ -45,10 +45,45 @@
 
 #include "c65c02.h"
 #include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#if HANDY_CPU_PROFILE
+#include <algorithm>
+#include <streams/file_stream.h>
+#endif
 
 C65C02::C65C02(CSystem& parent)
          :mSystem(parent) 
       {
+         mJit=NULL;
+         mJitBlockHook=NULL;
+         mJitBlockHookContext=NULL;
+         mPredecode=FALSE;
+         memset(mPredecodePage,0,sizeof(mPredecodePage));
+         mPredecodeHits=0;
+         mPredecodeMisses=0;
+         memset(mCodeMap,0,sizeof(mCodeMap));
+         memset(mPageGeneration,0,sizeof(mPageGeneration));
+         mDebugArmed=FALSE;
+         mBreakpoints=0;
+         mWatchpoints=0;
+         mDebugResumePC=-1;
+         mDebugCallback=NULL;
+         mDebugCallbackContext=NULL;
+#if HANDY_CPU_PROFILE
+         memset(&mProfile,0,sizeof(mProfile));
+         mProfileIrqDepth=0;
+         mProfileIrqEntry=0;
+#endif
+         mThreadedDispatch=HANDY_THREADED_DISPATCH;
+         mIdleLoopSkip=FALSE;
+         mIdleLoopStart=-1;
+         mIdleLoopEnd=-1;
+         mIdleLoopPure=FALSE;
+         mIdleLoopCycle=0;
+         mIdleLoopUntil=0;
+         mIdleLoopCyclesSkipped=0;
+
          // Compute the BCD lookup table
          for(UWORD t=0;t<256;++t)
          {
@@ -58,6 +93,12 @@ C65C02::C65C02(CSystem& parent)
          Reset();
       }
 
+      C65C02::~C65C02()
+      {
+         delete mJit;
+         for(int page=0;page<0xfc;page++) delete[] mPredecodePage[page];
+      }
+
       void C65C02::Reset(void)
       {
          mRamPointer=mSystem.GetRamPointer();
@@ -68,12 +109,11 @@ C65C02::C65C02(CSystem& parent)
          mOpcode=0;
          mOperand=0;
          mPC=CPU_PEEKW(BOOT_VECTOR);
-         mN=FALSE;
          mV=FALSE;
          mB=FALSE;
          mD=FALSE;
          mI=TRUE;
-         mZ=TRUE;
+         SetNZ(FALSE,TRUE);
          mC=FALSE;
          mIRQActive=FALSE;
 
@@ -81,10 +121,300 @@ C65C02::C65C02(CSystem& parent)
          mSystem.mSystemIRQ=FALSE;
          mSystem.mSystemCPUSleep=FALSE;
          mSystem.mSystemCPUSleep_Saved=FALSE;
+         FlushCode();
+         DebugArm();
+#if HANDY_CPU_PROFILE
+         mProfileIrqDepth=0;
+#endif
+      }
+
+      // Bus accesses made by each opcode, including fetching it. The cycles
+      // are worked out from these as compile time constants.
+      static constexpr UBYTE opcode_bus_accesses[256] = {
+         /* 0x00 */ 6, 5, 1, 1, 4, 2, 4, 1, 2, 2, 1, 1, 5, 3, 5, 4,
+         /* 0x10 */ 1, 4, 4, 1, 4, 3, 5, 4, 1, 3, 1, 1, 5, 3, 6, 4,
+         /* 0x20 */ 5, 5, 1, 1, 2, 2, 4, 4, 3, 1, 1, 1, 3, 3, 5, 4,
+         /* 0x30 */ 1, 4, 4, 1, 3, 3, 5, 4, 1, 3, 1, 1, 3, 3, 6, 4,
+         /* 0x40 */ 5, 5, 1, 1, 2, 2, 4, 4, 2, 1, 1, 1, 2, 3, 5, 4,
+         /* 0x50 */ 1, 4, 4, 1, 3, 3, 5, 4, 1, 3, 2, 1, 7, 3, 6, 4,
+         /* 0x60 */ 5, 5, 1, 1, 2, 2, 4, 4, 3, 1, 1, 1, 5, 3, 5, 4,
+         /* 0x70 */ 1, 4, 4, 1, 3, 3, 5, 4, 1, 3, 3, 1, 5, 3, 6, 4,
+         /* 0x80 */ 2, 5, 1, 1, 2, 2, 2, 4, 1, 1, 1, 1, 3, 3, 3, 4,
+         /* 0x90 */ 1, 5, 4, 1, 3, 3, 3, 4, 1, 4, 1, 1, 3, 4, 4, 4,
+         /* 0xA0 */ 1, 5, 1, 1, 2, 2, 2, 4, 1, 1, 1, 1, 3, 3, 3, 4,
+         /* 0xB0 */ 1, 4, 4, 1, 3, 3, 3, 4, 1, 3, 1, 1, 3, 3, 3, 3,
+         /* 0xC0 */ 1, 5, 1, 1, 2, 2, 4, 4, 1, 1, 1, 1, 3, 3, 5, 4,
+         /* 0xD0 */ 1, 4, 4, 1, 3, 3, 5, 4, 1, 3, 2, 1, 3, 3, 6, 4,
+         /* 0xE0 */ 1, 5, 1, 1, 2, 2, 4, 4, 1, 1, 1, 1, 3, 3, 5, 4,
+         /* 0xF0 */ 1, 4, 4, 1, 3, 3, 5, 4, 1, 3, 3, 1, 3, 3, 6, 4
+      };
+
+#define OPCODE_CYCLES(op) (1+(opcode_bus_accesses[op]*CPU_RDWR_CYC))
+
+      ULONG C65C02::OpcodeCycles(int opcode)
+      {
+         return OPCODE_CYCLES(opcode);
+      }
+
+#if HANDY_CPU_PROFILE
+// Each opcode run counts its cycles towards the page of code it's in. The
+// cycles per opcode are fixed, so the profile only keeps how many times
+// each one ran.
+#define PROFILE_OPCODE(op)			{ mProfile.opcodes[op]++; mProfile.page_cycles[((mPC-1)>>8)&0xff]+=OPCODE_CYCLES(op); }
+#define PROFILE_CYCLES(pc,cycles)	{ mProfile.page_cycles[((pc)>>8)&0xff]+=(cycles); }
+#define PROFILE_BLOCK(pc,cycles)	{ PROFILE_CYCLES(pc,cycles); mProfile.jit_cycles+=(cycles); }
+#define PROFILE_IRQ()				{ mProfile.irqs++; if(!mProfileIrqDepth++) mProfileIrqEntry=mSystem.mSystemCycleCount; }
+#define PROFILE_RTI()				{ if(mProfileIrqDepth && !--mProfileIrqDepth) mProfile.irq_cycles+=mSystem.mSystemCycleCount-mProfileIrqEntry; }
+#else
+#define PROFILE_OPCODE(op)
+#define PROFILE_CYCLES(pc,cycles)
+#define PROFILE_BLOCK(pc,cycles)
+#define PROFILE_IRQ()
+#define PROFILE_RTI()
+#endif
+
+#define RUN_CONTINUES ((int32_t)(mSystem.mSystemCycleCount-until)<0 && \
+                       mSystem.mSystemCycleCount<mSystem.mNextTimerEvent && \
+                       !mSystem.mSystemCPUSleep)
+
+// The predecode cache has the operand bytes too, CPU_FETCH() and
+// CPU_FETCHW() pick them up from 'fetched'
+#define FETCH_OPCODE \
+      if constexpr(predecode) { \
+         const C65C02Predecoded &insn=Predecode(mPC); \
+         mOpcode=insn.opcode; \
+         fetched=insn.operand; \
+      } else { \
+         mOpcode=CPU_READ(mPC); \
+      } \
+      mPC++
+
+#if HANDY_THREADED_DISPATCH
+      // Every handler is also a label, so with threaded dispatch each one
+      // can jump straight to the next. Only when Run() is done or an IRQ is
+      // due does it go back around the loop.
+#define OPCODE(op) case op: op_##op: mSystem.mSystemCycleCount+=OPCODE_CYCLES(op); PROFILE_OPCODE(op)
+#define NEXT_OPCODE \
+      if constexpr(threaded) { \
+         if(RUN_CONTINUES && !(mSystem.mSystemIRQ && !mI)) { \
+            FETCH_OPCODE; \
+            goto *dispatch[mOpcode]; \
+         } \
+      } \
+      break
+#else
+#define OPCODE(op) case op: mSystem.mSystemCycleCount+=OPCODE_CYCLES(op); PROFILE_OPCODE(op)
+#define NEXT_OPCODE break
+#endif
+
+      void C65C02::Run(ULONG until)
+      {
+         // Only a loop that went around twice in the same Run() can be
+         // skipped, nothing but the CPU touches the system in between.
+         mIdleLoopStart=-1;
+         mIdleLoopUntil=until;
+
+         if(mDebugArmed) {
+            DebugRun(until);
+            return;
+         }
+
+#if HANDY_JIT
+         if(mJit) {
+#if HANDY_THREADED_DISPATCH
+            if(mThreadedDispatch) {
+               ExecuteJit<true>(until);
+               return;
+            }
+#endif
+            ExecuteJit<false>(until);
+            return;
+         }
+#endif
+
+#if HANDY_THREADED_DISPATCH
+         if(mThreadedDispatch) {
+            if(mPredecode) Execute<true,true>(until);
+            else Execute<true,false>(until);
+            return;
+         }
+#endif
+         if(mPredecode) Execute<false,true>(until);
+         else Execute<false,false>(until);
       }
 
       void C65C02::Update(void)
       {
+         // Run() always does at least one instruction
+         Run(mSystem.mSystemCycleCount);
+      }
+
+      // Opcodes that can be part of an idle loop: they neither write nor
+      // touch the stack nor jump, 0 for everything else. Whether what they
+      // read is safe to read is checked separately.
+      static constexpr UBYTE idle_loop_opcode_length[256] = {
+         /* 0x00 */ 0, 0, 0, 0, 0, 2, 0, 0, 0, 2, 0, 0, 0, 3, 0, 0,
+         /* 0x10 */ 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0,
+         /* 0x20 */ 0, 0, 0, 0, 2, 2, 0, 0, 0, 2, 0, 0, 3, 3, 0, 0,
+         /* 0x30 */ 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0,
+         /* 0x40 */ 0, 0, 0, 0, 0, 2, 0, 0, 0, 2, 0, 0, 0, 3, 0, 0,
+         /* 0x50 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+         /* 0x60 */ 0, 0, 0, 0, 0, 2, 0, 0, 0, 2, 0, 0, 0, 3, 0, 0,
+         /* 0x70 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+         /* 0x80 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 1, 0, 0, 0, 0, 0,
+         /* 0x90 */ 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0,
+         /* 0xA0 */ 2, 0, 2, 0, 2, 2, 2, 0, 1, 2, 1, 0, 3, 3, 3, 0,
+         /* 0xB0 */ 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0,
+         /* 0xC0 */ 2, 0, 0, 0, 2, 2, 0, 0, 0, 2, 0, 0, 3, 3, 0, 0,
+         /* 0xD0 */ 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0,
+         /* 0xE0 */ 2, 0, 0, 0, 2, 2, 0, 0, 0, 2, 1, 0, 3, 3, 0, 0,
+         /* 0xF0 */ 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0
+      };
+
+      C65C02::IdleLoopState C65C02::IdleLoopNow(void) const
+      {
+         IdleLoopState state={mA,mX,mY,mSP,mNZ,mV,mB,mD,mI,mC,mOperand};
+         return state;
+      }
+
+      // A loop is pure when going around it can't change anything but the
+      // CPU's registers: it only reads RAM, the ROM or one of the few
+      // Mikey and Suzy registers that only change on a timer event, and it
+      // can't be left other than by its own branch.
+      bool C65C02::IdleLoopIsPure(int start, int end)
+      {
+         if(end>=0xfc00 || end-start>16) return FALSE;
+
+         int pc=start;
+         while(pc<end) {
+            int opcode=mRamPointer[pc];
+            int length=idle_loop_opcode_length[opcode];
+
+            // The last instruction has to be the branch or jump back
+            if(pc+2==end && (opcode&0x1f)==0x10) return TRUE;
+            if(pc+2==end && opcode==0x80) return TRUE;
+            if(pc+3==end && opcode==0x4c) return TRUE;
+
+            if(!length || pc+length>=end) return FALSE;
+            if(length==3) {
+               int addr=mRamPointer[pc+1]|(mRamPointer[pc+2]<<8);
+               if(addr>=0xfc00) {
+                  CLynxBase *handler=mSystem.MemoryHandler(addr);
+                  bool safe=(handler==mSystem.mRam || handler==mSystem.mRom);
+                  if(handler==mSystem.mMikie) safe=(addr==INTRST || addr==INTSET);
+                  if(handler==mSystem.mSusie) safe=(addr==SPRSYS || addr==JOYSTICK || addr==SWITCHES);
+                  if(!safe) return FALSE;
+               }
+            }
+            pc+=length;
+         }
+         return FALSE;
+      }
+
+      // Called when a branch or jump goes back to 'start' from 'end'. The
+      // first time around, the loop gets checked and the CPU's state noted.
+      // If the loop is pure and the CPU comes back around it in exactly the
+      // same state, then every time around until the next timer event
+      // will be the same too. All of those but the last are skipped, so
+      // the CPU stops at exactly the same point as it would have.
+      void C65C02::IdleLoop(int start, int end)
+      {
+         IdleLoopState now=IdleLoopNow();
+
+         if(start!=mIdleLoopStart || end!=mIdleLoopEnd) {
+            mIdleLoopStart=start;
+            mIdleLoopEnd=end;
+            mIdleLoopPure=IdleLoopIsPure(start,end);
+         } else if(mIdleLoopPure && !memcmp(&now,&mIdleLoopState,sizeof(now))) {
+            ULONG cycles=mSystem.mSystemCycleCount;
+            ULONG once=cycles-mIdleLoopCycle;
+            ULONG left=(cycles<mSystem.mNextTimerEvent)?mSystem.mNextTimerEvent-cycles:0;
+            if((int32_t)(mIdleLoopUntil-cycles)<(int32_t)left) {
+               left=((int32_t)(mIdleLoopUntil-cycles)>0)?mIdleLoopUntil-cycles:0;
+            }
+            if(once && left>once) {
+               ULONG skip=((left-1)/once)*once;
+               mSystem.mSystemCycleCount+=skip;
+               mIdleLoopCyclesSkipped+=skip;
+               PROFILE_CYCLES(start,skip);
+            }
+         }
+         mIdleLoopState=now;
+         mIdleLoopCycle=mSystem.mSystemCycleCount;
+      }
+
+      UBYTE C65C02::DebugPeek(ULONG addr)
+      {
+         DebugWatch(addr,CPU_WATCH_READ);
+         return CPU_READ(addr);
+      }
+
+      UWORD C65C02::DebugPeekW(ULONG addr)
+      {
+         DebugWatch(addr,CPU_WATCH_READ);
+         DebugWatch(addr+1,CPU_WATCH_READ);
+         return CPU_READW(addr);
+      }
+
+      void C65C02::DebugPoke(ULONG addr, UBYTE data)
+      {
+         DebugWatch(addr,CPU_WATCH_WRITE);
+         CPU_WRITE(addr,data);
+      }
+
+      // The debugger's Execute() checks every data access against the
+      // watchpoints, for everyone else that's gone at compile time.
+      // Instruction fetches never count.
+#undef CPU_PEEK
+#undef CPU_PEEKW
+#undef CPU_POKE
+#define CPU_PEEK(m)				(debug?DebugPeek(m):CPU_READ(m))
+#define CPU_PEEKW(m)			(debug?DebugPeekW(m):CPU_READW(m))
+#define CPU_POKE(m1,m2)			{if(debug) DebugPoke(m1,m2); else CPU_WRITE(m1,m2);}
+
+      template<bool threaded, bool predecode, bool debug>
+      inline void C65C02::Execute(ULONG until)
+      {
+         int fetched=0;
+         (void)fetched;
+
+#if HANDY_THREADED_DISPATCH
+         static void *const dispatch[256] = {
+            &&op_0x00, &&op_0x01, &&op_0x02, &&op_0x03, &&op_0x04, &&op_0x05, &&op_0x06, &&op_0x07,
+            &&op_0x08, &&op_0x09, &&op_0x0A, &&op_0x0B, &&op_0x0C, &&op_0x0D, &&op_0x0E, &&op_0x0F,
+            &&op_0x10, &&op_0x11, &&op_0x12, &&op_0x13, &&op_0x14, &&op_0x15, &&op_0x16, &&op_0x17,
+            &&op_0x18, &&op_0x19, &&op_0x1A, &&op_0x1B, &&op_0x1C, &&op_0x1D, &&op_0x1E, &&op_0x1F,
+            &&op_0x20, &&op_0x21, &&op_0x22, &&op_0x23, &&op_0x24, &&op_0x25, &&op_0x26, &&op_0x27,
+            &&op_0x28, &&op_0x29, &&op_0x2A, &&op_0x2B, &&op_0x2C, &&op_0x2D, &&op_0x2E, &&op_0x2F,
+            &&op_0x30, &&op_0x31, &&op_0x32, &&op_0x33, &&op_0x34, &&op_0x35, &&op_0x36, &&op_0x37,
+            &&op_0x38, &&op_0x39, &&op_0x3A, &&op_0x3B, &&op_0x3C, &&op_0x3D, &&op_0x3E, &&op_0x3F,
+            &&op_0x40, &&op_0x41, &&op_0x42, &&op_0x43, &&op_0x44, &&op_0x45, &&op_0x46, &&op_0x47,
+            &&op_0x48, &&op_0x49, &&op_0x4A, &&op_0x4B, &&op_0x4C, &&op_0x4D, &&op_0x4E, &&op_0x4F,
+            &&op_0x50, &&op_0x51, &&op_0x52, &&op_0x53, &&op_0x54, &&op_0x55, &&op_0x56, &&op_0x57,
+            &&op_0x58, &&op_0x59, &&op_0x5A, &&op_0x5B, &&op_0x5C, &&op_0x5D, &&op_0x5E, &&op_0x5F,
+            &&op_0x60, &&op_0x61, &&op_0x62, &&op_0x63, &&op_0x64, &&op_0x65, &&op_0x66, &&op_0x67,
+            &&op_0x68, &&op_0x69, &&op_0x6A, &&op_0x6B, &&op_0x6C, &&op_0x6D, &&op_0x6E, &&op_0x6F,
+            &&op_0x70, &&op_0x71, &&op_0x72, &&op_0x73, &&op_0x74, &&op_0x75, &&op_0x76, &&op_0x77,
+            &&op_0x78, &&op_0x79, &&op_0x7A, &&op_0x7B, &&op_0x7C, &&op_0x7D, &&op_0x7E, &&op_0x7F,
+            &&op_0x80, &&op_0x81, &&op_0x82, &&op_0x83, &&op_0x84, &&op_0x85, &&op_0x86, &&op_0x87,
+            &&op_0x88, &&op_0x89, &&op_0x8A, &&op_0x8B, &&op_0x8C, &&op_0x8D, &&op_0x8E, &&op_0x8F,
+            &&op_0x90, &&op_0x91, &&op_0x92, &&op_0x93, &&op_0x94, &&op_0x95, &&op_0x96, &&op_0x97,
+            &&op_0x98, &&op_0x99, &&op_0x9A, &&op_0x9B, &&op_0x9C, &&op_0x9D, &&op_0x9E, &&op_0x9F,
+            &&op_0xA0, &&op_0xA1, &&op_0xA2, &&op_0xA3, &&op_0xA4, &&op_0xA5, &&op_0xA6, &&op_0xA7,
+            &&op_0xA8, &&op_0xA9, &&op_0xAA, &&op_0xAB, &&op_0xAC, &&op_0xAD, &&op_0xAE, &&op_0xAF,
+            &&op_0xB0, &&op_0xB1, &&op_0xB2, &&op_0xB3, &&op_0xB4, &&op_0xB5, &&op_0xB6, &&op_0xB7,
+            &&op_0xB8, &&op_0xB9, &&op_0xBA, &&op_0xBB, &&op_0xBC, &&op_0xBD, &&op_0xBE, &&op_0xBF,
+            &&op_0xC0, &&op_0xC1, &&op_0xC2, &&op_0xC3, &&op_0xC4, &&op_0xC5, &&op_0xC6, &&op_0xC7,
+            &&op_0xC8, &&op_0xC9, &&op_0xCA, &&op_0xCB, &&op_0xCC, &&op_0xCD, &&op_0xCE, &&op_0xCF,
+            &&op_0xD0, &&op_0xD1, &&op_0xD2, &&op_0xD3, &&op_0xD4, &&op_0xD5, &&op_0xD6, &&op_0xD7,
+            &&op_0xD8, &&op_0xD9, &&op_0xDA, &&op_0xDB, &&op_0xDC, &&op_0xDD, &&op_0xDE, &&op_0xDF,
+            &&op_0xE0, &&op_0xE1, &&op_0xE2, &&op_0xE3, &&op_0xE4, &&op_0xE5, &&op_0xE6, &&op_0xE7,
+            &&op_0xE8, &&op_0xE9, &&op_0xEA, &&op_0xEB, &&op_0xEC, &&op_0xED, &&op_0xEE, &&op_0xEF,
+            &&op_0xF0, &&op_0xF1, &&op_0xF2, &&op_0xF3, &&op_0xF4, &&op_0xF5, &&op_0xF6, &&op_0xF7,
+            &&op_0xF8, &&op_0xF9, &&op_0xFA, &&op_0xFB, &&op_0xFC, &&op_0xFD, &&op_0xFE, &&op_0xFF
+         };
+#endif
+
          // NMI is currently unused by the lynx so lets save some time
          //
          //			Check NMI & IRQ status, prioritise NMI then IRQ
@@ -105,1429 +435,1546 @@ C65C02::C65C02(CSystem& parent)
 
          //    fprintf(stderr, "cpu update\n");
 
-         if(mSystem.mSystemIRQ && !mI)
-         {
-            // IRQ signal clearance is handled by CMikie::Update() as this
-            // is the only source of interrupts
-
-            // Push processor status
-            PUSH(mPC>>8);
-            PUSH(mPC&0xff);
-            PUSH(PS()&0xef);		// Clear B flag on stack
+         do {
+            if(mSystem.mSystemIRQ && !mI)
+            {
+               // IRQ signal clearance is handled by CMikie::Update() as this
+               // is the only source of interrupts
 
-            mI=TRUE;				// Stop further interrupts
-            mD=FALSE;				// Clear decimal mode
+               // Push processor status
+               PUSH(mPC>>8);
+               PUSH(mPC&0xff);
+               PUSH(PS()&0xef);		// Clear B flag on stack
 
-            // Pick up the new PC
-            mPC=CPU_PEEKW(IRQ_VECTOR);
+               mI=TRUE;				// Stop further interrupts
+               mD=FALSE;				// Clear decimal mode
 
-            // Save the sleep state as an irq has possibly woken the processor
-            mSystem.mSystemCPUSleep_Saved=mSystem.mSystemCPUSleep;
-            mSystem.mSystemCPUSleep=FALSE;
+               // Pick up the new PC
+               mPC=CPU_PEEKW(IRQ_VECTOR);
 
-            // Log the irq entry time
-            mSystem.mIRQEntryCycle=mSystem.mSystemCycleCount;
+               // Save the sleep state as an irq has possibly woken the processor
+               mSystem.mSystemCPUSleep_Saved=mSystem.mSystemCPUSleep;
+               mSystem.mSystemCPUSleep=FALSE;
 
-            // Clear the interrupt status line
-            mSystem.mSystemIRQ=FALSE;
-         }
-
-         //
-         // If the CPU is asleep then skip to the next timer event
-         //
-         if(mSystem.mSystemCPUSleep) {
-            return;
-         }
+               // Log the irq entry time
+               mSystem.mIRQEntryCycle=mSystem.mSystemCycleCount;
+               PROFILE_IRQ();
 
-         // Fetch opcode
-         mOpcode=CPU_PEEK(mPC);
-         mPC++;
+               // Whatever loop the CPU was in, it just left it
+               mIdleLoopStart=-1;
 
-         // Execute Opcode
+               // Clear the interrupt status line
+               mSystem.mSystemIRQ=FALSE;
 
-         switch(mOpcode)
-         {
+               // The handler's first instruction runs straight away, so the
+               // debugger has to look at it here
+               if constexpr(debug) {
+                  if(DebugBreakpoint()) return;
+               }
+            }
 
             //
-            // 0x00
+            // If the CPU is asleep then skip to the next timer event
             //
-            case 0x00:
-               mSystem.mSystemCycleCount+=(1+(6*CPU_RDWR_CYC));
-               // IMPLIED
-               xBRK();
-               break;
-            case 0x01:
-               mSystem.mSystemCycleCount+=(1+(5*CPU_RDWR_CYC));
-               xINDIRECT_X();
-               xORA();
-               break;
-            case 0x02:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-            case 0x03:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-            case 0x04:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               xZEROPAGE();
-               xTSB();
-               break;
-            case 0x05:
-               mSystem.mSystemCycleCount+=(1+(2*CPU_RDWR_CYC));
-               xZEROPAGE();
-               xORA();
-               break;
-            case 0x06:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               xZEROPAGE();
-               xASL();
-               break;
-            case 0x07:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-
-            case 0x08:
-               mSystem.mSystemCycleCount+=(1+(2*CPU_RDWR_CYC));
-               // IMPLIED
-               xPHP();
-               break;
-            case 0x09:
-               mSystem.mSystemCycleCount+=(1+(2*CPU_RDWR_CYC));
-               xIMMEDIATE();
-               xORA();
-               break;
-            case 0x0A:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // IMPLIED
-               xASLA();
-               break;
-            case 0x0B:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-            case 0x0C:
-               mSystem.mSystemCycleCount+=(1+(5*CPU_RDWR_CYC));
-               xABSOLUTE();
-               xTSB();
-               break;
-            case 0x0D:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               xABSOLUTE();
-               xORA();
-               break;
-            case 0x0E:
-               mSystem.mSystemCycleCount+=(1+(5*CPU_RDWR_CYC));
-               xABSOLUTE();
-               xASL();
-               break;
-            case 0x0F:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
+            if(mSystem.mSystemCPUSleep) {
+               return;
+            }
 
-               //
-               // 0x10
-               //
-            case 0x10:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // RELATIVE (IN FUNCTION)
-               xBPL();
-               break;
-            case 0x11:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               xINDIRECT_Y();
-               xORA();
-               break;
-            case 0x12:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               xINDIRECT();
-               xORA();
-               break;
-            case 0x13:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-            case 0x14:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               xZEROPAGE();
-               xTRB();
-               break;
-            case 0x15:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               xZEROPAGE_X();
-               xORA();
-               break;
-            case 0x16:
-               mSystem.mSystemCycleCount+=(1+(5*CPU_RDWR_CYC));
-               xZEROPAGE_X();
-               xASL();
-               break;
-            case 0x17:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-
-            case 0x18:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // IMPLIED
-               xCLC();
-               break;
-            case 0x19:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               xABSOLUTE_Y();
-               xORA();
-               break;
-            case 0x1A:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // IMPLIED
-               xINCA();
-               break;
-            case 0x1B:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-            case 0x1C:
-               mSystem.mSystemCycleCount+=(1+(5*CPU_RDWR_CYC));
-               xABSOLUTE();
-               xTRB();
-               break;
-            case 0x1D:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               xABSOLUTE_X();
-               xORA();
-               break;
-            case 0x1E:
-               mSystem.mSystemCycleCount+=(1+(6*CPU_RDWR_CYC));
-               xABSOLUTE_X();
-               xASL();
-               break;
-            case 0x1F:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
+            // Fetch opcode
+            FETCH_OPCODE;
 
-               //
-               // 0x20
-               //
-            case 0x20:
-               mSystem.mSystemCycleCount+=(1+(5*CPU_RDWR_CYC));
-               xABSOLUTE();
-               xJSR();
-               break;
-            case 0x21:
-               mSystem.mSystemCycleCount+=(1+(5*CPU_RDWR_CYC));
-               xINDIRECT_X();
-               xAND();
-               break;
-            case 0x22:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-            case 0x23:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-            case 0x24:
-               mSystem.mSystemCycleCount+=(1+(2*CPU_RDWR_CYC));
-               xZEROPAGE();
-               xBIT();
-               break;
-            case 0x25:
-               mSystem.mSystemCycleCount+=(1+(2*CPU_RDWR_CYC));
-               xZEROPAGE();
-               xAND();
-               break;
-            case 0x26:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               xZEROPAGE();
-               xROL();
-               break;
-            case 0x27:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-
-            case 0x28:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               // IMPLIED
-               xPLP();
-               break;
-            case 0x29:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               xIMMEDIATE();
-               xAND();
-               break;
-            case 0x2A:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // IMPLIED
-               xROLA();
-               break;
-            case 0x2B:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-            case 0x2C:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               xABSOLUTE();
-               xBIT();
-               break;
-            case 0x2D:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               xABSOLUTE();
-               xAND();
-               break;
-            case 0x2E:
-               mSystem.mSystemCycleCount+=(1+(5*CPU_RDWR_CYC));
-               xABSOLUTE();
-               xROL();
-               break;
-            case 0x2F:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
+            // Execute Opcode, OPCODE() adds its cycles
 
-               //
-               // 0x30
-               //
-            case 0x30:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // RELATIVE (IN FUNCTION)
-               xBMI();
-               break;
-            case 0x31:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               xINDIRECT_Y();
-               xAND();
-               break;
-            case 0x32:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               xINDIRECT();
-               xAND();
-               break;
-            case 0x33:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-            case 0x34:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               xZEROPAGE_X();
-               xBIT();
-               break;
-            case 0x35:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               xZEROPAGE_X();
-               xAND();
-               break;
-            case 0x36:
-               mSystem.mSystemCycleCount+=(1+(5*CPU_RDWR_CYC));
-               xZEROPAGE_X();
-               xROL();
-               break;
-            case 0x37:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-
-            case 0x38:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // IMPLIED
-               xSEC();
-               break;
-            case 0x39:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               xABSOLUTE_Y();
-               xAND();
-               break;
-            case 0x3A:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // IMPLIED
-               xDECA();
-               break;
-            case 0x3B:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-            case 0x3C:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               xABSOLUTE_X();
-               xBIT();
-               break;
-            case 0x3D:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               xABSOLUTE_X();
-               xAND();
-               break;
-            case 0x3E:
-               mSystem.mSystemCycleCount+=(1+(6*CPU_RDWR_CYC));
-               xABSOLUTE_X();
-               xROL();
-               break;
-            case 0x3F:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
+            switch(mOpcode)
+            {
 
                //
-               // 0x40
+               // 0x00
                //
-            case 0x40:
-               mSystem.mSystemCycleCount+=(1+(5*CPU_RDWR_CYC));
-               // Only clear IRQ if this is not a BRK instruction based RTI
-
-               // B flag is on the stack cant test the flag
-               int tmp;
-               PULL(tmp);
-               PUSH (tmp);
-               if(!(tmp&0x10))
-               {
-                  mSystem.mSystemCPUSleep=mSystem.mSystemCPUSleep_Saved;
-
-                  // If were in sleep mode then we need to push the
-                  // wakeup counter along by the same number of cycles
-                  // we have used during the sleep period
-                  if(mSystem.mSystemCPUSleep)
+               OPCODE(0x00)
+                  // IMPLIED
+                  xBRK();
+                  NEXT_OPCODE;
+               OPCODE(0x01)
+                  xINDIRECT_X();
+                  xORA();
+                  NEXT_OPCODE;
+               OPCODE(0x02)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+               OPCODE(0x03)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+               OPCODE(0x04)
+                  xZEROPAGE();
+                  xTSB();
+                  NEXT_OPCODE;
+               OPCODE(0x05)
+                  xZEROPAGE();
+                  xORA();
+                  NEXT_OPCODE;
+               OPCODE(0x06)
+                  xZEROPAGE();
+                  xASL();
+                  NEXT_OPCODE;
+               OPCODE(0x07)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+
+               OPCODE(0x08)
+                  // IMPLIED
+                  xPHP();
+                  NEXT_OPCODE;
+               OPCODE(0x09)
+                  xIMMEDIATE();
+                  xORA();
+                  NEXT_OPCODE;
+               OPCODE(0x0A)
+                  // IMPLIED
+                  xASLA();
+                  NEXT_OPCODE;
+               OPCODE(0x0B)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+               OPCODE(0x0C)
+                  xABSOLUTE();
+                  xTSB();
+                  NEXT_OPCODE;
+               OPCODE(0x0D)
+                  xABSOLUTE();
+                  xORA();
+                  NEXT_OPCODE;
+               OPCODE(0x0E)
+                  xABSOLUTE();
+                  xASL();
+                  NEXT_OPCODE;
+               OPCODE(0x0F)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+
+                  //
+                  // 0x10
+                  //
+               OPCODE(0x10)
+                  // RELATIVE (IN FUNCTION)
+                  xBPL();
+                  NEXT_OPCODE;
+               OPCODE(0x11)
+                  xINDIRECT_Y();
+                  xORA();
+                  NEXT_OPCODE;
+               OPCODE(0x12)
+                  xINDIRECT();
+                  xORA();
+                  NEXT_OPCODE;
+               OPCODE(0x13)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+               OPCODE(0x14)
+                  xZEROPAGE();
+                  xTRB();
+                  NEXT_OPCODE;
+               OPCODE(0x15)
+                  xZEROPAGE_X();
+                  xORA();
+                  NEXT_OPCODE;
+               OPCODE(0x16)
+                  xZEROPAGE_X();
+                  xASL();
+                  NEXT_OPCODE;
+               OPCODE(0x17)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+
+               OPCODE(0x18)
+                  // IMPLIED
+                  xCLC();
+                  NEXT_OPCODE;
+               OPCODE(0x19)
+                  xABSOLUTE_Y();
+                  xORA();
+                  NEXT_OPCODE;
+               OPCODE(0x1A)
+                  // IMPLIED
+                  xINCA();
+                  NEXT_OPCODE;
+               OPCODE(0x1B)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+               OPCODE(0x1C)
+                  xABSOLUTE();
+                  xTRB();
+                  NEXT_OPCODE;
+               OPCODE(0x1D)
+                  xABSOLUTE_X();
+                  xORA();
+                  NEXT_OPCODE;
+               OPCODE(0x1E)
+                  xABSOLUTE_X();
+                  xASL();
+                  NEXT_OPCODE;
+               OPCODE(0x1F)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+
+                  //
+                  // 0x20
+                  //
+               OPCODE(0x20)
+                  xABSOLUTE();
+                  xJSR();
+                  NEXT_OPCODE;
+               OPCODE(0x21)
+                  xINDIRECT_X();
+                  xAND();
+                  NEXT_OPCODE;
+               OPCODE(0x22)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+               OPCODE(0x23)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+               OPCODE(0x24)
+                  xZEROPAGE();
+                  xBIT();
+                  NEXT_OPCODE;
+               OPCODE(0x25)
+                  xZEROPAGE();
+                  xAND();
+                  NEXT_OPCODE;
+               OPCODE(0x26)
+                  xZEROPAGE();
+                  xROL();
+                  NEXT_OPCODE;
+               OPCODE(0x27)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+
+               OPCODE(0x28)
+                  // IMPLIED
+                  xPLP();
+                  NEXT_OPCODE;
+               OPCODE(0x29)
+                  xIMMEDIATE();
+                  xAND();
+                  NEXT_OPCODE;
+               OPCODE(0x2A)
+                  // IMPLIED
+                  xROLA();
+                  NEXT_OPCODE;
+               OPCODE(0x2B)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+               OPCODE(0x2C)
+                  xABSOLUTE();
+                  xBIT();
+                  NEXT_OPCODE;
+               OPCODE(0x2D)
+                  xABSOLUTE();
+                  xAND();
+                  NEXT_OPCODE;
+               OPCODE(0x2E)
+                  xABSOLUTE();
+                  xROL();
+                  NEXT_OPCODE;
+               OPCODE(0x2F)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+
+                  //
+                  // 0x30
+                  //
+               OPCODE(0x30)
+                  // RELATIVE (IN FUNCTION)
+                  xBMI();
+                  NEXT_OPCODE;
+               OPCODE(0x31)
+                  xINDIRECT_Y();
+                  xAND();
+                  NEXT_OPCODE;
+               OPCODE(0x32)
+                  xINDIRECT();
+                  xAND();
+                  NEXT_OPCODE;
+               OPCODE(0x33)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+               OPCODE(0x34)
+                  xZEROPAGE_X();
+                  xBIT();
+                  NEXT_OPCODE;
+               OPCODE(0x35)
+                  xZEROPAGE_X();
+                  xAND();
+                  NEXT_OPCODE;
+               OPCODE(0x36)
+                  xZEROPAGE_X();
+                  xROL();
+                  NEXT_OPCODE;
+               OPCODE(0x37)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+
+               OPCODE(0x38)
+                  // IMPLIED
+                  xSEC();
+                  NEXT_OPCODE;
+               OPCODE(0x39)
+                  xABSOLUTE_Y();
+                  xAND();
+                  NEXT_OPCODE;
+               OPCODE(0x3A)
+                  // IMPLIED
+                  xDECA();
+                  NEXT_OPCODE;
+               OPCODE(0x3B)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+               OPCODE(0x3C)
+                  xABSOLUTE_X();
+                  xBIT();
+                  NEXT_OPCODE;
+               OPCODE(0x3D)
+                  xABSOLUTE_X();
+                  xAND();
+                  NEXT_OPCODE;
+               OPCODE(0x3E)
+                  xABSOLUTE_X();
+                  xROL();
+                  NEXT_OPCODE;
+               OPCODE(0x3F)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+
+                  //
+                  // 0x40
+                  //
+               OPCODE(0x40)
+                  // Only clear IRQ if this is not a BRK instruction based RTI
+
+                  // B flag is on the stack cant test the flag
+                  int tmp;
+                  PULL(tmp);
+                  PUSH (tmp);
+                  if(!(tmp&0x10))
                   {
-                     mSystem.mCPUWakeupTime+=mSystem.mSystemCycleCount-mSystem.mIRQEntryCycle;
+                     PROFILE_RTI();
+                     mSystem.mSystemCPUSleep=mSystem.mSystemCPUSleep_Saved;
+
+                     // If were in sleep mode then we need to push the
+                     // wakeup counter along by the same number of cycles
+                     // we have used during the sleep period
+                     if(mSystem.mSystemCPUSleep)
+                     {
+                        mSystem.mCPUWakeupTime+=mSystem.mSystemCycleCount-mSystem.mIRQEntryCycle;
+                     }
                   }
-               }
-               // IMPLIED
-               xRTI();
-               break;
-            case 0x41:
-               mSystem.mSystemCycleCount+=(1+(5*CPU_RDWR_CYC));
-               xINDIRECT_X();
-               xEOR();
-               break;
-            case 0x42:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-            case 0x43:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-            case 0x44:
-               mSystem.mSystemCycleCount+=(1+(2*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-            case 0x45:
-               mSystem.mSystemCycleCount+=(1+(2*CPU_RDWR_CYC));
-               xZEROPAGE();
-               xEOR();
-               break;
-            case 0x46:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               xZEROPAGE();
-               xLSR();
-               break;
-            case 0x47:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-
-            case 0x48:
-               mSystem.mSystemCycleCount+=(1+(2*CPU_RDWR_CYC));
-               // IMPLIED
-               xPHA();
-               break;
-            case 0x49:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               xIMMEDIATE();
-               xEOR();
-               break;
-            case 0x4A:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // IMPLIED
-               xLSRA();
-               break;
-            case 0x4B:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-            case 0x4C:
-               mSystem.mSystemCycleCount+=(1+(2*CPU_RDWR_CYC));
-               xABSOLUTE();
-               xJMP();
-               break;
-            case 0x4D:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               xABSOLUTE();
-               xEOR();
-               break;
-            case 0x4E:
-               mSystem.mSystemCycleCount+=(1+(5*CPU_RDWR_CYC));
-               xABSOLUTE();
-               xLSR();
-               break;
-            case 0x4F:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
+                  // IMPLIED
+                  xRTI();
+                  NEXT_OPCODE;
+               OPCODE(0x41)
+                  xINDIRECT_X();
+                  xEOR();
+                  NEXT_OPCODE;
+               OPCODE(0x42)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+               OPCODE(0x43)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+               OPCODE(0x44)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+               OPCODE(0x45)
+                  xZEROPAGE();
+                  xEOR();
+                  NEXT_OPCODE;
+               OPCODE(0x46)
+                  xZEROPAGE();
+                  xLSR();
+                  NEXT_OPCODE;
+               OPCODE(0x47)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
 
-               //
-               // 0x50
-               //
-            case 0x50:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // RELATIVE (IN FUNCTION)
-               xBVC();
-               break;
-            case 0x51:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               xINDIRECT_Y();
-               xEOR();
-               break;
-            case 0x52:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               xINDIRECT();
-               xEOR();
-               break;
-            case 0x53:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-            case 0x54:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-            case 0x55:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               xZEROPAGE_X();
-               xEOR();
-               break;
-            case 0x56:
-               mSystem.mSystemCycleCount+=(1+(5*CPU_RDWR_CYC));
-               xZEROPAGE_X();
-               xLSR();
-               break;
-            case 0x57:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-
-            case 0x58:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // IMPLIED
-               xCLI();
-               break;
-            case 0x59:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               xABSOLUTE_Y();
-               xEOR();
-               break;
-            case 0x5A:
-               mSystem.mSystemCycleCount+=(1+(2*CPU_RDWR_CYC));
-               // IMPLIED
-               xPHY();
-               break;
-            case 0x5B:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-            case 0x5C:
-               mSystem.mSystemCycleCount+=(1+(7*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-            case 0x5D:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               xABSOLUTE_X();
-               xEOR();
-               break;
-            case 0x5E:
-               mSystem.mSystemCycleCount+=(1+(6*CPU_RDWR_CYC));
-               xABSOLUTE_X();
-               xLSR();
-               break;
-            case 0x5F:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
+               OPCODE(0x48)
+                  // IMPLIED
+                  xPHA();
+                  NEXT_OPCODE;
+               OPCODE(0x49)
+                  xIMMEDIATE();
+                  xEOR();
+                  NEXT_OPCODE;
+               OPCODE(0x4A)
+                  // IMPLIED
+                  xLSRA();
+                  NEXT_OPCODE;
+               OPCODE(0x4B)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+               OPCODE(0x4C)
+                  xABSOLUTE();
+                  {
+                     int offset=mOperand-mPC;
+                     xJMP();
+                     IDLE_LOOP_CHECK(offset);
+                  }
+                  NEXT_OPCODE;
+               OPCODE(0x4D)
+                  xABSOLUTE();
+                  xEOR();
+                  NEXT_OPCODE;
+               OPCODE(0x4E)
+                  xABSOLUTE();
+                  xLSR();
+                  NEXT_OPCODE;
+               OPCODE(0x4F)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
 
-               //
-               // 0x60
-               //
-            case 0x60:
-               mSystem.mSystemCycleCount+=(1+(5*CPU_RDWR_CYC));
-               // IMPLIED
-               xRTS();
-               break;
-            case 0x61:
-               mSystem.mSystemCycleCount+=(1+(5*CPU_RDWR_CYC));
-               xINDIRECT_X();
-               xADC();
-               break;
-            case 0x62:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-            case 0x63:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-            case 0x64:
-               mSystem.mSystemCycleCount+=(1+(2*CPU_RDWR_CYC));
-               xZEROPAGE();
-               xSTZ();
-               break;
-            case 0x65:
-               mSystem.mSystemCycleCount+=(1+(2*CPU_RDWR_CYC));
-               xZEROPAGE();
-               xADC();
-               break;
-            case 0x66:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               xZEROPAGE();
-               xROR();
-               break;
-            case 0x67:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-
-            case 0x68:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               // IMPLIED
-               xPLA();
-               break;
-            case 0x69:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               xIMMEDIATE();
-               xADC();
-               break;
-            case 0x6A:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // IMPLIED
-               xRORA();
-               break;
-            case 0x6B:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-            case 0x6C:
-               mSystem.mSystemCycleCount+=(1+(5*CPU_RDWR_CYC));
-               xINDIRECT_ABSOLUTE();
-               xJMP();
-               break;
-            case 0x6D:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               xABSOLUTE();
-               xADC();
-               break;
-            case 0x6E:
-               mSystem.mSystemCycleCount+=(1+(5*CPU_RDWR_CYC));
-               xABSOLUTE();
-               xROR();
-               break;
-            case 0x6F:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
+                  //
+                  // 0x50
+                  //
+               OPCODE(0x50)
+                  // RELATIVE (IN FUNCTION)
+                  xBVC();
+                  NEXT_OPCODE;
+               OPCODE(0x51)
+                  xINDIRECT_Y();
+                  xEOR();
+                  NEXT_OPCODE;
+               OPCODE(0x52)
+                  xINDIRECT();
+                  xEOR();
+                  NEXT_OPCODE;
+               OPCODE(0x53)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+               OPCODE(0x54)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+               OPCODE(0x55)
+                  xZEROPAGE_X();
+                  xEOR();
+                  NEXT_OPCODE;
+               OPCODE(0x56)
+                  xZEROPAGE_X();
+                  xLSR();
+                  NEXT_OPCODE;
+               OPCODE(0x57)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
 
-               //
-               // 0x70
-               //
-            case 0x70:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // RELATIVE (IN FUNCTION)
-               xBVS();
-               break;
-            case 0x71:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               xINDIRECT_Y();
-               xADC();
-               break;
-            case 0x72:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               xINDIRECT();
-               xADC();
-               break;
-            case 0x73:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-            case 0x74:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               xZEROPAGE_X();
-               xSTZ();
-               break;
-            case 0x75:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               xZEROPAGE_X();
-               xADC();
-               break;
-            case 0x76:
-               mSystem.mSystemCycleCount+=(1+(5*CPU_RDWR_CYC));
-               xZEROPAGE_X();
-               xROR();
-               break;
-            case 0x77:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-
-            case 0x78:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // IMPLIED
-               xSEI();
-               break;
-            case 0x79:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               xABSOLUTE_Y();
-               xADC();
-               break;
-            case 0x7A:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               // IMPLIED
-               xPLY();
-               break;
-            case 0x7B:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-            case 0x7C:
-               mSystem.mSystemCycleCount+=(1+(5*CPU_RDWR_CYC));
-               xINDIRECT_ABSOLUTE_X();
-               xJMP();
-               break;
-            case 0x7D:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               xABSOLUTE_X();
-               xADC();
-               break;
-            case 0x7E:
-               mSystem.mSystemCycleCount+=(1+(6*CPU_RDWR_CYC));
-               xABSOLUTE_X();
-               xROR();
-               break;
-            case 0x7F:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
+               OPCODE(0x58)
+                  // IMPLIED
+                  xCLI();
+                  NEXT_OPCODE;
+               OPCODE(0x59)
+                  xABSOLUTE_Y();
+                  xEOR();
+                  NEXT_OPCODE;
+               OPCODE(0x5A)
+                  // IMPLIED
+                  xPHY();
+                  NEXT_OPCODE;
+               OPCODE(0x5B)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+               OPCODE(0x5C)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+               OPCODE(0x5D)
+                  xABSOLUTE_X();
+                  xEOR();
+                  NEXT_OPCODE;
+               OPCODE(0x5E)
+                  xABSOLUTE_X();
+                  xLSR();
+                  NEXT_OPCODE;
+               OPCODE(0x5F)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
 
-               //
-               // 0x80
-               //
-            case 0x80:
-               mSystem.mSystemCycleCount+=(1+(2*CPU_RDWR_CYC));
-               // RELATIVE (IN FUNCTION)
-               xBRA();
-               break;
-            case 0x81:
-               mSystem.mSystemCycleCount+=(1+(5*CPU_RDWR_CYC));
-               xINDIRECT_X();
-               xSTA();
-               break;
-            case 0x82:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-            case 0x83:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-            case 0x84:
-               mSystem.mSystemCycleCount+=(1+(2*CPU_RDWR_CYC));
-               xZEROPAGE();
-               xSTY();
-               break;
-            case 0x85:
-               mSystem.mSystemCycleCount+=(1+(2*CPU_RDWR_CYC));
-               xZEROPAGE();
-               xSTA();
-               break;
-            case 0x86:
-               mSystem.mSystemCycleCount+=(1+(2*CPU_RDWR_CYC));
-               xZEROPAGE();
-               xSTX();
-               break;
-            case 0x87:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-
-            case 0x88:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // IMPLIED
-               xDEY();
-               break;
-            case 0x89:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               xIMMEDIATE();
-               xBIT();
-               break;
-            case 0x8A:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // IMPLIED
-               xTXA();
-               break;
-            case 0x8B:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-            case 0x8C:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               xABSOLUTE();
-               xSTY();
-               break;
-            case 0x8D:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               xABSOLUTE();
-               xSTA();
-               break;
-            case 0x8E:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               xABSOLUTE();
-               xSTX();
-               break;
-            case 0x8F:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
+                  //
+                  // 0x60
+                  //
+               OPCODE(0x60)
+                  // IMPLIED
+                  xRTS();
+                  NEXT_OPCODE;
+               OPCODE(0x61)
+                  xINDIRECT_X();
+                  xADC();
+                  NEXT_OPCODE;
+               OPCODE(0x62)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+               OPCODE(0x63)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+               OPCODE(0x64)
+                  xZEROPAGE();
+                  xSTZ();
+                  NEXT_OPCODE;
+               OPCODE(0x65)
+                  xZEROPAGE();
+                  xADC();
+                  NEXT_OPCODE;
+               OPCODE(0x66)
+                  xZEROPAGE();
+                  xROR();
+                  NEXT_OPCODE;
+               OPCODE(0x67)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
 
-               //
-               // 0x90
-               //
-            case 0x90:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // RELATIVE (IN FUNCTION)
-               xBCC();
-               break;
-            case 0x91:
-               mSystem.mSystemCycleCount+=(1+(5*CPU_RDWR_CYC));
-               xINDIRECT_Y();
-               xSTA();
-               break;
-            case 0x92:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               xINDIRECT();
-               xSTA();
-               break;
-            case 0x93:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-            case 0x94:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               xZEROPAGE_X();
-               xSTY();
-               break;
-            case 0x95:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               xZEROPAGE_X();
-               xSTA();
-               break;
-            case 0x96:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               xZEROPAGE_Y();
-               xSTX();
-               break;
-            case 0x97:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-
-            case 0x98:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // IMPLIED
-               xTYA();
-               break;
-            case 0x99:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               xABSOLUTE_Y();
-               xSTA();
-               break;
-            case 0x9A:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // IMPLIED
-               xTXS();
-               break;
-            case 0x9B:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-            case 0x9C:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               xABSOLUTE();
-               xSTZ();
-               break;
-            case 0x9D:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               xABSOLUTE_X();
-               xSTA();
-               break;
-            case 0x9E:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               xABSOLUTE_X();
-               xSTZ();
-               break;
-            case 0x9F:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
+               OPCODE(0x68)
+                  // IMPLIED
+                  xPLA();
+                  NEXT_OPCODE;
+               OPCODE(0x69)
+                  xIMMEDIATE();
+                  xADC();
+                  NEXT_OPCODE;
+               OPCODE(0x6A)
+                  // IMPLIED
+                  xRORA();
+                  NEXT_OPCODE;
+               OPCODE(0x6B)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+               OPCODE(0x6C)
+                  xINDIRECT_ABSOLUTE();
+                  xJMP();
+                  NEXT_OPCODE;
+               OPCODE(0x6D)
+                  xABSOLUTE();
+                  xADC();
+                  NEXT_OPCODE;
+               OPCODE(0x6E)
+                  xABSOLUTE();
+                  xROR();
+                  NEXT_OPCODE;
+               OPCODE(0x6F)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
 
-               //
-               // 0xA0
-               //
-            case 0xA0:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               xIMMEDIATE();
-               xLDY();
-               break;
-            case 0xA1:
-               mSystem.mSystemCycleCount+=(1+(5*CPU_RDWR_CYC));
-               xINDIRECT_X();
-               xLDA();
-               break;
-            case 0xA2:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               xIMMEDIATE();
-               xLDX();
-               break;
-            case 0xA3:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-            case 0xA4:
-               mSystem.mSystemCycleCount+=(1+(2*CPU_RDWR_CYC));
-               xZEROPAGE();
-               xLDY();
-               break;
-            case 0xA5:
-               mSystem.mSystemCycleCount+=(1+(2*CPU_RDWR_CYC));
-               xZEROPAGE();
-               xLDA();
-               break;
-            case 0xA6:
-               mSystem.mSystemCycleCount+=(1+(2*CPU_RDWR_CYC));
-               xZEROPAGE();
-               xLDX();
-               break;
-            case 0xA7:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-
-            case 0xA8:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // IMPLIED
-               xTAY();
-               break;
-            case 0xA9:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               xIMMEDIATE();
-               xLDA();
-               break;
-            case 0xAA:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // IMPLIED
-               xTAX();
-               break;
-            case 0xAB:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-            case 0xAC:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               xABSOLUTE();
-               xLDY();
-               break;
-            case 0xAD:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               xABSOLUTE();
-               xLDA();
-               break;
-            case 0xAE:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               xABSOLUTE();
-               xLDX();
-               break;
-            case 0xAF:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
+                  //
+                  // 0x70
+                  //
+               OPCODE(0x70)
+                  // RELATIVE (IN FUNCTION)
+                  xBVS();
+                  NEXT_OPCODE;
+               OPCODE(0x71)
+                  xINDIRECT_Y();
+                  xADC();
+                  NEXT_OPCODE;
+               OPCODE(0x72)
+                  xINDIRECT();
+                  xADC();
+                  NEXT_OPCODE;
+               OPCODE(0x73)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+               OPCODE(0x74)
+                  xZEROPAGE_X();
+                  xSTZ();
+                  NEXT_OPCODE;
+               OPCODE(0x75)
+                  xZEROPAGE_X();
+                  xADC();
+                  NEXT_OPCODE;
+               OPCODE(0x76)
+                  xZEROPAGE_X();
+                  xROR();
+                  NEXT_OPCODE;
+               OPCODE(0x77)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
 
-               //
-               // 0xB0
-               //
-            case 0xB0:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // RELATIVE (IN FUNCTION)
-               xBCS();
-               break;
-            case 0xB1:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               xINDIRECT_Y();
-               xLDA();
-               break;
-            case 0xB2:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               xINDIRECT();
-               xLDA();
-               break;
-            case 0xB3:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-            case 0xB4:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               xZEROPAGE_X();
-               xLDY();
-               break;
-            case 0xB5:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               xZEROPAGE_X();
-               xLDA();
-               break;
-            case 0xB6:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               xZEROPAGE_Y();
-               xLDX();
-               break;
-            case 0xB7:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-
-            case 0xB8:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // IMPLIED
-               xCLV();
-               break;
-            case 0xB9:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               xABSOLUTE_Y();
-               xLDA();
-               break;
-            case 0xBA:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // IMPLIED
-               xTSX();
-               break;
-            case 0xBB:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-            case 0xBC:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               xABSOLUTE_X();
-               xLDY();
-               break;
-            case 0xBD:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               xABSOLUTE_X();
-               xLDA();
-               break;
-            case 0xBE:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               xABSOLUTE_Y();
-               xLDX();
-               break;
-            case 0xBF:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
+               OPCODE(0x78)
+                  // IMPLIED
+                  xSEI();
+                  NEXT_OPCODE;
+               OPCODE(0x79)
+                  xABSOLUTE_Y();
+                  xADC();
+                  NEXT_OPCODE;
+               OPCODE(0x7A)
+                  // IMPLIED
+                  xPLY();
+                  NEXT_OPCODE;
+               OPCODE(0x7B)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+               OPCODE(0x7C)
+                  xINDIRECT_ABSOLUTE_X();
+                  xJMP();
+                  NEXT_OPCODE;
+               OPCODE(0x7D)
+                  xABSOLUTE_X();
+                  xADC();
+                  NEXT_OPCODE;
+               OPCODE(0x7E)
+                  xABSOLUTE_X();
+                  xROR();
+                  NEXT_OPCODE;
+               OPCODE(0x7F)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
 
-               //
-               // 0xC0
-               //
-            case 0xC0:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               xIMMEDIATE();
-               xCPY();
-               break;
-            case 0xC1:
-               mSystem.mSystemCycleCount+=(1+(5*CPU_RDWR_CYC));
-               xINDIRECT_X();
-               xCMP();
-               break;
-            case 0xC2:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-            case 0xC3:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-            case 0xC4:
-               mSystem.mSystemCycleCount+=(1+(2*CPU_RDWR_CYC));
-               xZEROPAGE();
-               xCPY();
-               break;
-            case 0xC5:
-               mSystem.mSystemCycleCount+=(1+(2*CPU_RDWR_CYC));
-               xZEROPAGE();
-               xCMP();
-               break;
-            case 0xC6:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               xZEROPAGE();
-               xDEC();
-               break;
-            case 0xC7:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-
-            case 0xC8:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // IMPLIED
-               xINY();
-               break;
-            case 0xC9:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               xIMMEDIATE();
-               xCMP();
-               break;
-            case 0xCA:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // IMPLIED
-               xDEX();
-               break;
-            case 0xCB:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // IMPLIED
-               xWAI();
-               break;
-            case 0xCC:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               xABSOLUTE();
-               xCPY();
-               break;
-            case 0xCD:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               xABSOLUTE();
-               xCMP();
-               break;
-            case 0xCE:
-               mSystem.mSystemCycleCount+=(1+(5*CPU_RDWR_CYC));
-               xABSOLUTE();
-               xDEC();
-               break;
-            case 0xCF:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
+                  //
+                  // 0x80
+                  //
+               OPCODE(0x80)
+                  // RELATIVE (IN FUNCTION)
+                  xBRA();
+                  NEXT_OPCODE;
+               OPCODE(0x81)
+                  xINDIRECT_X();
+                  xSTA();
+                  NEXT_OPCODE;
+               OPCODE(0x82)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+               OPCODE(0x83)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+               OPCODE(0x84)
+                  xZEROPAGE();
+                  xSTY();
+                  NEXT_OPCODE;
+               OPCODE(0x85)
+                  xZEROPAGE();
+                  xSTA();
+                  NEXT_OPCODE;
+               OPCODE(0x86)
+                  xZEROPAGE();
+                  xSTX();
+                  NEXT_OPCODE;
+               OPCODE(0x87)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
 
-               //
-               // 0xD0
-               //
-            case 0xD0:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // RELATIVE (IN FUNCTION)
-               xBNE();
-               break;
-            case 0xD1:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               xINDIRECT_Y();
-               xCMP();
-               break;
-            case 0xD2:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               xINDIRECT();
-               xCMP();
-               break;
-            case 0xD3:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-            case 0xD4:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-            case 0xD5:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               xZEROPAGE_X();
-               xCMP();
-               break;
-            case 0xD6:
-               mSystem.mSystemCycleCount+=(1+(5*CPU_RDWR_CYC));
-               xZEROPAGE_X();
-               xDEC();
-               break;
-            case 0xD7:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-
-            case 0xD8:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // IMPLIED
-               xCLD();
-               break;
-            case 0xD9:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               xABSOLUTE_Y();
-               xCMP();
-               break;
-            case 0xDA:
-               mSystem.mSystemCycleCount+=(1+(2*CPU_RDWR_CYC));
-               // IMPLIED
-               xPHX();
-               break;
-            case 0xDB:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // IMPLIED
-               xSTP();
-               break;
-            case 0xDC:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-            case 0xDD:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               xABSOLUTE_X();
-               xCMP();
-               break;
-            case 0xDE:
-               mSystem.mSystemCycleCount+=(1+(6*CPU_RDWR_CYC));
-               xABSOLUTE_X();
-               xDEC();
-               break;
-            case 0xDF:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
+               OPCODE(0x88)
+                  // IMPLIED
+                  xDEY();
+                  NEXT_OPCODE;
+               OPCODE(0x89)
+                  xIMMEDIATE();
+                  xBIT();
+                  NEXT_OPCODE;
+               OPCODE(0x8A)
+                  // IMPLIED
+                  xTXA();
+                  NEXT_OPCODE;
+               OPCODE(0x8B)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+               OPCODE(0x8C)
+                  xABSOLUTE();
+                  xSTY();
+                  NEXT_OPCODE;
+               OPCODE(0x8D)
+                  xABSOLUTE();
+                  xSTA();
+                  NEXT_OPCODE;
+               OPCODE(0x8E)
+                  xABSOLUTE();
+                  xSTX();
+                  NEXT_OPCODE;
+               OPCODE(0x8F)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
 
-               //
-               // 0xE0
-               //
-            case 0xE0:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               xIMMEDIATE();
-               xCPX();
-               break;
-            case 0xE1:
-               mSystem.mSystemCycleCount+=(1+(5*CPU_RDWR_CYC));
-               xINDIRECT_X();
-               xSBC();
-               break;
-            case 0xE2:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-            case 0xE3:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-            case 0xE4:
-               mSystem.mSystemCycleCount+=(1+(2*CPU_RDWR_CYC));
-               xZEROPAGE();
-               xCPX();
-               break;
-            case 0xE5:
-               mSystem.mSystemCycleCount+=(1+(2*CPU_RDWR_CYC));
-               xZEROPAGE();
-               xSBC();
-               break;
-            case 0xE6:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               xZEROPAGE();
-               xINC();
-               break;
-            case 0xE7:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-
-            case 0xE8:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // IMPLIED
-               xINX();
-               break;
-            case 0xE9:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               xIMMEDIATE();
-               xSBC();
-               break;
-            case 0xEA:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // IMPLIED
-               xNOP();
-               break;
-            case 0xEB:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-            case 0xEC:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               xABSOLUTE();
-               xCPX();
-               break;
-            case 0xED:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               xABSOLUTE();
-               xSBC();
-               break;
-            case 0xEE:
-               mSystem.mSystemCycleCount+=(1+(5*CPU_RDWR_CYC));
-               xABSOLUTE();
-               xINC();
-               break;
-            case 0xEF:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
+                  //
+                  // 0x90
+                  //
+               OPCODE(0x90)
+                  // RELATIVE (IN FUNCTION)
+                  xBCC();
+                  NEXT_OPCODE;
+               OPCODE(0x91)
+                  xINDIRECT_Y();
+                  xSTA();
+                  NEXT_OPCODE;
+               OPCODE(0x92)
+                  xINDIRECT();
+                  xSTA();
+                  NEXT_OPCODE;
+               OPCODE(0x93)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+               OPCODE(0x94)
+                  xZEROPAGE_X();
+                  xSTY();
+                  NEXT_OPCODE;
+               OPCODE(0x95)
+                  xZEROPAGE_X();
+                  xSTA();
+                  NEXT_OPCODE;
+               OPCODE(0x96)
+                  xZEROPAGE_Y();
+                  xSTX();
+                  NEXT_OPCODE;
+               OPCODE(0x97)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
 
-               //
-               // 0xF0
-               //
-            case 0xF0:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // RELATIVE (IN FUNCTION)
-               xBEQ();
-               break;
-            case 0xF1:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               xINDIRECT_Y();
-               xSBC();
-               break;
-            case 0xF2:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               xINDIRECT();
-               xSBC();
-               break;
-            case 0xF3:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-            case 0xF4:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-            case 0xF5:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               xZEROPAGE_X();
-               xSBC();
-               break;
-            case 0xF6:
-               mSystem.mSystemCycleCount+=(1+(5*CPU_RDWR_CYC));
-               xZEROPAGE_X();
-               xINC();
-               break;
-            case 0xF7:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-
-            case 0xF8:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // IMPLIED
-               xSED();
-               break;
-            case 0xF9:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               xABSOLUTE_Y();
-               xSBC();
-               break;
-            case 0xFA:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               // IMPLIED
-               xPLX();
-               break;
-            case 0xFB:
-               mSystem.mSystemCycleCount+=(1+(1*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-            case 0xFC:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
-            case 0xFD:
-               mSystem.mSystemCycleCount+=(1+(3*CPU_RDWR_CYC));
-               xABSOLUTE_X();
-               xSBC();
-               break;
-            case 0xFE:
-               mSystem.mSystemCycleCount+=(1+(6*CPU_RDWR_CYC));
-               xABSOLUTE_X();
-               xINC();
-               break;
-            case 0xFF:
-               mSystem.mSystemCycleCount+=(1+(4*CPU_RDWR_CYC));
-               // *** ILLEGAL ***
-               xILLEGAL();
-               break;
+               OPCODE(0x98)
+                  // IMPLIED
+                  xTYA();
+                  NEXT_OPCODE;
+               OPCODE(0x99)
+                  xABSOLUTE_Y();
+                  xSTA();
+                  NEXT_OPCODE;
+               OPCODE(0x9A)
+                  // IMPLIED
+                  xTXS();
+                  NEXT_OPCODE;
+               OPCODE(0x9B)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+               OPCODE(0x9C)
+                  xABSOLUTE();
+                  xSTZ();
+                  NEXT_OPCODE;
+               OPCODE(0x9D)
+                  xABSOLUTE_X();
+                  xSTA();
+                  NEXT_OPCODE;
+               OPCODE(0x9E)
+                  xABSOLUTE_X();
+                  xSTZ();
+                  NEXT_OPCODE;
+               OPCODE(0x9F)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+
+                  //
+                  // 0xA0
+                  //
+               OPCODE(0xA0)
+                  xIMMEDIATE();
+                  xLDY();
+                  NEXT_OPCODE;
+               OPCODE(0xA1)
+                  xINDIRECT_X();
+                  xLDA();
+                  NEXT_OPCODE;
+               OPCODE(0xA2)
+                  xIMMEDIATE();
+                  xLDX();
+                  NEXT_OPCODE;
+               OPCODE(0xA3)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+               OPCODE(0xA4)
+                  xZEROPAGE();
+                  xLDY();
+                  NEXT_OPCODE;
+               OPCODE(0xA5)
+                  xZEROPAGE();
+                  xLDA();
+                  NEXT_OPCODE;
+               OPCODE(0xA6)
+                  xZEROPAGE();
+                  xLDX();
+                  NEXT_OPCODE;
+               OPCODE(0xA7)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+
+               OPCODE(0xA8)
+                  // IMPLIED
+                  xTAY();
+                  NEXT_OPCODE;
+               OPCODE(0xA9)
+                  xIMMEDIATE();
+                  xLDA();
+                  NEXT_OPCODE;
+               OPCODE(0xAA)
+                  // IMPLIED
+                  xTAX();
+                  NEXT_OPCODE;
+               OPCODE(0xAB)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+               OPCODE(0xAC)
+                  xABSOLUTE();
+                  xLDY();
+                  NEXT_OPCODE;
+               OPCODE(0xAD)
+                  xABSOLUTE();
+                  xLDA();
+                  NEXT_OPCODE;
+               OPCODE(0xAE)
+                  xABSOLUTE();
+                  xLDX();
+                  NEXT_OPCODE;
+               OPCODE(0xAF)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+
+                  //
+                  // 0xB0
+                  //
+               OPCODE(0xB0)
+                  // RELATIVE (IN FUNCTION)
+                  xBCS();
+                  NEXT_OPCODE;
+               OPCODE(0xB1)
+                  xINDIRECT_Y();
+                  xLDA();
+                  NEXT_OPCODE;
+               OPCODE(0xB2)
+                  xINDIRECT();
+                  xLDA();
+                  NEXT_OPCODE;
+               OPCODE(0xB3)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+               OPCODE(0xB4)
+                  xZEROPAGE_X();
+                  xLDY();
+                  NEXT_OPCODE;
+               OPCODE(0xB5)
+                  xZEROPAGE_X();
+                  xLDA();
+                  NEXT_OPCODE;
+               OPCODE(0xB6)
+                  xZEROPAGE_Y();
+                  xLDX();
+                  NEXT_OPCODE;
+               OPCODE(0xB7)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+
+               OPCODE(0xB8)
+                  // IMPLIED
+                  xCLV();
+                  NEXT_OPCODE;
+               OPCODE(0xB9)
+                  xABSOLUTE_Y();
+                  xLDA();
+                  NEXT_OPCODE;
+               OPCODE(0xBA)
+                  // IMPLIED
+                  xTSX();
+                  NEXT_OPCODE;
+               OPCODE(0xBB)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+               OPCODE(0xBC)
+                  xABSOLUTE_X();
+                  xLDY();
+                  NEXT_OPCODE;
+               OPCODE(0xBD)
+                  xABSOLUTE_X();
+                  xLDA();
+                  NEXT_OPCODE;
+               OPCODE(0xBE)
+                  xABSOLUTE_Y();
+                  xLDX();
+                  NEXT_OPCODE;
+               OPCODE(0xBF)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+
+                  //
+                  // 0xC0
+                  //
+               OPCODE(0xC0)
+                  xIMMEDIATE();
+                  xCPY();
+                  NEXT_OPCODE;
+               OPCODE(0xC1)
+                  xINDIRECT_X();
+                  xCMP();
+                  NEXT_OPCODE;
+               OPCODE(0xC2)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+               OPCODE(0xC3)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+               OPCODE(0xC4)
+                  xZEROPAGE();
+                  xCPY();
+                  NEXT_OPCODE;
+               OPCODE(0xC5)
+                  xZEROPAGE();
+                  xCMP();
+                  NEXT_OPCODE;
+               OPCODE(0xC6)
+                  xZEROPAGE();
+                  xDEC();
+                  NEXT_OPCODE;
+               OPCODE(0xC7)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+
+               OPCODE(0xC8)
+                  // IMPLIED
+                  xINY();
+                  NEXT_OPCODE;
+               OPCODE(0xC9)
+                  xIMMEDIATE();
+                  xCMP();
+                  NEXT_OPCODE;
+               OPCODE(0xCA)
+                  // IMPLIED
+                  xDEX();
+                  NEXT_OPCODE;
+               OPCODE(0xCB)
+                  // IMPLIED
+                  xWAI();
+                  NEXT_OPCODE;
+               OPCODE(0xCC)
+                  xABSOLUTE();
+                  xCPY();
+                  NEXT_OPCODE;
+               OPCODE(0xCD)
+                  xABSOLUTE();
+                  xCMP();
+                  NEXT_OPCODE;
+               OPCODE(0xCE)
+                  xABSOLUTE();
+                  xDEC();
+                  NEXT_OPCODE;
+               OPCODE(0xCF)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+
+                  //
+                  // 0xD0
+                  //
+               OPCODE(0xD0)
+                  // RELATIVE (IN FUNCTION)
+                  xBNE();
+                  NEXT_OPCODE;
+               OPCODE(0xD1)
+                  xINDIRECT_Y();
+                  xCMP();
+                  NEXT_OPCODE;
+               OPCODE(0xD2)
+                  xINDIRECT();
+                  xCMP();
+                  NEXT_OPCODE;
+               OPCODE(0xD3)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+               OPCODE(0xD4)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+               OPCODE(0xD5)
+                  xZEROPAGE_X();
+                  xCMP();
+                  NEXT_OPCODE;
+               OPCODE(0xD6)
+                  xZEROPAGE_X();
+                  xDEC();
+                  NEXT_OPCODE;
+               OPCODE(0xD7)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+
+               OPCODE(0xD8)
+                  // IMPLIED
+                  xCLD();
+                  NEXT_OPCODE;
+               OPCODE(0xD9)
+                  xABSOLUTE_Y();
+                  xCMP();
+                  NEXT_OPCODE;
+               OPCODE(0xDA)
+                  // IMPLIED
+                  xPHX();
+                  NEXT_OPCODE;
+               OPCODE(0xDB)
+                  // IMPLIED
+                  xSTP();
+                  NEXT_OPCODE;
+               OPCODE(0xDC)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+               OPCODE(0xDD)
+                  xABSOLUTE_X();
+                  xCMP();
+                  NEXT_OPCODE;
+               OPCODE(0xDE)
+                  xABSOLUTE_X();
+                  xDEC();
+                  NEXT_OPCODE;
+               OPCODE(0xDF)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+
+                  //
+                  // 0xE0
+                  //
+               OPCODE(0xE0)
+                  xIMMEDIATE();
+                  xCPX();
+                  NEXT_OPCODE;
+               OPCODE(0xE1)
+                  xINDIRECT_X();
+                  xSBC();
+                  NEXT_OPCODE;
+               OPCODE(0xE2)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+               OPCODE(0xE3)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+               OPCODE(0xE4)
+                  xZEROPAGE();
+                  xCPX();
+                  NEXT_OPCODE;
+               OPCODE(0xE5)
+                  xZEROPAGE();
+                  xSBC();
+                  NEXT_OPCODE;
+               OPCODE(0xE6)
+                  xZEROPAGE();
+                  xINC();
+                  NEXT_OPCODE;
+               OPCODE(0xE7)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+
+               OPCODE(0xE8)
+                  // IMPLIED
+                  xINX();
+                  NEXT_OPCODE;
+               OPCODE(0xE9)
+                  xIMMEDIATE();
+                  xSBC();
+                  NEXT_OPCODE;
+               OPCODE(0xEA)
+                  // IMPLIED
+                  xNOP();
+                  NEXT_OPCODE;
+               OPCODE(0xEB)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+               OPCODE(0xEC)
+                  xABSOLUTE();
+                  xCPX();
+                  NEXT_OPCODE;
+               OPCODE(0xED)
+                  xABSOLUTE();
+                  xSBC();
+                  NEXT_OPCODE;
+               OPCODE(0xEE)
+                  xABSOLUTE();
+                  xINC();
+                  NEXT_OPCODE;
+               OPCODE(0xEF)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+
+                  //
+                  // 0xF0
+                  //
+               OPCODE(0xF0)
+                  // RELATIVE (IN FUNCTION)
+                  xBEQ();
+                  NEXT_OPCODE;
+               OPCODE(0xF1)
+                  xINDIRECT_Y();
+                  xSBC();
+                  NEXT_OPCODE;
+               OPCODE(0xF2)
+                  xINDIRECT();
+                  xSBC();
+                  NEXT_OPCODE;
+               OPCODE(0xF3)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+               OPCODE(0xF4)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+               OPCODE(0xF5)
+                  xZEROPAGE_X();
+                  xSBC();
+                  NEXT_OPCODE;
+               OPCODE(0xF6)
+                  xZEROPAGE_X();
+                  xINC();
+                  NEXT_OPCODE;
+               OPCODE(0xF7)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+
+               OPCODE(0xF8)
+                  // IMPLIED
+                  xSED();
+                  NEXT_OPCODE;
+               OPCODE(0xF9)
+                  xABSOLUTE_Y();
+                  xSBC();
+                  NEXT_OPCODE;
+               OPCODE(0xFA)
+                  // IMPLIED
+                  xPLX();
+                  NEXT_OPCODE;
+               OPCODE(0xFB)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+               OPCODE(0xFC)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+               OPCODE(0xFD)
+                  xABSOLUTE_X();
+                  xSBC();
+                  NEXT_OPCODE;
+               OPCODE(0xFE)
+                  xABSOLUTE_X();
+                  xINC();
+                  NEXT_OPCODE;
+               OPCODE(0xFF)
+                  // *** ILLEGAL ***
+                  xILLEGAL();
+                  NEXT_OPCODE;
+            }
+         } while(RUN_CONTINUES);
+      }
+
+#undef CPU_PEEK
+#undef CPU_PEEKW
+#undef CPU_POKE
+#define CPU_PEEK(m)				CPU_READ(m)
+#define CPU_PEEKW(m)			CPU_READW(m)
+#define CPU_POKE(m1,m2)			CPU_WRITE(m1,m2)
+
+      // Run() with the debugger armed: one instruction at a time, checking
+      // the breakpoints in between
+      void C65C02::DebugRun(ULONG until)
+      {
+         do {
+            if(!(mSystem.mSystemIRQ && !mI) && !mSystem.mSystemCPUSleep) {
+               if(DebugBreakpoint()) return;
+            }
+            mDebugResumePC=-1;
+
+            Execute<false,false,true>(mSystem.mSystemCycleCount);
+
+            if(mSystem.mCycleCountBreakpoint!=0xffffffff &&
+               mSystem.mSystemCycleCount>=mSystem.mCycleCountBreakpoint) {
+               ULONG cycle=mSystem.mCycleCountBreakpoint;
+               mSystem.ClearCycleBreakpoint();
+               DebugHit(CPU_BREAK_CYCLE,cycle);
+            }
+            if(mSystem.mSingleStepMode) DebugHit(CPU_BREAK_STEP,mPC);
+         } while(RUN_CONTINUES && !mSystem.GetBreakpointHit() && mDebugArmed);
+      }
+
+      // True when a breakpoint at the PC stopped the CPU. Carrying on from
+      // there runs the instruction instead of stopping again.
+      bool C65C02::DebugBreakpoint(void)
+      {
+         if(mPC==mDebugResumePC) return FALSE;
+         for(int i=0;i<mBreakpoints;i++) {
+            if(mBreakpoint[i]==(ULONG)mPC) DebugHit(CPU_BREAK_PC,mPC);
          }
+         if(!mSystem.GetBreakpointHit()) return FALSE;
+         mDebugResumePC=mPC;
+         return TRUE;
       }
 
+      void C65C02::DebugHit(int kind, ULONG addr)
+      {
+         if(!mDebugCallback || mDebugCallback(mDebugCallbackContext,kind,addr)) {
+            mSystem.SetBreakpointHit(TRUE);
+         }
+      }
+
+      void C65C02::DebugWatch(ULONG addr, int access)
+      {
+         for(int i=0;i<mWatchpoints;i++) {
+            if(mWatchpoint[i]==addr && (mWatchpointAccess[i]&access)) {
+               DebugHit((access==CPU_WATCH_READ)?CPU_BREAK_READ:CPU_BREAK_WRITE,addr);
+            }
+         }
+      }
+
+      void C65C02::DebugArm(void)
+      {
+         mDebugArmed=mBreakpoints || mWatchpoints ||
+                     mSystem.mCycleCountBreakpoint!=0xffffffff || mSystem.mSingleStepMode;
+      }
+
+      bool C65C02::SetBreakpoint(ULONG addr)
+      {
+         for(int i=0;i<mBreakpoints;i++) {
+            if(mBreakpoint[i]==addr) return TRUE;
+         }
+         if(mBreakpoints==MAX_CPU_BREAKPOINTS) return FALSE;
+         mBreakpoint[mBreakpoints++]=addr;
+         DebugArm();
+         return TRUE;
+      }
+
+      void C65C02::ClearBreakpoint(ULONG addr)
+      {
+         for(int i=0;i<mBreakpoints;i++) {
+            if(mBreakpoint[i]==addr) mBreakpoint[i--]=mBreakpoint[--mBreakpoints];
+         }
+         DebugArm();
+      }
+
+      bool C65C02::SetWatchpoint(ULONG addr, int access)
+      {
+         for(int i=0;i<mWatchpoints;i++) {
+            if(mWatchpoint[i]==addr) {
+               mWatchpointAccess[i]=access;
+               return TRUE;
+            }
+         }
+         if(mWatchpoints==MAX_CPU_WATCHPOINTS) return FALSE;
+         mWatchpoint[mWatchpoints]=addr;
+         mWatchpointAccess[mWatchpoints]=access;
+         mWatchpoints++;
+         DebugArm();
+         return TRUE;
+      }
+
+      void C65C02::ClearWatchpoint(ULONG addr)
+      {
+         for(int i=0;i<mWatchpoints;i++) {
+            if(mWatchpoint[i]==addr) {
+               mWatchpoints--;
+               mWatchpoint[i]=mWatchpoint[mWatchpoints];
+               mWatchpointAccess[i]=mWatchpointAccess[mWatchpoints];
+               i--;
+            }
+         }
+         DebugArm();
+      }
+
+      // Runs translated blocks where the JIT has one, and where running one
+      // can't go past the point where the interpreter would have stopped:
+      // the blocks don't do I/O, so the only thing that can stop Run() in
+      // the middle of one is the cycle count. Everything else goes to the
+      // interpreter one instruction at a time.
+      template<bool threaded>
+      void C65C02::ExecuteJit(ULONG until)
+      {
+         do {
+            JitBlock *block=NULL;
+            if(!(mSystem.mSystemIRQ && !mI) && !mSystem.mSystemCPUSleep) {
+               block=mJit->Lookup(mPC);
+            }
+            if(!block) {
+               Execute<threaded,false>(mSystem.mSystemCycleCount);
+               continue;
+            }
+
+            ULONG cycles=mSystem.mSystemCycleCount;
+            ULONG last=cycles+block->lead_cycles;
+            if(last<cycles || (int32_t)(last-until)>=0 || last>=mSystem.mNextTimerEvent) {
+               // Run() ends inside this block
+               Execute<threaded,false>(until);
+               return;
+            }
+
+            uint64_t result=block->code(this,mRamPointer,mCodeMap);
+            mSystem.mSystemCycleCount+=JIT_CYCLES(result);
+            PROFILE_BLOCK(block->start,JIT_CYCLES(result));
+            if(result&JIT_INTERPRET_NEXT) {
+               Execute<threaded,false>(mSystem.mSystemCycleCount);
+            } else if(JIT_WRITTEN(result)>=0) {
+               // Pushes only say which page they wrote to
+               PredecodeFlush(JIT_WRITTEN(result)>>8);
+               SpritePageWritten(JIT_WRITTEN(result)>>8);
+               mJit->Invalidate(JIT_WRITTEN(result));
+            } else if(mPC==block->loop_start && mIdleLoopSkip) {
+               IdleLoop(block->loop_start,block->loop_end);
+            }
+
+            if(mJitBlockHook) mJitBlockHook(mJitBlockHookContext);
+         } while(RUN_CONTINUES);
+      }
+
+      void C65C02::SetJit(bool jit)
+      {
+         if(jit==(mJit!=NULL)) return;
+         delete mJit;
+         mJit=NULL;
+#if HANDY_JIT
+         if(jit) {
+            mJit=new C65C02Jit(*this);
+            if(!mJit->IsUsable()) {
+               delete mJit;
+               mJit=NULL;
+            }
+         }
+#endif
+      }
+
+      void C65C02::FlushCode(void)
+      {
+         if(mJit) mJit->Flush();
+         for(int page=0;page<0xfc;page++) PredecodeFlush(page);
+         for(int page=0;page<0x100;page++) SpritePageWritten(page);
+      }
+
+      void C65C02::CodeWritten(ULONG addr)
+      {
+         if(mCodeMap[addr]&CODE_MAP_PREDECODED) PredecodeFlush(addr>>8);
+         if(mJit && (mCodeMap[addr]&CODE_MAP_JIT)) mJit->Invalidate(addr);
+         if(mCodeMap[addr]&CODE_MAP_SPRITE) SpritePageWritten(addr>>8);
+      }
+
+      void C65C02::MarkSpriteData(ULONG start, ULONG end)
+      {
+         for(ULONG addr=start;addr<end;addr++) mCodeMap[addr]|=CODE_MAP_SPRITE;
+      }
+
+      // Everything decoded from the page is stale now. Its other bytes
+      // don't need to be watched until something is decoded from it again.
+      void C65C02::SpritePageWritten(int page)
+      {
+         mPageGeneration[page]++;
+         for(int addr=page<<8;addr<(page+1)<<8;addr++) mCodeMap[addr]&=~CODE_MAP_SPRITE;
+      }
+
+      // Instruction lengths as the handlers see them, the opcodes Handy
+      // takes as illegal are all a single byte
+      static constexpr UBYTE opcode_length[256] = {
+         /* 0x00 */ 1, 2, 1, 1, 2, 2, 2, 1, 1, 2, 1, 1, 3, 3, 3, 1,
+         /* 0x10 */ 2, 2, 2, 1, 2, 2, 2, 1, 1, 3, 1, 1, 3, 3, 3, 1,
+         /* 0x20 */ 3, 2, 1, 1, 2, 2, 2, 1, 1, 2, 1, 1, 3, 3, 3, 1,
+         /* 0x30 */ 2, 2, 2, 1, 2, 2, 2, 1, 1, 3, 1, 1, 3, 3, 3, 1,
+         /* 0x40 */ 1, 2, 1, 1, 1, 2, 2, 1, 1, 2, 1, 1, 3, 3, 3, 1,
+         /* 0x50 */ 2, 2, 2, 1, 1, 2, 2, 1, 1, 3, 1, 1, 1, 3, 3, 1,
+         /* 0x60 */ 1, 2, 1, 1, 2, 2, 2, 1, 1, 2, 1, 1, 3, 3, 3, 1,
+         /* 0x70 */ 2, 2, 2, 1, 2, 2, 2, 1, 1, 3, 1, 1, 3, 3, 3, 1,
+         /* 0x80 */ 2, 2, 1, 1, 2, 2, 2, 1, 1, 2, 1, 1, 3, 3, 3, 1,
+         /* 0x90 */ 2, 2, 2, 1, 2, 2, 2, 1, 1, 3, 1, 1, 3, 3, 3, 1,
+         /* 0xA0 */ 2, 2, 2, 1, 2, 2, 2, 1, 1, 2, 1, 1, 3, 3, 3, 1,
+         /* 0xB0 */ 2, 2, 2, 1, 2, 2, 2, 1, 1, 3, 1, 1, 3, 3, 3, 1,
+         /* 0xC0 */ 2, 2, 1, 1, 2, 2, 2, 1, 1, 2, 1, 1, 3, 3, 3, 1,
+         /* 0xD0 */ 2, 2, 2, 1, 1, 2, 2, 1, 1, 3, 1, 1, 1, 3, 3, 1,
+         /* 0xE0 */ 2, 2, 1, 1, 2, 2, 2, 1, 1, 2, 1, 1, 3, 3, 3, 1,
+         /* 0xF0 */ 2, 2, 2, 1, 1, 2, 2, 1, 1, 3, 1, 1, 1, 3, 3, 1
+      };
+
+      void C65C02::SetPredecode(bool predecode)
+      {
+         mPredecode=predecode;
+         for(int page=0;page<0xfc;page++) PredecodeFlush(page);
+      }
+
+      const C65C02Predecoded& C65C02::PredecodeMiss(ULONG pc)
+      {
+         mPredecodeMisses++;
+
+         C65C02Predecoded insn;
+         ULONG next=pc+1;
+         insn.opcode=CPU_PEEK(pc);
+         insn.length=opcode_length[insn.opcode];
+         insn.operand=0;
+         if(insn.length==2) insn.operand=CPU_PEEK(next);
+         if(insn.length==3) insn.operand=CPU_PEEKW(next);
+
+         // Only instructions wholly inside a page of RAM are kept, the
+         // rest are decoded every time
+         if(pc>=0xfc00 || (pc&0xff)+insn.length>0x100) {
+            mPredecodeUncached=insn;
+            return mPredecodeUncached;
+         }
+
+         C65C02Predecoded *&page=mPredecodePage[pc>>8];
+         if(!page) page=new C65C02Predecoded[0x100]();
+         page[pc&0xff]=insn;
+         for(int addr=pc;addr<(int)pc+insn.length;addr++) mCodeMap[addr]|=CODE_MAP_PREDECODED;
+         return page[pc&0xff];
+      }
+
+      void C65C02::PredecodeFlush(int page)
+      {
+         if(!mPredecodePage[page]) return;
+         memset(mPredecodePage[page],0,0x100*sizeof(C65C02Predecoded));
+         for(int addr=page<<8;addr<(page+1)<<8;addr++) mCodeMap[addr]&=~CODE_MAP_PREDECODED;
+      }
+
+#if HANDY_CPU_PROFILE
+      static const char *const profile_mnemonics[256] = {
+         "BRK", "ORA (zp,X)", "???", "???", "TSB zp", "ORA zp", "ASL zp", "???",
+         "PHP", "ORA #", "ASL A", "???", "TSB abs", "ORA abs", "ASL abs", "???",
+         "BPL", "ORA (zp),Y", "ORA (zp)", "???", "TRB zp", "ORA zp,X", "ASL zp,X", "???",
+         "CLC", "ORA abs,Y", "INC A", "???", "TRB abs", "ORA abs,X", "ASL abs,X", "???",
+         "JSR abs", "AND (zp,X)", "???", "???", "BIT zp", "AND zp", "ROL zp", "???",
+         "PLP", "AND #", "ROL A", "???", "BIT abs", "AND abs", "ROL abs", "???",
+         "BMI", "AND (zp),Y", "AND (zp)", "???", "BIT zp,X", "AND zp,X", "ROL zp,X", "???",
+         "SEC", "AND abs,Y", "DEC A", "???", "BIT abs,X", "AND abs,X", "ROL abs,X", "???",
+         "RTI", "EOR (zp,X)", "???", "???", "???", "EOR zp", "LSR zp", "???",
+         "PHA", "EOR #", "LSR A", "???", "JMP abs", "EOR abs", "LSR abs", "???",
+         "BVC", "EOR (zp),Y", "EOR (zp)", "???", "???", "EOR zp,X", "LSR zp,X", "???",
+         "CLI", "EOR abs,Y", "PHY", "???", "???", "EOR abs,X", "LSR abs,X", "???",
+         "RTS", "ADC (zp,X)", "???", "???", "STZ zp", "ADC zp", "ROR zp", "???",
+         "PLA", "ADC #", "ROR A", "???", "JMP (abs)", "ADC abs", "ROR abs", "???",
+         "BVS", "ADC (zp),Y", "ADC (zp)", "???", "STZ zp,X", "ADC zp,X", "ROR zp,X", "???",
+         "SEI", "ADC abs,Y", "PLY", "???", "JMP (abs,X)", "ADC abs,X", "ROR abs,X", "???",
+         "BRA", "STA (zp,X)", "???", "???", "STY zp", "STA zp", "STX zp", "???",
+         "DEY", "BIT #", "TXA", "???", "STY abs", "STA abs", "STX abs", "???",
+         "BCC", "STA (zp),Y", "STA (zp)", "???", "STY zp,X", "STA zp,X", "STX zp,Y", "???",
+         "TYA", "STA abs,Y", "TXS", "???", "STZ abs", "STA abs,X", "STZ abs,X", "???",
+         "LDY #", "LDA (zp,X)", "LDX #", "???", "LDY zp", "LDA zp", "LDX zp", "???",
+         "TAY", "LDA #", "TAX", "???", "LDY abs", "LDA abs", "LDX abs", "???",
+         "BCS", "LDA (zp),Y", "LDA (zp)", "???", "LDY zp,X", "LDA zp,X", "LDX zp,Y", "???",
+         "CLV", "LDA abs,Y", "TSX", "???", "LDY abs,X", "LDA abs,X", "LDX abs,Y", "???",
+         "CPY #", "CMP (zp,X)", "???", "???", "CPY zp", "CMP zp", "DEC zp", "???",
+         "INY", "CMP #", "DEX", "WAI", "CPY abs", "CMP abs", "DEC abs", "???",
+         "BNE", "CMP (zp),Y", "CMP (zp)", "???", "???", "CMP zp,X", "DEC zp,X", "???",
+         "CLD", "CMP abs,Y", "PHX", "STP", "???", "CMP abs,X", "DEC abs,X", "???",
+         "CPX #", "SBC (zp,X)", "???", "???", "CPX zp", "SBC zp", "INC zp", "???",
+         "INX", "SBC #", "NOP", "???", "CPX abs", "SBC abs", "INC abs", "???",
+         "BEQ", "SBC (zp),Y", "SBC (zp)", "???", "???", "SBC zp,X", "INC zp,X", "???",
+         "SED", "SBC abs,Y", "PLX", "???", "???", "SBC abs,X", "INC abs,X", "???"
+      };
+
+      static void ProfilePrint(RFILE *fe, const char *format, ...)
+      {
+         char line[256];
+         va_list ap;
+         va_start(ap,format);
+         vsnprintf(line,sizeof(line),format,ap);
+         va_end(ap);
+         if(fe) filestream_printf(fe,"%s",line);
+         else handy_log(RETRO_LOG_INFO,"%s",line);
+      }
+
+      void C65C02::ProfileReport(RFILE *fe)
+      {
+         uint64_t total=0;
+         for(int page=0;page<256;page++) total+=mProfile.page_cycles[page];
+         if(!total) return;
+
+         // Only the top few go to the log
+         int shown=fe?256:8;
+
+         ProfilePrint(fe,"65C02 profile: %llu cycles running code, %.1f%% translated, %.1f%% idle loops skipped\n",
+               (unsigned long long)total,100.0*mProfile.jit_cycles/total,100.0*mIdleLoopCyclesSkipped/total);
+         ProfilePrint(fe,"%llu IRQs, %.1f%% of the cycles in IRQ handlers\n",
+               (unsigned long long)mProfile.irqs,100.0*mProfile.irq_cycles/total);
+
+         int order[256];
+         for(int i=0;i<256;i++) order[i]=i;
+         std::stable_sort(order,order+256,[this](int a, int b) {
+            return mProfile.opcodes[a]*OpcodeCycles(a)>mProfile.opcodes[b]*OpcodeCycles(b);
+         });
+         ProfilePrint(fe,"opcode              count       cycles\n");
+         for(int i=0;i<shown && mProfile.opcodes[order[i]];i++) {
+            int op=order[i];
+            uint64_t cycles=mProfile.opcodes[op]*OpcodeCycles(op);
+            ProfilePrint(fe,"  %02X %-12s %12llu %12llu %5.1f%%\n",op,profile_mnemonics[op],
+                  (unsigned long long)mProfile.opcodes[op],(unsigned long long)cycles,100.0*cycles/total);
+         }
+
+         for(int i=0;i<256;i++) order[i]=i;
+         std::stable_sort(order,order+256,[this](int a, int b) {
+            return mProfile.page_cycles[a]>mProfile.page_cycles[b];
+         });
+         ProfilePrint(fe,"page                            cycles\n");
+         for(int i=0;i<shown && mProfile.page_cycles[order[i]];i++) {
+            int page=order[i];
+            ProfilePrint(fe,"  $%02Xxx                   %12llu %5.1f%%\n",page,
+                  (unsigned long long)mProfile.page_cycles[page],100.0*mProfile.page_cycles[page]/total);
+         }
+      }
+#endif
+
+#undef NEXT_OPCODE
+#undef FETCH_OPCODE
+#undef PROFILE_OPCODE
+#undef PROFILE_CYCLES
+#undef PROFILE_BLOCK
+#undef PROFILE_IRQ
+#undef PROFILE_RTI
+#undef OPCODE
+#undef RUN_CONTINUES
+#undef OPCODE_CYCLES
+
       //		inline void SetBreakpoint(ULONG breakpoint) {mPcBreakpoint=breakpoint;};
 
       void C65C02::SetRegs(C6502_REGS &regs)
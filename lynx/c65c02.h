@@ -57,6 +57,37 @@
 #define IRQ_VECTOR	0xfffe
 
 #define MAX_CPU_BREAKPOINTS	8
+#define MAX_CPU_WATCHPOINTS	8
+
+// What a watchpoint watches
+#define CPU_WATCH_READ		0x01
+#define CPU_WATCH_WRITE		0x02
+
+// What the debugger stopped for, see C65C02::SetDebugCallback()
+enum
+{
+   CPU_BREAK_PC=0,		// About to run the instruction at the breakpoint
+   CPU_BREAK_READ,		// The last instruction read a watched address
+   CPU_BREAK_WRITE,		// ...or wrote to one
+   CPU_BREAK_CYCLE,		// The cycle breakpoint was reached
+   CPU_BREAK_STEP		// Single step mode, after every instruction
+};
+
+// Threaded opcode dispatch needs the "labels as values" extension of GCC
+// and Clang, everyone else only gets the switch. Define
+// HANDY_NO_THREADED_DISPATCH to leave it out anyway.
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(HANDY_NO_THREADED_DISPATCH)
+#define HANDY_THREADED_DISPATCH 1
+#else
+#define HANDY_THREADED_DISPATCH 0
+#endif
+
+// HANDY_CPU_PROFILE=1 builds in a profiler counting what the CPU spends
+// its cycles on, see C65C02Profile. It costs an increment and an add per
+// instruction, without it there's nothing of it left.
+#ifndef HANDY_CPU_PROFILE
+#define HANDY_CPU_PROFILE 0
+#endif
 
 //
 // ACCESS MACROS
@@ -66,9 +97,24 @@
 //#define CPU_PEEKW(m)			(mSystem.PeekW_CPU(m))
 //#define CPU_POKE(m1,m2)			(mSystem.Poke_CPU(m1,m2))
 
-#define CPU_PEEK(m)				(((m<0xfc00)?mRamPointer[m]:mSystem.Peek_CPU(m)))
-#define CPU_PEEKW(m)			(((m<0xfc00)?(mRamPointer[m]+(mRamPointer[m+1]<<8)):mSystem.PeekW_CPU(m)))
-#define CPU_POKE(m1,m2)			{if(m1<0xfc00) mRamPointer[m1]=m2; else mSystem.Poke_CPU(m1,m2);}
+#define CPU_READ(m)				(((m<0xfc00)?mRamPointer[m]:mSystem.Peek_CPU(m)))
+#define CPU_READW(m)			(((m<0xfc00)?(mRamPointer[m]+(mRamPointer[m+1]<<8)):mSystem.PeekW_CPU(m)))
+#define CPU_WRITE(m1,m2)		{if(m1<0xfc00) { mRamPointer[m1]=m2; if(mCodeMap[m1]) CodeWritten(m1); } else mSystem.Poke_CPU(m1,m2);}
+
+// The debugger's Execute() swaps these for ones that check the watchpoints
+#define CPU_PEEK(m)				CPU_READ(m)
+#define CPU_PEEKW(m)			CPU_READW(m)
+#define CPU_POKE(m1,m2)			CPU_WRITE(m1,m2)
+
+// The operand bytes of the instruction being run. With the predecode cache
+// they were fetched along with the opcode, see C65C02::Predecode().
+#define CPU_FETCH()				(predecode?(fetched&0xff):CPU_READ(mPC))
+#define CPU_FETCHW()			(predecode?fetched:CPU_READW(mPC))
+
+// What mCodeMap says about a RAM byte
+#define CODE_MAP_JIT			0x01	// C65C02Jit translated it
+#define CODE_MAP_PREDECODED		0x02	// It's in the predecode cache
+#define CODE_MAP_SPRITE			0x04	// CSusie cached a sprite line decoded from it
 
 
 enum
@@ -92,6 +138,26 @@ enum
    ind
 };
 
+// What the profiler counted since the CPU was made
+struct C65C02Profile
+{
+   uint64_t opcodes[256];		// Times the interpreter ran each opcode
+   uint64_t page_cycles[256];	// Cycles spent on code in each page
+   uint64_t jit_cycles;			// ...of them in translated blocks
+   uint64_t irqs;				// IRQs taken
+   uint64_t irq_cycles;			// Cycles from taking an IRQ to its RTI
+};
+
+struct RFILE;
+
+// An instruction in the predecode cache
+struct C65C02Predecoded
+{
+   UBYTE opcode;
+   UBYTE length;	// 0 for an empty entry
+   UWORD operand;	// The one or two bytes after the opcode
+};
+
 struct C6502_REGS
 {
    int PS;		// Processor status register   8 bits
@@ -111,18 +177,19 @@ struct C6502_REGS
 // The CPU emulation macros
 //
 #include "c6502mak.h"
+#include "c65c02jit.h"
 //
 // The CPU emulation macros
 //
 
 class C65C02
 {
+   friend class C65C02Jit;
+
    public:
       C65C02(CSystem& parent);
 
-      ~C65C02()
-      {
-      }
+      ~C65C02();
 
    public:
       void Reset(void);
@@ -156,11 +223,96 @@ class C65C02
          if(!lss_read(&mPC,sizeof(ULONG),1,fp)) return 0;
          if(!lss_read(&mIRQActive,sizeof(ULONG),1,fp)) return 0;
          PS(mPS);
+         FlushCode();
+         DebugArm();
+#if HANDY_CPU_PROFILE
+         mProfileIrqDepth=0;
+#endif
          return 1;
       }
 
       void Update(void);
 
+      // Runs instructions until the cycle count reaches 'until', the next
+      // timer event is due or the CPU goes to sleep, whichever comes first.
+      // At least one instruction is run (or an IRQ taken), so Update() is
+      // just Run() with nothing more to do.
+      void Run(ULONG until);
+
+      // Picks how Run() gets from one opcode to the next, both ways give
+      // exactly the same results. Threaded dispatch is the default when
+      // it's available.
+      inline void SetThreadedDispatch(bool threaded) { mThreadedDispatch=threaded && HANDY_THREADED_DISPATCH; }
+      inline bool GetThreadedDispatch(void) { return mThreadedDispatch; }
+
+      // Lets Run() skip over loops that can't get anywhere before the next
+      // timer event, like a game polling a RAM flag its VBL interrupt sets.
+      // See IdleLoop() for what counts as one. Off by default.
+      inline void SetIdleLoopSkip(bool skip) { mIdleLoopSkip=skip; }
+      inline bool GetIdleLoopSkip(void) { return mIdleLoopSkip; }
+      inline uint64_t GetIdleLoopCyclesSkipped(void) { return mIdleLoopCyclesSkipped; }
+
+      // Runs translated blocks of code instead of interpreting where it
+      // can, see C65C02Jit. Off by default, and only there on x86-64.
+      void SetJit(bool jit);
+      inline bool GetJit(void) { return mJit!=NULL; }
+      inline C65C02Jit* GetJitEngine(void) { return mJit; }
+
+      // Gets called after every translated block, so a test can check the
+      // CPU against an interpreted one
+      inline void SetJitBlockHook(void (*hook)(void *context), void *context) { mJitBlockHook=hook; mJitBlockHookContext=context; }
+
+#if HANDY_CPU_PROFILE
+      inline const C65C02Profile& GetProfile(void) { return mProfile; }
+
+      // Writes the profile to 'fe', or only the busiest opcodes and pages
+      // to the log when that's NULL
+      void ProfileReport(RFILE *fe);
+#endif
+
+      // The debugger. PC breakpoints stop before the instruction runs,
+      // watchpoints after the instruction that read or wrote the address.
+      // The cycle breakpoint and single step mode are CSystem's, set with
+      // its SetCycleBreakpoint() and SetSingleStepMode(). With anything set
+      // Run() takes a slower path one instruction at a time, without the
+      // JIT or idle loop skipping; with nothing set it costs one test per
+      // Run().
+      bool SetBreakpoint(ULONG addr);
+      void ClearBreakpoint(ULONG addr);
+      bool SetWatchpoint(ULONG addr, int access);
+      void ClearWatchpoint(ULONG addr);
+      void DebugArm(void);
+      inline bool GetDebugArmed(void) { return mDebugArmed; }
+
+      // Gets every hit, with its CPU_BREAK_ kind and the address (or for
+      // CPU_BREAK_CYCLE the cycle). Returning TRUE stops the CPU and sets
+      // CSystem's breakpoint hit flag, which keeps RunUntil() from going
+      // any further until it's cleared. Without a callback every hit stops.
+      // With several consoles on worker threads it's called on theirs.
+      inline void SetDebugCallback(bool (*callback)(void *context, int kind, ULONG addr), void *context) { mDebugCallback=callback; mDebugCallbackContext=context; }
+
+      // Keeps every instruction Run() comes across in a per page cache,
+      // decoded along with its operand, so running it again doesn't have
+      // to fetch it byte by byte. Off by default.
+      void SetPredecode(bool predecode);
+      inline bool GetPredecode(void) { return mPredecode; }
+      inline uint64_t GetPredecodeHits(void) { return mPredecodeHits; }
+      inline uint64_t GetPredecodeMisses(void) { return mPredecodeMisses; }
+
+      // Anything writing RAM behind the CPU's back has to tell it, in case
+      // that was code it translated or predecoded
+      inline void RamWritten(ULONG addr) { if(mCodeMap[addr]) CodeWritten(addr); }
+
+      // Forgets all translated and predecoded code, for when RAM was
+      // reloaded as a whole
+      void FlushCode(void);
+
+      // A page's generation goes up whenever RAM marked as sprite data
+      // in it is written, which is how CSusie knows whether the sprite
+      // lines it decoded from there are still good
+      void MarkSpriteData(ULONG start, ULONG end);
+      inline ULONG GetPageGeneration(ULONG page) { return mPageGeneration[page]; }
+
       void SetRegs(C6502_REGS &regs);
 
       void GetRegs(C6502_REGS &regs);
@@ -187,18 +339,68 @@ class C65C02
       int mOperand; // Intructions operand		  16 bits
       int mPC;		// Program Counter            16 bits
 
-      int mN;		// N flag for processor status register
+      // N and Z aren't worked out until something asks for them. Most
+      // instructions just leave their result byte here: N is bit 7 and Z
+      // is set when it's 0. Bit 8 holds N when the two have to be set on
+      // their own (BIT, TRB, TSB and PLP/RTI), so N and Z can both be set.
+      int mNZ;
       int mV;		// V flag for processor status register
       int mB;		// B flag for processor status register
       int mD;		// D flag for processor status register
       int mI;		// I flag for processor status register
-      int mZ;		// Z flag for processor status register
       int mC;		// C flag for processor status register
 
       int mIRQActive;
 
+      bool mThreadedDispatch;
+
+      // The loop IdleLoop() last looked at, and what the CPU looked like
+      // when it last came around it
+      struct IdleLoopState
+      {
+         int A,X,Y,SP,NZ,V,B,D,I,C,Operand;
+      };
+      bool mIdleLoopSkip;
+      int mIdleLoopStart;
+      int mIdleLoopEnd;
+      bool mIdleLoopPure;
+      ULONG mIdleLoopCycle;
+      ULONG mIdleLoopUntil;
+      IdleLoopState mIdleLoopState;
+      uint64_t mIdleLoopCyclesSkipped;
+
       UBYTE *mRamPointer;
 
+      C65C02Jit *mJit;
+      void (*mJitBlockHook)(void *context);
+      void *mJitBlockHookContext;
+
+      bool mPredecode;
+      C65C02Predecoded *mPredecodePage[0xfc];
+      C65C02Predecoded mPredecodeUncached;
+      uint64_t mPredecodeHits;
+      uint64_t mPredecodeMisses;
+
+      // CODE_MAP_ bits for every byte of RAM
+      UBYTE mCodeMap[0x10000];
+      ULONG mPageGeneration[0x100];
+
+      bool mDebugArmed;
+      int mBreakpoints;
+      ULONG mBreakpoint[MAX_CPU_BREAKPOINTS];
+      int mWatchpoints;
+      ULONG mWatchpoint[MAX_CPU_WATCHPOINTS];
+      int mWatchpointAccess[MAX_CPU_WATCHPOINTS];
+      int mDebugResumePC;
+      bool (*mDebugCallback)(void *context, int kind, ULONG addr);
+      void *mDebugCallbackContext;
+
+#if HANDY_CPU_PROFILE
+      C65C02Profile mProfile;
+      int mProfileIrqDepth;
+      ULONG mProfileIrqEntry;
+#endif
+
       // Associated lookup tables
 
       int mBCDTable[2][256];
@@ -209,16 +411,48 @@ class C65C02
 
    private:
 
+      template<bool threaded, bool predecode, bool debug=false> void Execute(ULONG until);
+      void DebugRun(ULONG until);
+      bool DebugBreakpoint(void);
+      void DebugHit(int kind, ULONG addr);
+      void DebugWatch(ULONG addr, int access);
+      UBYTE DebugPeek(ULONG addr);
+      UWORD DebugPeekW(ULONG addr);
+      void DebugPoke(ULONG addr, UBYTE data);
+      template<bool threaded> void ExecuteJit(ULONG until);
+      void CodeWritten(ULONG addr);
+
+      // The instruction at 'pc', from the predecode cache if it's there
+      inline const C65C02Predecoded& Predecode(ULONG pc)
+      {
+         if(pc<0xfc00) {
+            C65C02Predecoded *page=mPredecodePage[pc>>8];
+            if(page && page[pc&0xff].length) {
+               mPredecodeHits++;
+               return page[pc&0xff];
+            }
+         }
+         return PredecodeMiss(pc);
+      }
+      const C65C02Predecoded& PredecodeMiss(ULONG pc);
+      void PredecodeFlush(int page);
+      void SpritePageWritten(int page);
+      static ULONG OpcodeCycles(int opcode);
+
+      void IdleLoop(int start, int end);
+      bool IdleLoopIsPure(int start, int end);
+      IdleLoopState IdleLoopNow(void) const;
+
       // Answers value of the Processor Status register
       int PS() const
       {
          UBYTE ps = 0x20;
-         if(mN) ps|=0x80;
+         if(FlagN()) ps|=0x80;
          if(mV) ps|=0x40;
          if(mB) ps|=0x10;
          if(mD) ps|=0x08;
          if(mI) ps|=0x04;
-         if(mZ) ps|=0x02;
+         if(FlagZ()) ps|=0x02;
          if(mC) ps|=0x01;
          return ps;
       }
@@ -227,15 +461,20 @@ class C65C02
       // Change the processor flags to correspond to the given value
       void PS(int ps)
       {
-         mN=ps&0x80;
+         SetNZ(ps&0x80,ps&0x02);
          mV=ps&0x40;
          mB=ps&0x10;
          mD=ps&0x08;
          mI=ps&0x04;
-         mZ=ps&0x02;
          mC=ps&0x01;
       }
 
+      inline int FlagN() const { return mNZ&0x180; }
+      inline int FlagZ() const { return !(mNZ&0xff); }
+
+      // Sets both flags on their own, rather than from a result
+      inline void SetNZ(int n, int z) { mNZ=(n?0x100:0)|(z?0:1); }
+
 };
 
 
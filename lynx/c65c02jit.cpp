@@ -0,0 +1,933 @@
+//
+// Copyright (c) 2024 superKoder : later improvements for Handy MP.
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not
+//    be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+
+//////////////////////////////////////////////////////////////////////////////
+// 65C02 recompiler                                                         //
+//////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// Every block is a function taking the CPU, the RAM and the code map in    //
+// rdi, rsi and rdx. The 65C02 registers stay in the C65C02 object, which   //
+// keeps the code simple and C65C02 never has to care whether the last      //
+// instruction was translated or interpreted. Each instruction works       //
+// exactly like its macro in c6502mak.h, down to the raw flag values.      //
+//                                                                          //
+//////////////////////////////////////////////////////////////////////////////
+
+#include "c65c02.h"
+#include "c65c02jit.h"
+#include <string.h>
+
+#if HANDY_JIT
+
+#include <sys/mman.h>
+
+// Size limits, a block is never more than JIT_MAX_INSTRUCTIONS long so
+// it never spans more than JIT_MAX_BLOCK_BYTES of 65C02 code
+#define JIT_MAX_INSTRUCTIONS	32
+#define JIT_MAX_BLOCK_BYTES		(JIT_MAX_INSTRUCTIONS*3)
+#define JIT_MAX_BLOCK_CODE		8192
+#define JIT_CODE_SIZE			(4*1024*1024)
+#define JIT_MAX_BLOCKS			32768
+
+enum
+{
+   J_NONE=0,
+   J_LOAD,
+   J_STORE,
+   J_ADC,
+   J_SBC,
+   J_AND,
+   J_ORA,
+   J_EOR,
+   J_CMP,
+   J_BIT,
+   J_INC,
+   J_DEC,
+   J_ASL,
+   J_LSR,
+   J_ROL,
+   J_ROR,
+   J_MOVE,
+   J_FLAG,
+   J_NOP,
+   J_PUSH,
+   J_PULL,
+   J_BRANCH,
+   J_JMP,
+   J_JSR,
+   J_RTS
+};
+
+enum
+{
+   J_IMP=0,
+   J_IMM,
+   J_ZP,
+   J_ZPX,
+   J_ZPY,
+   J_ABS,
+   J_ABSX,
+   J_ABSY,
+   J_INDX,
+   J_INDY,
+   J_IND,
+   J_REL
+};
+
+// C65C02 members the code works on
+enum
+{
+   F_A=0,
+   F_X,
+   F_Y,
+   F_SP,
+   F_PC,
+   F_NZ,
+   F_V,
+   F_D,
+   F_C,
+   F_NONE
+};
+
+struct JitOpcode
+{
+   UBYTE kind;
+   UBYTE mode;
+   UBYTE reg;	// Register read or written, F_NONE for memory (or STZ)
+   UBYTE arg;	// Source of a transfer, value of a flag
+};
+
+// What each opcode does, J_NONE for the ones left to the interpreter:
+// BRK, RTI, JMP (ind), PHP/PLP, SEI/CLI, TSB/TRB, BIT #imm, WAI/STP
+// and the illegal ones
+static const JitOpcode jit_opcodes[256] = {
+         /* 0x00 */ {J_NONE,J_IMP,F_NONE,0}, {J_ORA,J_INDX,F_A,0}, {J_NONE,J_IMP,F_NONE,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0x04 */ {J_NONE,J_IMP,F_NONE,0}, {J_ORA,J_ZP,F_A,0}, {J_ASL,J_ZP,F_NONE,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0x08 */ {J_NONE,J_IMP,F_NONE,0}, {J_ORA,J_IMM,F_A,0}, {J_ASL,J_IMP,F_A,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0x0C */ {J_NONE,J_IMP,F_NONE,0}, {J_ORA,J_ABS,F_A,0}, {J_ASL,J_ABS,F_NONE,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0x10 */ {J_BRANCH,J_REL,F_NONE,0}, {J_ORA,J_INDY,F_A,0}, {J_ORA,J_IND,F_A,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0x14 */ {J_NONE,J_IMP,F_NONE,0}, {J_ORA,J_ZPX,F_A,0}, {J_ASL,J_ZPX,F_NONE,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0x18 */ {J_FLAG,J_IMP,F_C,0}, {J_ORA,J_ABSY,F_A,0}, {J_INC,J_IMP,F_A,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0x1C */ {J_NONE,J_IMP,F_NONE,0}, {J_ORA,J_ABSX,F_A,0}, {J_ASL,J_ABSX,F_NONE,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0x20 */ {J_JSR,J_ABS,F_NONE,0}, {J_AND,J_INDX,F_A,0}, {J_NONE,J_IMP,F_NONE,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0x24 */ {J_BIT,J_ZP,F_A,0}, {J_AND,J_ZP,F_A,0}, {J_ROL,J_ZP,F_NONE,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0x28 */ {J_NONE,J_IMP,F_NONE,0}, {J_AND,J_IMM,F_A,0}, {J_ROL,J_IMP,F_A,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0x2C */ {J_BIT,J_ABS,F_A,0}, {J_AND,J_ABS,F_A,0}, {J_ROL,J_ABS,F_NONE,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0x30 */ {J_BRANCH,J_REL,F_NONE,0}, {J_AND,J_INDY,F_A,0}, {J_AND,J_IND,F_A,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0x34 */ {J_BIT,J_ZPX,F_A,0}, {J_AND,J_ZPX,F_A,0}, {J_ROL,J_ZPX,F_NONE,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0x38 */ {J_FLAG,J_IMP,F_C,1}, {J_AND,J_ABSY,F_A,0}, {J_DEC,J_IMP,F_A,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0x3C */ {J_BIT,J_ABSX,F_A,0}, {J_AND,J_ABSX,F_A,0}, {J_ROL,J_ABSX,F_NONE,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0x40 */ {J_NONE,J_IMP,F_NONE,0}, {J_EOR,J_INDX,F_A,0}, {J_NONE,J_IMP,F_NONE,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0x44 */ {J_NONE,J_IMP,F_NONE,0}, {J_EOR,J_ZP,F_A,0}, {J_LSR,J_ZP,F_NONE,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0x48 */ {J_PUSH,J_IMP,F_A,0}, {J_EOR,J_IMM,F_A,0}, {J_LSR,J_IMP,F_A,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0x4C */ {J_JMP,J_ABS,F_NONE,0}, {J_EOR,J_ABS,F_A,0}, {J_LSR,J_ABS,F_NONE,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0x50 */ {J_BRANCH,J_REL,F_NONE,0}, {J_EOR,J_INDY,F_A,0}, {J_EOR,J_IND,F_A,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0x54 */ {J_NONE,J_IMP,F_NONE,0}, {J_EOR,J_ZPX,F_A,0}, {J_LSR,J_ZPX,F_NONE,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0x58 */ {J_NONE,J_IMP,F_NONE,0}, {J_EOR,J_ABSY,F_A,0}, {J_PUSH,J_IMP,F_Y,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0x5C */ {J_NONE,J_IMP,F_NONE,0}, {J_EOR,J_ABSX,F_A,0}, {J_LSR,J_ABSX,F_NONE,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0x60 */ {J_RTS,J_IMP,F_NONE,0}, {J_ADC,J_INDX,F_A,0}, {J_NONE,J_IMP,F_NONE,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0x64 */ {J_STORE,J_ZP,F_NONE,0}, {J_ADC,J_ZP,F_A,0}, {J_ROR,J_ZP,F_NONE,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0x68 */ {J_PULL,J_IMP,F_A,0}, {J_ADC,J_IMM,F_A,0}, {J_ROR,J_IMP,F_A,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0x6C */ {J_NONE,J_IMP,F_NONE,0}, {J_ADC,J_ABS,F_A,0}, {J_ROR,J_ABS,F_NONE,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0x70 */ {J_BRANCH,J_REL,F_NONE,0}, {J_ADC,J_INDY,F_A,0}, {J_ADC,J_IND,F_A,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0x74 */ {J_STORE,J_ZPX,F_NONE,0}, {J_ADC,J_ZPX,F_A,0}, {J_ROR,J_ZPX,F_NONE,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0x78 */ {J_NONE,J_IMP,F_NONE,0}, {J_ADC,J_ABSY,F_A,0}, {J_PULL,J_IMP,F_Y,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0x7C */ {J_NONE,J_IMP,F_NONE,0}, {J_ADC,J_ABSX,F_A,0}, {J_ROR,J_ABSX,F_NONE,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0x80 */ {J_BRANCH,J_REL,F_NONE,0}, {J_STORE,J_INDX,F_A,0}, {J_NONE,J_IMP,F_NONE,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0x84 */ {J_STORE,J_ZP,F_Y,0}, {J_STORE,J_ZP,F_A,0}, {J_STORE,J_ZP,F_X,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0x88 */ {J_DEC,J_IMP,F_Y,0}, {J_NONE,J_IMP,F_NONE,0}, {J_MOVE,J_IMP,F_A,F_X}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0x8C */ {J_STORE,J_ABS,F_Y,0}, {J_STORE,J_ABS,F_A,0}, {J_STORE,J_ABS,F_X,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0x90 */ {J_BRANCH,J_REL,F_NONE,0}, {J_STORE,J_INDY,F_A,0}, {J_STORE,J_IND,F_A,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0x94 */ {J_STORE,J_ZPX,F_Y,0}, {J_STORE,J_ZPX,F_A,0}, {J_STORE,J_ZPY,F_X,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0x98 */ {J_MOVE,J_IMP,F_A,F_Y}, {J_STORE,J_ABSY,F_A,0}, {J_MOVE,J_IMP,F_SP,F_X}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0x9C */ {J_STORE,J_ABS,F_NONE,0}, {J_STORE,J_ABSX,F_A,0}, {J_STORE,J_ABSX,F_NONE,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0xA0 */ {J_LOAD,J_IMM,F_Y,0}, {J_LOAD,J_INDX,F_A,0}, {J_LOAD,J_IMM,F_X,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0xA4 */ {J_LOAD,J_ZP,F_Y,0}, {J_LOAD,J_ZP,F_A,0}, {J_LOAD,J_ZP,F_X,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0xA8 */ {J_MOVE,J_IMP,F_Y,F_A}, {J_LOAD,J_IMM,F_A,0}, {J_MOVE,J_IMP,F_X,F_A}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0xAC */ {J_LOAD,J_ABS,F_Y,0}, {J_LOAD,J_ABS,F_A,0}, {J_LOAD,J_ABS,F_X,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0xB0 */ {J_BRANCH,J_REL,F_NONE,0}, {J_LOAD,J_INDY,F_A,0}, {J_LOAD,J_IND,F_A,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0xB4 */ {J_LOAD,J_ZPX,F_Y,0}, {J_LOAD,J_ZPX,F_A,0}, {J_LOAD,J_ZPY,F_X,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0xB8 */ {J_FLAG,J_IMP,F_V,0}, {J_LOAD,J_ABSY,F_A,0}, {J_MOVE,J_IMP,F_X,F_SP}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0xBC */ {J_LOAD,J_ABSX,F_Y,0}, {J_LOAD,J_ABSX,F_A,0}, {J_LOAD,J_ABSY,F_X,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0xC0 */ {J_CMP,J_IMM,F_Y,0}, {J_CMP,J_INDX,F_A,0}, {J_NONE,J_IMP,F_NONE,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0xC4 */ {J_CMP,J_ZP,F_Y,0}, {J_CMP,J_ZP,F_A,0}, {J_DEC,J_ZP,F_NONE,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0xC8 */ {J_INC,J_IMP,F_Y,0}, {J_CMP,J_IMM,F_A,0}, {J_DEC,J_IMP,F_X,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0xCC */ {J_CMP,J_ABS,F_Y,0}, {J_CMP,J_ABS,F_A,0}, {J_DEC,J_ABS,F_NONE,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0xD0 */ {J_BRANCH,J_REL,F_NONE,0}, {J_CMP,J_INDY,F_A,0}, {J_CMP,J_IND,F_A,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0xD4 */ {J_NONE,J_IMP,F_NONE,0}, {J_CMP,J_ZPX,F_A,0}, {J_DEC,J_ZPX,F_NONE,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0xD8 */ {J_FLAG,J_IMP,F_D,0}, {J_CMP,J_ABSY,F_A,0}, {J_PUSH,J_IMP,F_X,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0xDC */ {J_NONE,J_IMP,F_NONE,0}, {J_CMP,J_ABSX,F_A,0}, {J_DEC,J_ABSX,F_NONE,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0xE0 */ {J_CMP,J_IMM,F_X,0}, {J_SBC,J_INDX,F_A,0}, {J_NONE,J_IMP,F_NONE,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0xE4 */ {J_CMP,J_ZP,F_X,0}, {J_SBC,J_ZP,F_A,0}, {J_INC,J_ZP,F_NONE,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0xE8 */ {J_INC,J_IMP,F_X,0}, {J_SBC,J_IMM,F_A,0}, {J_NOP,J_IMP,F_NONE,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0xEC */ {J_CMP,J_ABS,F_X,0}, {J_SBC,J_ABS,F_A,0}, {J_INC,J_ABS,F_NONE,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0xF0 */ {J_BRANCH,J_REL,F_NONE,0}, {J_SBC,J_INDY,F_A,0}, {J_SBC,J_IND,F_A,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0xF4 */ {J_NONE,J_IMP,F_NONE,0}, {J_SBC,J_ZPX,F_A,0}, {J_INC,J_ZPX,F_NONE,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0xF8 */ {J_FLAG,J_IMP,F_D,1}, {J_SBC,J_ABSY,F_A,0}, {J_PULL,J_IMP,F_X,0}, {J_NONE,J_IMP,F_NONE,0},
+         /* 0xFC */ {J_NONE,J_IMP,F_NONE,0}, {J_SBC,J_ABSX,F_A,0}, {J_INC,J_ABSX,F_NONE,0}, {J_NONE,J_IMP,F_NONE,0},
+};
+
+static const int jit_mode_length[] = { 1, 2, 2, 2, 2, 3, 3, 3, 2, 2, 2, 2 };
+
+//
+// x86-64 code emitter, only what the translation needs
+//
+
+enum
+{
+   EAX=0, ECX=1, EDX=2, EBX=3, ESP=4, EBP=5, ESI=6, EDI=7,
+   R8=8, R9=9, R10=10, R11=11
+};
+
+// Two operand ALU opcodes, "op r/m32, r32"
+enum { ALU_ADD=0x01, ALU_OR=0x09, ALU_AND=0x21, ALU_SUB=0x29, ALU_XOR=0x31, ALU_CMP=0x39, ALU_TEST=0x85, ALU_MOV=0x89 };
+// ...and their /digit for an immediate
+enum { IMM_ADD=0, IMM_OR=1, IMM_AND=4, IMM_SUB=5, IMM_XOR=6, IMM_CMP=7 };
+enum { SHIFT_SHL=4, SHIFT_SHR=5 };
+enum { CC_B=2, CC_AE=3, CC_E=4, CC_NE=5, CC_NS=9 };
+
+// [base+index+disp], index -1 for none. The bases used are rdi, rsi and
+// rdx, none of which need the special encodings.
+struct JitMem
+{
+   int base;
+   int index;
+   int disp;
+};
+
+class JitEmitter
+{
+   public:
+      JitEmitter(UBYTE *buffer, ULONG size)
+         :mBuffer(buffer),mSize(size),mUsed(0)
+      {
+      }
+
+      inline bool Full(void) { return mUsed>mSize; }
+      inline ULONG Here(void) { return mUsed; }
+
+      void Byte(int b) { if(mUsed<mSize) mBuffer[mUsed]=(UBYTE)b; mUsed++; }
+      void Dword(ULONG d) { Byte(d); Byte(d>>8); Byte(d>>16); Byte(d>>24); }
+      void Qword(uint64_t q) { Dword((ULONG)q); Dword((ULONG)(q>>32)); }
+
+      void Load(int reg, const JitMem &m) { Rex(0,reg,m); Byte(0x8b); ModRM(reg,m); }
+      void Store(const JitMem &m, int reg) { Rex(0,reg,m); Byte(0x89); ModRM(reg,m); }
+      void StoreImm(const JitMem &m, ULONG imm) { Rex(0,0,m); Byte(0xc7); ModRM(0,m); Dword(imm); }
+      void LoadByte(int reg, const JitMem &m) { Rex(0,reg,m); Byte(0x0f); Byte(0xb6); ModRM(reg,m); }
+      void LoadWord(int reg, const JitMem &m) { Rex(0,reg,m); Byte(0x0f); Byte(0xb7); ModRM(reg,m); }
+      void StoreByte(const JitMem &m, int reg) { Rex(0,reg,m); Byte(0x88); ModRM(reg,m); }
+      void StoreByteImm(const JitMem &m, int imm) { Rex(0,0,m); Byte(0xc6); ModRM(0,m); Byte(imm); }
+      void CmpByteImm(const JitMem &m, int imm) { Rex(0,0,m); Byte(0x80); ModRM(7,m); Byte(imm); }
+      void CmpImm(const JitMem &m, ULONG imm) { Rex(0,0,m); Byte(0x81); ModRM(7,m); Dword(imm); }
+      void TestImm(const JitMem &m, ULONG imm) { Rex(0,0,m); Byte(0xf7); ModRM(0,m); Dword(imm); }
+
+      void Alu(int op, int dst, int src) { RexRR(0,src,dst); Byte(op); Byte(0xc0|((src&7)<<3)|(dst&7)); }
+      void AluImm(int ext, int dst, ULONG imm) { RexRR(0,0,dst); Byte(0x81); Byte(0xc0|(ext<<3)|(dst&7)); Dword(imm); }
+      void Shift(int ext, int reg, int count) { RexRR(0,0,reg); Byte(0xc1); Byte(0xc0|(ext<<3)|(reg&7)); Byte(count); }
+      void Not(int reg) { RexRR(0,0,reg); Byte(0xf7); Byte(0xd0|(reg&7)); }
+      void Setcc(int cc, int reg) { RexRR(0,0,reg); Byte(0x0f); Byte(0x90|cc); Byte(0xc0|(reg&7)); }
+      void MovzxByte(int dst, int src) { RexRR(0,dst,src); Byte(0x0f); Byte(0xb6); Byte(0xc0|((dst&7)<<3)|(src&7)); }
+      void MovImm(int reg, ULONG imm) { RexRR(0,0,reg); Byte(0xb8|(reg&7)); Dword(imm); }
+      void MovRaxImm64(uint64_t imm) { Byte(0x48); Byte(0xb8); Qword(imm); }
+      void ShlRax32(void) { Byte(0x48); Byte(0xc1); Byte(0xe0); Byte(32); }
+      void OrRaxImm(ULONG imm) { Byte(0x48); Byte(0x0d); Dword(imm); }
+      void Ret(void) { Byte(0xc3); }
+
+      // Jumps are emitted with a rel32 to patch once the target is known
+      ULONG Jcc(int cc) { Byte(0x0f); Byte(0x80|cc); ULONG at=mUsed; Dword(0); return at; }
+      void Patch(ULONG at, ULONG target)
+      {
+         if(at+4>mSize) return;
+         ULONG rel=target-(at+4);
+         mBuffer[at]=(UBYTE)rel;
+         mBuffer[at+1]=(UBYTE)(rel>>8);
+         mBuffer[at+2]=(UBYTE)(rel>>16);
+         mBuffer[at+3]=(UBYTE)(rel>>24);
+      }
+
+   private:
+      void Rex(int w, int reg, const JitMem &m)
+      {
+         int rex=0x40|(w<<3)|((reg&8)>>1)|((m.index>=0 && (m.index&8))?2:0)|((m.base&8)>>3);
+         if(rex!=0x40) Byte(rex);
+      }
+
+      void RexRR(int w, int reg, int rm)
+      {
+         int rex=0x40|(w<<3)|((reg&8)>>1)|((rm&8)>>3);
+         if(rex!=0x40) Byte(rex);
+      }
+
+      // Always mod=10, a 32 bit displacement
+      void ModRM(int reg, const JitMem &m)
+      {
+         if(m.index<0) {
+            Byte(0x80|((reg&7)<<3)|(m.base&7));
+         } else {
+            Byte(0x84|((reg&7)<<3));
+            Byte(((m.index&7)<<3)|(m.base&7));
+         }
+         Dword(m.disp);
+      }
+
+      UBYTE *mBuffer;
+      ULONG mSize;
+      ULONG mUsed;
+};
+
+//
+// Translation
+//
+
+enum
+{
+   EXIT_BEFORE=0,		// Leave the instruction to the interpreter
+   EXIT_WRITTEN,		// Code at a known address was written
+   EXIT_WRITTEN_ECX		// Code at ecx was written
+};
+
+struct JitExit
+{
+   ULONG patch;
+   int kind;
+   int pc;
+   ULONG cycles;
+   int addr;
+};
+
+class JitTranslator
+{
+   public:
+      JitTranslator(JitEmitter &emit, const int *fields)
+         :mEmit(emit),mFields(fields),mExitCount(0)
+      {
+      }
+
+      inline JitMem Field(int field) { JitMem m={EDI,-1,mFields[field]}; return m; }
+
+      // A jump to a stub that ends the block early
+      void Exit(int cc, int kind, int pc, ULONG cycles, int addr=0)
+      {
+         JitExit &exit=mExits[mExitCount++];
+         exit.patch=mEmit.Jcc(cc);
+         exit.kind=kind;
+         exit.pc=pc;
+         exit.cycles=cycles;
+         exit.addr=addr;
+      }
+
+      void Stubs(void)
+      {
+         for(int i=0;i<mExitCount;i++) {
+            JitExit &exit=mExits[i];
+            mEmit.Patch(exit.patch,mEmit.Here());
+            mEmit.StoreImm(Field(F_PC),exit.pc);
+            switch(exit.kind) {
+               case EXIT_BEFORE:
+                  mEmit.MovRaxImm64(JIT_INTERPRET_NEXT|exit.cycles);
+                  break;
+               case EXIT_WRITTEN:
+                  mEmit.MovRaxImm64(((uint64_t)(exit.addr+1)<<32)|exit.cycles);
+                  break;
+               case EXIT_WRITTEN_ECX:
+                  mEmit.Alu(ALU_MOV,EAX,ECX);
+                  mEmit.AluImm(IMM_ADD,EAX,1);
+                  mEmit.ShlRax32();
+                  mEmit.OrRaxImm(exit.cycles);
+                  break;
+            }
+            mEmit.Ret();
+         }
+         mExitCount=0;
+      }
+
+      void Return(int pc, ULONG cycles)
+      {
+         mEmit.StoreImm(Field(F_PC),pc);
+         mEmit.MovImm(EAX,cycles);
+         mEmit.Ret();
+      }
+
+      // Works out the address of a memory operand. Computed addresses that
+      // land on I/O leave the instruction to the interpreter.
+      JitMem Address(int mode, int operand, int pc, ULONG cycles)
+      {
+         JitMem ram={ESI,ECX,0};
+         switch(mode) {
+            case J_ZP:
+            case J_ABS:
+               ram.index=-1;
+               ram.disp=operand;
+               return ram;
+            case J_ZPX:
+            case J_ZPY:
+               mEmit.Load(ECX,Field(mode==J_ZPX?F_X:F_Y));
+               mEmit.AluImm(IMM_ADD,ECX,operand);
+               mEmit.AluImm(IMM_AND,ECX,0xff);
+               return ram;
+            case J_ABSX:
+            case J_ABSY:
+               mEmit.Load(ECX,Field(mode==J_ABSX?F_X:F_Y));
+               mEmit.AluImm(IMM_ADD,ECX,operand);
+               mEmit.AluImm(IMM_AND,ECX,0xffff);
+               break;
+            case J_INDX:
+               mEmit.Load(ECX,Field(F_X));
+               mEmit.AluImm(IMM_ADD,ECX,operand);
+               mEmit.AluImm(IMM_AND,ECX,0xff);
+               mEmit.LoadWord(ECX,ram);
+               break;
+            case J_INDY:
+               {
+                  JitMem pointer={ESI,-1,operand};
+                  mEmit.LoadWord(ECX,pointer);
+                  mEmit.Load(R8,Field(F_Y));
+                  mEmit.Alu(ALU_ADD,ECX,R8);
+                  mEmit.AluImm(IMM_AND,ECX,0xffff);
+               }
+               break;
+            case J_IND:
+               {
+                  JitMem pointer={ESI,-1,operand};
+                  mEmit.LoadWord(ECX,pointer);
+               }
+               break;
+         }
+         mEmit.AluImm(IMM_CMP,ECX,0xfc00);
+         Exit(CC_AE,EXIT_BEFORE,pc,cycles);
+         return ram;
+      }
+
+      // The operand's value into eax
+      void Value(int mode, int operand, const JitMem &m)
+      {
+         if(mode==J_IMM) mEmit.MovImm(EAX,operand);
+         else mEmit.LoadByte(EAX,m);
+      }
+
+      // After writing RAM, leave if that was code
+      void CheckCode(const JitMem &m, int next, ULONG cycles)
+      {
+         JitMem map=m;
+         map.base=EDX;
+         mEmit.CmpByteImm(map,0);
+         if(m.index<0) Exit(CC_NE,EXIT_WRITTEN,next,cycles,m.disp);
+         else Exit(CC_NE,EXIT_WRITTEN_ECX,next,cycles);
+      }
+
+      // mC?1:0 (or with 'inverted', mC?0:1) into 'reg'
+      void Carry(int reg, bool inverted)
+      {
+         mEmit.Alu(ALU_XOR,reg,reg);
+         mEmit.CmpImm(Field(F_C),0);
+         mEmit.Setcc(inverted?CC_E:CC_NE,reg);
+      }
+
+      // ASL, LSR, ROL and ROR on eax
+      void Shift(int kind)
+      {
+         if(kind==J_ROL || kind==J_ROR) {
+            Carry(R10,false);
+            if(kind==J_ROR) mEmit.Shift(SHIFT_SHL,R10,7);
+         }
+         mEmit.Alu(ALU_MOV,R8,EAX);
+         mEmit.AluImm(IMM_AND,R8,(kind==J_ASL || kind==J_ROL)?0x80:0x01);
+         mEmit.Store(Field(F_C),R8);
+         if(kind==J_ASL || kind==J_ROL) {
+            mEmit.Shift(SHIFT_SHL,EAX,1);
+            if(kind==J_ROL) mEmit.Alu(ALU_OR,EAX,R10);
+            mEmit.AluImm(IMM_AND,EAX,0xff);
+         } else {
+            mEmit.Shift(SHIFT_SHR,EAX,1);
+            if(kind==J_ROR) mEmit.Alu(ALU_OR,EAX,R10);
+         }
+      }
+
+      // Translates one instruction, false if it has to be interpreted
+      bool Instruction(const UBYTE *ram, int pc, ULONG cycles, ULONG op_cycles,
+            JitBlock &block, bool &ends)
+      {
+         int opcode=ram[pc];
+         const JitOpcode &op=jit_opcodes[opcode];
+         int length=jit_mode_length[op.mode];
+         int next=pc+length;
+         ULONG done=cycles+op_cycles;
+         int operand=0;
+
+         ends=FALSE;
+         if(op.kind==J_NONE || next>0xfc00) return FALSE;
+         if(length==2) operand=ram[pc+1];
+         if(length==3) operand=ram[pc+1]|(ram[pc+2]<<8);
+         if(op.mode==J_ABS && operand>=0xfc00 && op.kind!=J_JMP && op.kind!=J_JSR) return FALSE;
+
+         JitMem m={ESI,-1,0};
+         if(op.mode!=J_IMP && op.mode!=J_IMM && op.mode!=J_REL &&
+               op.kind!=J_JMP && op.kind!=J_JSR) {
+            // Decimal mode is left to the interpreter, before touching anything
+            if(op.kind==J_ADC || op.kind==J_SBC) {
+               mEmit.CmpImm(Field(F_D),0);
+               Exit(CC_NE,EXIT_BEFORE,pc,cycles);
+            }
+            m=Address(op.mode,operand,pc,cycles);
+         } else if(op.kind==J_ADC || op.kind==J_SBC) {
+            mEmit.CmpImm(Field(F_D),0);
+            Exit(CC_NE,EXIT_BEFORE,pc,cycles);
+         }
+
+         switch(op.kind) {
+            case J_LOAD:
+               Value(op.mode,operand,m);
+               mEmit.Store(Field(op.reg),EAX);
+               mEmit.Store(Field(F_NZ),EAX);
+               break;
+
+            case J_STORE:
+               if(op.reg==F_NONE) {
+                  mEmit.StoreByteImm(m,0);
+               } else {
+                  mEmit.Load(EAX,Field(op.reg));
+                  mEmit.StoreByte(m,EAX);
+               }
+               CheckCode(m,next,done);
+               break;
+
+            case J_ADC:
+               Value(op.mode,operand,m);
+               mEmit.Load(R8,Field(F_A));
+               Carry(ECX,false);
+               mEmit.Alu(ALU_MOV,R9,R8);
+               mEmit.Alu(ALU_ADD,R9,EAX);
+               mEmit.Alu(ALU_ADD,R9,ECX);
+               mEmit.Alu(ALU_MOV,R10,R8);
+               mEmit.Alu(ALU_XOR,R10,EAX);
+               mEmit.Not(R10);
+               mEmit.Alu(ALU_MOV,R11,R8);
+               mEmit.Alu(ALU_XOR,R11,R9);
+               mEmit.Alu(ALU_AND,R10,R11);
+               mEmit.AluImm(IMM_AND,R10,0x80);
+               mEmit.Shift(SHIFT_SHR,R10,7);
+               mEmit.Store(Field(F_V),R10);
+               mEmit.Alu(ALU_MOV,R11,R9);
+               mEmit.Shift(SHIFT_SHR,R11,8);
+               mEmit.Store(Field(F_C),R11);
+               mEmit.MovzxByte(R9,R9);
+               mEmit.Store(Field(F_A),R9);
+               mEmit.Store(Field(F_NZ),R9);
+               break;
+
+            case J_SBC:
+               Value(op.mode,operand,m);
+               mEmit.Load(R8,Field(F_A));
+               Carry(ECX,true);
+               mEmit.Alu(ALU_MOV,R9,R8);
+               mEmit.Alu(ALU_SUB,R9,EAX);
+               mEmit.Alu(ALU_SUB,R9,ECX);
+               mEmit.Alu(ALU_MOV,R10,R8);
+               mEmit.Alu(ALU_XOR,R10,EAX);
+               mEmit.Alu(ALU_MOV,R11,R8);
+               mEmit.Alu(ALU_XOR,R11,R9);
+               mEmit.Alu(ALU_AND,R10,R11);
+               mEmit.AluImm(IMM_AND,R10,0x80);
+               mEmit.Shift(SHIFT_SHR,R10,7);
+               mEmit.Store(Field(F_V),R10);
+               mEmit.Alu(ALU_XOR,R11,R11);
+               mEmit.Alu(ALU_TEST,R9,R9);
+               mEmit.Setcc(CC_NS,R11);
+               mEmit.Store(Field(F_C),R11);
+               mEmit.MovzxByte(R9,R9);
+               mEmit.Store(Field(F_A),R9);
+               mEmit.Store(Field(F_NZ),R9);
+               break;
+
+            case J_AND:
+            case J_ORA:
+            case J_EOR:
+               Value(op.mode,operand,m);
+               mEmit.Load(R8,Field(F_A));
+               mEmit.Alu(op.kind==J_AND?ALU_AND:(op.kind==J_ORA?ALU_OR:ALU_XOR),R8,EAX);
+               mEmit.Store(Field(F_A),R8);
+               mEmit.Store(Field(F_NZ),R8);
+               break;
+
+            case J_CMP:
+               Value(op.mode,operand,m);
+               mEmit.Load(R8,Field(op.reg));
+               mEmit.Alu(ALU_XOR,R9,R9);
+               mEmit.Alu(ALU_CMP,R8,EAX);
+               mEmit.Setcc(CC_AE,R9);
+               mEmit.Store(Field(F_C),R9);
+               mEmit.Alu(ALU_SUB,R8,EAX);
+               mEmit.MovzxByte(R8,R8);
+               mEmit.Store(Field(F_NZ),R8);
+               break;
+
+            case J_BIT:
+               // SetNZ(value&0x80,!(mA&value)) and mV=value&0x40
+               Value(op.mode,operand,m);
+               mEmit.Alu(ALU_MOV,R8,EAX);
+               mEmit.AluImm(IMM_AND,R8,0x80);
+               mEmit.Shift(SHIFT_SHL,R8,1);
+               mEmit.Load(R9,Field(F_A));
+               mEmit.Alu(ALU_XOR,R10,R10);
+               mEmit.Alu(ALU_TEST,R9,EAX);
+               mEmit.Setcc(CC_NE,R10);
+               mEmit.Alu(ALU_OR,R8,R10);
+               mEmit.Store(Field(F_NZ),R8);
+               mEmit.Alu(ALU_MOV,R8,EAX);
+               mEmit.AluImm(IMM_AND,R8,0x40);
+               mEmit.Store(Field(F_V),R8);
+               break;
+
+            case J_INC:
+            case J_DEC:
+            case J_ASL:
+            case J_LSR:
+            case J_ROL:
+            case J_ROR:
+               if(op.mode==J_IMP) mEmit.Load(EAX,Field(op.reg));
+               else mEmit.LoadByte(EAX,m);
+               if(op.kind==J_INC || op.kind==J_DEC) {
+                  mEmit.AluImm(op.kind==J_INC?IMM_ADD:IMM_SUB,EAX,1);
+                  mEmit.AluImm(IMM_AND,EAX,0xff);
+               } else {
+                  Shift(op.kind);
+               }
+               mEmit.Store(Field(F_NZ),EAX);
+               if(op.mode==J_IMP) {
+                  mEmit.Store(Field(op.reg),EAX);
+               } else {
+                  mEmit.StoreByte(m,EAX);
+                  CheckCode(m,next,done);
+               }
+               break;
+
+            case J_MOVE:
+               mEmit.Load(EAX,Field(op.arg));
+               mEmit.Store(Field(op.reg),EAX);
+               if(op.reg!=F_SP) mEmit.Store(Field(F_NZ),EAX);
+               break;
+
+            case J_FLAG:
+               mEmit.StoreImm(Field(op.reg),op.arg);
+               break;
+
+            case J_NOP:
+               break;
+
+            case J_PUSH:
+               {
+                  JitMem stack={ESI,EAX,0x100};
+                  JitMem map={EDX,EAX,0x100};
+                  mEmit.Load(EAX,Field(F_SP));
+                  mEmit.Load(ECX,Field(op.reg));
+                  mEmit.StoreByte(stack,ECX);
+                  mEmit.Alu(ALU_MOV,R8,EAX);
+                  mEmit.AluImm(IMM_SUB,R8,1);
+                  mEmit.AluImm(IMM_AND,R8,0xff);
+                  mEmit.Store(Field(F_SP),R8);
+                  mEmit.CmpByteImm(map,0);
+                  Exit(CC_NE,EXIT_WRITTEN,next,done,0x100);
+               }
+               break;
+
+            case J_PULL:
+               {
+                  JitMem stack={ESI,EAX,0x100};
+                  mEmit.Load(EAX,Field(F_SP));
+                  mEmit.AluImm(IMM_ADD,EAX,1);
+                  mEmit.AluImm(IMM_AND,EAX,0xff);
+                  mEmit.Store(Field(F_SP),EAX);
+                  mEmit.LoadByte(ECX,stack);
+                  mEmit.Store(Field(op.reg),ECX);
+                  mEmit.Store(Field(F_NZ),ECX);
+               }
+               break;
+
+            case J_BRANCH:
+               {
+                  int offset=(signed char)operand;
+                  int target=(next+offset)&0xffff;
+                  if(offset<0) {
+                     block.loop_start=target;
+                     block.loop_end=target-offset;
+                  }
+                  if(opcode==0x80) {
+                     Return(target,done);
+                  } else {
+                     int cc=CC_NE;
+                     switch(opcode) {
+                        case 0x10: mEmit.TestImm(Field(F_NZ),0x180); cc=CC_E; break;
+                        case 0x30: mEmit.TestImm(Field(F_NZ),0x180); cc=CC_NE; break;
+                        case 0x50: mEmit.CmpImm(Field(F_V),0); cc=CC_E; break;
+                        case 0x70: mEmit.CmpImm(Field(F_V),0); cc=CC_NE; break;
+                        case 0x90: mEmit.CmpImm(Field(F_C),0); cc=CC_E; break;
+                        case 0xB0: mEmit.CmpImm(Field(F_C),0); cc=CC_NE; break;
+                        case 0xD0: mEmit.TestImm(Field(F_NZ),0xff); cc=CC_NE; break;
+                        case 0xF0: mEmit.TestImm(Field(F_NZ),0xff); cc=CC_E; break;
+                     }
+                     ULONG taken=mEmit.Jcc(cc);
+                     Return(next,done);
+                     mEmit.Patch(taken,mEmit.Here());
+                     Return(target,done);
+                  }
+                  ends=TRUE;
+               }
+               break;
+
+            case J_JMP:
+               if(operand-next<0) {
+                  block.loop_start=operand;
+                  block.loop_end=next;
+               }
+               Return(operand,done);
+               ends=TRUE;
+               break;
+
+            case J_JSR:
+               {
+                  // Both pushes, then leave through a stub if either was
+                  // on code
+                  JitMem stack={ESI,EAX,0x100};
+                  JitMem map={EDX,EAX,0x100};
+                  mEmit.Load(EAX,Field(F_SP));
+                  mEmit.StoreByteImm(stack,((next-1)>>8)&0xff);
+                  mEmit.LoadByte(R9,map);
+                  mEmit.AluImm(IMM_SUB,EAX,1);
+                  mEmit.AluImm(IMM_AND,EAX,0xff);
+                  mEmit.StoreByteImm(stack,(next-1)&0xff);
+                  mEmit.LoadByte(R10,map);
+                  mEmit.Alu(ALU_OR,R9,R10);
+                  mEmit.AluImm(IMM_SUB,EAX,1);
+                  mEmit.AluImm(IMM_AND,EAX,0xff);
+                  mEmit.Store(Field(F_SP),EAX);
+                  mEmit.Alu(ALU_TEST,R9,R9);
+                  Exit(CC_NE,EXIT_WRITTEN,operand,done,0x100);
+                  Return(operand,done);
+                  ends=TRUE;
+               }
+               break;
+
+            case J_RTS:
+               {
+                  JitMem stack={ESI,EAX,0x100};
+                  mEmit.Load(EAX,Field(F_SP));
+                  mEmit.AluImm(IMM_ADD,EAX,1);
+                  mEmit.AluImm(IMM_AND,EAX,0xff);
+                  mEmit.LoadByte(ECX,stack);
+                  mEmit.AluImm(IMM_ADD,EAX,1);
+                  mEmit.AluImm(IMM_AND,EAX,0xff);
+                  mEmit.LoadByte(R8,stack);
+                  mEmit.Store(Field(F_SP),EAX);
+                  mEmit.Shift(SHIFT_SHL,R8,8);
+                  mEmit.Alu(ALU_OR,ECX,R8);
+                  mEmit.AluImm(IMM_ADD,ECX,1);
+                  mEmit.Store(Field(F_PC),ECX);
+                  mEmit.MovImm(EAX,done);
+                  mEmit.Ret();
+                  ends=TRUE;
+               }
+               break;
+         }
+         return TRUE;
+      }
+
+   private:
+      JitEmitter &mEmit;
+      const int *mFields;
+      JitExit mExits[JIT_MAX_INSTRUCTIONS*2+2];
+      int mExitCount;
+};
+
+C65C02Jit::C65C02Jit(C65C02 &cpu)
+   :mCpu(cpu)
+{
+   mCodeSize=JIT_CODE_SIZE;
+   mCodeUsed=0;
+   void *code=mmap(NULL,mCodeSize,PROT_READ|PROT_WRITE|PROT_EXEC,MAP_PRIVATE|MAP_ANONYMOUS,-1,0);
+   mCode=(code==MAP_FAILED)?NULL:(UBYTE*)code;
+
+   mBlocks=new JitBlock[JIT_MAX_BLOCKS];
+   mBlocksUsed=0;
+   memset(&mNoBlock,0,sizeof(mNoBlock));
+   mBlockAt=new JitBlock*[0xfc00];
+   mCodeMap=mCpu.mCodeMap;
+
+   mBlocksCompiled=0;
+   mInvalidations=0;
+   mFlushes=0;
+   Flush();
+   mFlushes=0;
+}
+
+C65C02Jit::~C65C02Jit()
+{
+   // Leave nothing marked that no one would drop
+   for(int addr=0;addr<0x10000;addr++) mCodeMap[addr]&=~CODE_MAP_JIT;
+   if(mCode) munmap(mCode,mCodeSize);
+   delete[] mBlocks;
+   delete[] mBlockAt;
+}
+
+void C65C02Jit::Flush(void)
+{
+   memset(mBlockAt,0,0xfc00*sizeof(JitBlock*));
+   for(int addr=0;addr<0x10000;addr++) mCodeMap[addr]&=~CODE_MAP_JIT;
+   mCodeUsed=0;
+   mBlocksUsed=0;
+   mFlushes++;
+}
+
+JitBlock* C65C02Jit::Compile(int pc)
+{
+   if(mBlocksUsed==JIT_MAX_BLOCKS || mCodeSize-mCodeUsed<JIT_MAX_BLOCK_CODE) Flush();
+
+   const int fields[F_NONE]={
+      (int)((UBYTE*)&mCpu.mA-(UBYTE*)&mCpu),
+      (int)((UBYTE*)&mCpu.mX-(UBYTE*)&mCpu),
+      (int)((UBYTE*)&mCpu.mY-(UBYTE*)&mCpu),
+      (int)((UBYTE*)&mCpu.mSP-(UBYTE*)&mCpu),
+      (int)((UBYTE*)&mCpu.mPC-(UBYTE*)&mCpu),
+      (int)((UBYTE*)&mCpu.mNZ-(UBYTE*)&mCpu),
+      (int)((UBYTE*)&mCpu.mV-(UBYTE*)&mCpu),
+      (int)((UBYTE*)&mCpu.mD-(UBYTE*)&mCpu),
+      (int)((UBYTE*)&mCpu.mC-(UBYTE*)&mCpu)
+   };
+   JitEmitter emit(mCode+mCodeUsed,JIT_MAX_BLOCK_CODE);
+   JitTranslator translate(emit,fields);
+   JitBlock &block=mBlocks[mBlocksUsed];
+   const UBYTE *ram=mCpu.mRamPointer;
+
+   block.start=pc;
+   block.loop_start=-1;
+   block.loop_end=-1;
+
+   int count=0;
+   ULONG cycles=0;
+   ULONG last_cycles=0;
+   bool ends=FALSE;
+   while(count<JIT_MAX_INSTRUCTIONS && !ends) {
+      ULONG op_cycles=C65C02::OpcodeCycles(ram[pc]);
+      if(!translate.Instruction(ram,pc,cycles,op_cycles,block,ends)) break;
+      pc+=jit_mode_length[jit_opcodes[ram[pc]].mode];
+      cycles+=op_cycles;
+      last_cycles=op_cycles;
+      count++;
+   }
+
+   if(!count || emit.Full()) {
+      mBlockAt[block.start]=&mNoBlock;
+      return &mNoBlock;
+   }
+   if(!ends) translate.Return(pc,cycles);
+   translate.Stubs();
+   if(emit.Full()) {
+      mBlockAt[block.start]=&mNoBlock;
+      return &mNoBlock;
+   }
+
+   block.code=(uint64_t (*)(C65C02*,UBYTE*,const UBYTE*))(mCode+mCodeUsed);
+   block.end=pc;
+   block.lead_cycles=cycles-last_cycles;
+   mCodeUsed+=(emit.Here()+15)&~15;
+   mBlocksUsed++;
+   mBlocksCompiled++;
+
+   mBlockAt[block.start]=&block;
+   for(int addr=block.start;addr<block.end;addr++) mCodeMap[addr]|=CODE_MAP_JIT;
+   return &block;
+}
+
+void C65C02Jit::MarkCode(int lo, int hi)
+{
+   if(lo<0) lo=0;
+   if(hi>0x10000) hi=0x10000;
+   for(int addr=lo;addr<hi;addr++) mCodeMap[addr]&=~CODE_MAP_JIT;
+   int first=lo-JIT_MAX_BLOCK_BYTES;
+   if(first<0) first=0;
+   for(int addr=first;addr<hi && addr<0xfc00;addr++) {
+      JitBlock *block=mBlockAt[addr];
+      if(!block || !block->code) continue;
+      int start=(block->start>lo)?block->start:lo;
+      int end=(block->end<hi)?block->end:hi;
+      for(int addr=start;addr<end;addr++) mCodeMap[addr]|=CODE_MAP_JIT;
+   }
+}
+
+void C65C02Jit::Invalidate(int addr)
+{
+   int lo=addr&0xff00;
+   int hi=lo+0x100;
+   int first=lo-JIT_MAX_BLOCK_BYTES;
+   if(first<0) first=0;
+   for(int start=first;start<hi && start<0xfc00;start++) {
+      JitBlock *block=mBlockAt[start];
+      if(!block) continue;
+      if(!block->code) {
+         if(start>=lo) mBlockAt[start]=NULL;
+         continue;
+      }
+      if(block->start<hi && block->end>lo) mBlockAt[start]=NULL;
+   }
+   // The dropped blocks may have run into the pages either side
+   MarkCode(lo-JIT_MAX_BLOCK_BYTES,hi+JIT_MAX_BLOCK_BYTES);
+   mInvalidations++;
+}
+
+#else
+
+C65C02Jit::C65C02Jit(C65C02 &cpu)
+   :mCpu(cpu)
+{
+   mCode=NULL;
+   mCodeSize=0;
+   mCodeUsed=0;
+   mBlocks=NULL;
+   mBlocksUsed=0;
+   mBlockAt=NULL;
+   mCodeMap=NULL;
+   mBlocksCompiled=0;
+   mInvalidations=0;
+   mFlushes=0;
+}
+
+C65C02Jit::~C65C02Jit()
+{
+}
+
+void C65C02Jit::Flush(void)
+{
+}
+
+JitBlock* C65C02Jit::Compile(int pc)
+{
+   return NULL;
+}
+
+void C65C02Jit::MarkCode(int lo, int hi)
+{
+}
+
+void C65C02Jit::Invalidate(int addr)
+{
+}
+
+#endif
@@ -0,0 +1,115 @@
+//
+// Copyright (c) 2024 superKoder : later improvements for Handy MP.
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from
+// the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not
+//    be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+
+//////////////////////////////////////////////////////////////////////////////
+// 65C02 recompiler                                                         //
+//////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// Translates straight runs of 65C02 code in RAM into x86-64 code. A block  //
+// ends at a branch, jump, JSR or RTS, or before anything it can't do       //
+// natively: I/O ($FC00 and up), interrupt flag changes, decimal mode maths //
+// and the rarer opcodes. Those are left to C65C02's interpreter, so is     //
+// every instruction whose cycles would cross a timer event, which keeps    //
+// the results exactly the same as the interpreter's.                       //
+//                                                                          //
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef C65C02JIT_H
+#define C65C02JIT_H
+
+#include "machine.h"
+
+#if defined(__x86_64__) && (defined(__linux__) || defined(__FreeBSD__)) && !defined(HANDY_NO_JIT)
+#define HANDY_JIT 1
+#else
+#define HANDY_JIT 0
+#endif
+
+class C65C02;
+
+// What a block returns: the cycles it took in the low 32 bits, then either
+// the address+1 of a code byte it wrote to, or JIT_INTERPRET_NEXT when it
+// stopped in front of something the interpreter has to do.
+#define JIT_CYCLES(result)			((ULONG)(result))
+#define JIT_WRITTEN(result)			((int)(((result)>>32)&0x7fffffff)-1)
+#define JIT_INTERPRET_NEXT			(1ull<<63)
+
+struct JitBlock
+{
+   uint64_t (*code)(C65C02 *cpu, UBYTE *ram, const UBYTE *code_map);
+   int start;			// First byte of the block
+   int end;				// Just past its last instruction
+   ULONG lead_cycles;	// Cycles of all but the last instruction
+   int loop_start;		// Where a backward branch or jump goes, -1 if none
+   int loop_end;		// ...and where C65C02::IdleLoop() expects it to end
+};
+
+class C65C02Jit
+{
+   public:
+      C65C02Jit(C65C02 &cpu);
+      ~C65C02Jit();
+
+      // False when no executable memory could be had
+      inline bool IsUsable(void) { return mCode!=NULL; }
+
+      // The block starting at 'pc', translated on first use. NULL when
+      // the instruction at 'pc' has to be interpreted.
+      inline JitBlock* Lookup(int pc)
+      {
+         if(pc>=0xfc00) return NULL;
+         JitBlock *block=mBlockAt[pc];
+         if(!block) block=Compile(pc);
+         return block->code?block:NULL;
+      }
+
+      // Drops the blocks translated from the page 'addr' is in
+      void Invalidate(int addr);
+      void Flush(void);
+
+      inline ULONG GetBlocksCompiled(void) { return mBlocksCompiled; }
+      inline ULONG GetInvalidations(void) { return mInvalidations; }
+      inline ULONG GetFlushes(void) { return mFlushes; }
+
+   private:
+      JitBlock* Compile(int pc);
+      void MarkCode(int lo, int hi);
+
+      C65C02 &mCpu;
+
+      UBYTE *mCode;
+      ULONG mCodeSize;
+      ULONG mCodeUsed;
+
+      JitBlock *mBlocks;
+      ULONG mBlocksUsed;
+      JitBlock mNoBlock;
+
+      JitBlock **mBlockAt;
+      UBYTE *mCodeMap;	// The CPU's, see CODE_MAP_JIT
+
+      ULONG mBlocksCompiled;
+      ULONG mInvalidations;
+      ULONG mFlushes;
+};
+
+#endif
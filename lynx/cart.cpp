@@ -53,6 +53,92 @@
 #include "handy.h"
 #include "cart_db.h"
 
+#include <map>
+#include <mutex>
+#include <utility>
+
+//
+// Registry of the cart images currently in use, keyed on CRC and size. It
+// only holds weak references, the image goes away with its last CCart.
+//
+static std::mutex cart_image_lock;
+static std::map<std::pair<ULONG,ULONG>, std::weak_ptr<CCartImage> > cart_images;
+
+std::shared_ptr<CCartImage> CCartImage::Acquire(const UBYTE *gamedata, ULONG gamesize, ULONG crc32,
+                                                int headersize, ULONG bank0size, ULONG bank1size, bool audin)
+{
+   std::lock_guard<std::mutex> lock(cart_image_lock);
+
+   for(auto it=cart_images.begin(); it!=cart_images.end();) {
+      if(it->second.expired()) it=cart_images.erase(it);
+      else ++it;
+   }
+
+   std::weak_ptr<CCartImage> &slot=cart_images[std::make_pair(crc32,gamesize)];
+   std::shared_ptr<CCartImage> image=slot.lock();
+   if(image) return image;
+
+   image=std::shared_ptr<CCartImage>(new CCartImage());
+
+   // Make some space for the new carts
+
+   image->mBank0 = (UBYTE*) new UBYTE[bank0size];
+   image->mBank1 = (UBYTE*) new UBYTE[bank1size];
+   image->mBank0A = (UBYTE*) new UBYTE[bank0size];
+   image->mBank1A = (UBYTE*) new UBYTE[bank1size];
+
+   // Initialiase
+
+   // TODO: the following code to read the banks is not very nice .. should be reworked
+   // TODO: actually its dangerous, if more than one bank is used ... (only homebrews)
+   int cartsize = __max(0, int(gamesize - headersize));
+   int bank0copy = __min(cartsize, (int)bank0size);
+   int bank1copy = __min(cartsize, (int)bank1size);
+
+   memset(image->mBank0, DEFAULT_CART_CONTENTS, bank0copy);
+   memset(image->mBank1, DEFAULT_CART_CONTENTS, bank1copy);
+   memset(image->mBank0A, DEFAULT_CART_CONTENTS, bank0copy);
+   memset(image->mBank1A, DEFAULT_CART_CONTENTS, bank1copy);
+   if(bank0copy==1) bank0copy=0;// workaround ...
+   if(bank1copy==1) bank1copy=0;// workaround ...
+
+   memcpy(
+         image->mBank0,
+         gamedata+(headersize),
+         bank0copy);
+   cartsize = cartsize < bank0copy ? 0 : cartsize - bank0copy;
+
+   memcpy(
+         image->mBank1,
+         gamedata+(headersize + bank0copy),
+         cartsize < bank1copy ? cartsize : bank1copy);
+   cartsize = cartsize < bank1copy ? 0 : cartsize - bank1copy;
+
+   if(audin){// TODO clean up code
+      memcpy(
+            image->mBank0A,
+            gamedata+(headersize+ bank0copy + bank1copy),
+            cartsize < bank0copy ? cartsize : bank0copy);
+      cartsize = cartsize < bank0copy ? 0 : cartsize - bank0copy;
+
+      memcpy(
+            image->mBank1A,
+            gamedata+(headersize + bank0copy + bank1copy + bank0copy),
+            cartsize < bank1copy ? cartsize : bank1copy);
+   }
+
+   slot=image;
+   return image;
+}
+
+CCartImage::~CCartImage()
+{
+   delete[] mBank0;
+   delete[] mBank1;
+   delete[] mBank0A;
+   delete[] mBank1A;
+}
+
 CCart::CCart(CSystem &parent, const UBYTE *gamedata, ULONG gamesize) : mSystem(parent)
 {
    int headersize=0;
@@ -220,60 +306,21 @@ CCart::CCart(CSystem &parent, const UBYTE *gamedata, ULONG gamesize) : mSystem(p
          break;
    }
 
-   // Make some space for the new carts
-
-   mCartBank0 = (UBYTE*) new UBYTE[mMaskBank0+1];
-   mCartBank1 = (UBYTE*) new UBYTE[mMaskBank1+1];
-   mCartBank0A = (UBYTE*) new UBYTE[mMaskBank0+1];
-   mCartBank1A = (UBYTE*) new UBYTE[mMaskBank1+1];
-
    // Set default bank
 
    mBank=bank0;
 
-   // Initialiase
-
-   // TODO: the following code to read the banks is not very nice .. should be reworked
-   // TODO: actually its dangerous, if more than one bank is used ... (only homebrews)
-   int cartsize = __max(0, int(gamesize - headersize));
-   int bank0size = __min(cartsize, (int)(mMaskBank0+1));
-   int bank1size = __min(cartsize, (int)(mMaskBank1+1));
-
-   memset(mCartBank0, DEFAULT_CART_CONTENTS, bank0size);
-   memset(mCartBank1, DEFAULT_CART_CONTENTS, bank1size);
-   memset(mCartBank0A, DEFAULT_CART_CONTENTS, bank0size);
-   memset(mCartBank1A, DEFAULT_CART_CONTENTS, bank1size);
-   if(bank0size==1) bank0size=0;// workaround ...
-   if(bank1size==1) bank1size=0;// workaround ...
-   
-   memcpy(
-         mCartBank0,
-         gamedata+(headersize),
-         bank0size);
-   cartsize = cartsize < bank0size ? 0 : cartsize - bank0size;
-
-   memcpy(
-         mCartBank1,
-         gamedata+(headersize + bank0size),
-         cartsize < bank1size ? cartsize : bank1size);
-   cartsize = cartsize < bank1size ? 0 : cartsize - bank1size;
-
-   if(mAudinFlag){// TODO clean up code
-      memcpy(
-            mCartBank0A,
-            gamedata+(headersize+ bank0size + bank1size),
-            cartsize < bank0size ? cartsize : bank0size);
-      cartsize = cartsize < bank0size ? 0 : cartsize - bank0size;
-
-      memcpy(
-            mCartBank1A,
-            gamedata+(headersize + bank0size + bank1size + bank0size),
-            cartsize < bank1size ? cartsize : bank1size);
-      cartsize = cartsize < bank1size ? 0 : cartsize - bank1size;
-   }
+   // Share the banks with any other cart built from the same game data
 
-   if(bank0size==0) bank0size=1;// workaround ...
-   if(bank1size==0) bank1size=1;// workaround ...
+   mImage=CCartImage::Acquire(gamedata,gamesize,mCRC32,headersize,mMaskBank0+1,mMaskBank1+1,mAudinFlag);
+   mCartBank0=mImage->mBank0;
+   mCartBank1=mImage->mBank1;
+   mCartBank0A=mImage->mBank0A;
+   mCartBank1A=mImage->mBank1A;
+   mOwnBank0=false;
+   mOwnBank1=false;
+   mOwnBank0A=false;
+   mOwnBank1A=false;
 
    // Copy the cart banks from the image
    if(gamesize) {
@@ -300,26 +347,78 @@ CCart::CCart(CSystem &parent, const UBYTE *gamedata, ULONG gamesize) : mSystem(p
 
    // Dont allow an empty Bank1 - Use it for shadow SRAM/EEPROM
    if(banktype1==UNUSED) {
-      // Delete the single byte allocated  earlier
-      delete[] mCartBank1;
-      // Allocate some new memory for us
+      // Allocate some new memory for us, this one is never shared
       banktype1=C64K;
       mMaskBank1=0x00ffff;
       mShiftCount1=8;
       mCountMask1=0x0ff;
       mCartBank1 = (UBYTE*) new UBYTE[mMaskBank1+1];
       memset(mCartBank1, DEFAULT_RAM_CONTENTS, mMaskBank1+1);
+      mOwnBank1=true;
       mWriteEnableBank1=TRUE;
       mCartRAM=TRUE;
    }
 }
 
+CCart::CCart(CSystem &parent, const CCart &origin) : mSystem(parent)
+{
+   mWriteEnableBank0=origin.mWriteEnableBank0;
+   mWriteEnableBank1=origin.mWriteEnableBank1;
+   mCartRAM=origin.mCartRAM;
+   mMaskBank0=origin.mMaskBank0;
+   mMaskBank1=origin.mMaskBank1;
+   mEEPROMType=origin.mEEPROMType;
+
+   mBank=origin.mBank;
+   strcpy(mName,origin.mName);
+   strcpy(mManufacturer,origin.mManufacturer);
+   mRotation=origin.mRotation;
+   mAudinFlag=origin.mAudinFlag;
+   mHeaderLess=origin.mHeaderLess;
+
+   mCounter=origin.mCounter;
+   mShifter=origin.mShifter;
+   mAddrData=origin.mAddrData;
+   mStrobe=origin.mStrobe;
+   mLastStrobe=origin.mLastStrobe;
+   mShiftCount0=origin.mShiftCount0;
+   mCountMask0=origin.mCountMask0;
+   mShiftCount1=origin.mShiftCount1;
+   mCountMask1=origin.mCountMask1;
+   mCRC32=origin.mCRC32;
+
+   // Share whatever the original still shares, copy what it has written to
+
+   mImage=origin.mImage;
+   mCartBank0=origin.mCartBank0;
+   mCartBank1=origin.mCartBank1;
+   mCartBank0A=origin.mCartBank0A;
+   mCartBank1A=origin.mCartBank1A;
+   mOwnBank0=false;
+   mOwnBank1=false;
+   mOwnBank0A=false;
+   mOwnBank1A=false;
+   if(origin.mOwnBank0) UnshareBank(mCartBank0,mOwnBank0,mMaskBank0+1);
+   if(origin.mOwnBank1) UnshareBank(mCartBank1,mOwnBank1,mMaskBank1+1);
+   if(origin.mOwnBank0A) UnshareBank(mCartBank0A,mOwnBank0A,mMaskBank0+1);
+   if(origin.mOwnBank1A) UnshareBank(mCartBank1A,mOwnBank1A,mMaskBank1+1);
+}
+
 CCart::~CCart()
 {
-   delete[] mCartBank0;
-   delete[] mCartBank1;
-   delete[] mCartBank0A;
-   delete[] mCartBank1A;
+   if(mOwnBank0) delete[] mCartBank0;
+   if(mOwnBank1) delete[] mCartBank1;
+   if(mOwnBank0A) delete[] mCartBank0A;
+   if(mOwnBank1A) delete[] mCartBank1A;
+}
+
+void CCart::UnshareBank(UBYTE *&bank, bool &own, ULONG size)
+{
+   if(own) return;
+   UBYTE *copy=new UBYTE[size];
+   memcpy(copy,bank,size);
+   bank=copy;
+   own=true;
 }
 
 
@@ -374,8 +473,9 @@ bool CCart::ContextLoad(LSS_FILE *fp)
    if(!lss_read(&mCartRAM,sizeof(ULONG),1,fp)) return 0;
    if(mCartRAM) {
       if(!lss_read(&mMaskBank1,sizeof(ULONG),1,fp)) return 0;
-      delete[] mCartBank1;
+      if(mOwnBank1) delete[] mCartBank1;
       mCartBank1 = new UBYTE[mMaskBank1+1];
+      mOwnBank1=true;
       if(!lss_read(mCartBank1,sizeof(UBYTE),mMaskBank1+1,fp)) return 0;
    }
    return 1;
@@ -403,10 +503,12 @@ bool CCart::ContextLoadLegacy(LSS_FILE *fp)
    if(!lss_read(&mMaskBank0,sizeof(ULONG),1,fp)) return 0;
    if(!lss_read(&mMaskBank1,sizeof(ULONG),1,fp)) return 0;
 
-   delete[] mCartBank0;
-   delete[] mCartBank1;
+   if(mOwnBank0) delete[] mCartBank0;
+   if(mOwnBank1) delete[] mCartBank1;
    mCartBank0 = new UBYTE[mMaskBank0+1];
    mCartBank1 = new UBYTE[mMaskBank1+1];
+   mOwnBank0=true;
+   mOwnBank1=true;
    if(!lss_read(mCartBank0,sizeof(UBYTE),mMaskBank0+1,fp)) return 0;
    if(!lss_read(mCartBank1,sizeof(UBYTE),mMaskBank1+1,fp)) return 0;
    return 1;
@@ -415,9 +517,15 @@ bool CCart::ContextLoadLegacy(LSS_FILE *fp)
 inline void CCart::Poke(ULONG addr, UBYTE data)
 {
    if(mBank==bank0) {
-      if(mWriteEnableBank0) mCartBank0[addr&mMaskBank0]=data;
+      if(mWriteEnableBank0) {
+         UnshareBank(mCartBank0,mOwnBank0,mMaskBank0+1);
+         mCartBank0[addr&mMaskBank0]=data;
+      }
    } else {
-      if(mWriteEnableBank1) mCartBank1[addr&mMaskBank1]=data;
+      if(mWriteEnableBank1) {
+         UnshareBank(mCartBank1,mOwnBank1,mMaskBank1+1);
+         mCartBank1[addr&mMaskBank1]=data;
+      }
    }
 }
 
@@ -462,6 +570,7 @@ void CCart::Poke0(UBYTE data)
 {
    if(mWriteEnableBank0) {
       ULONG address=(mShifter<<mShiftCount0)+(mCounter&mCountMask0);
+      UnshareBank(mCartBank0,mOwnBank0,mMaskBank0+1);
       mCartBank0[address&mMaskBank0]=data;
    }
    if(!mStrobe) {
@@ -474,6 +583,7 @@ void CCart::Poke0A(UBYTE data)
 {
 	if(mWriteEnableBank0) {
        ULONG address=(mShifter<<mShiftCount0)+(mCounter&mCountMask0);
+       UnshareBank(mCartBank0A,mOwnBank0A,mMaskBank0+1);
        mCartBank0A[address&mMaskBank0]=data;		
 	}
 	if(!mStrobe) {
@@ -486,6 +596,7 @@ void CCart::Poke1(UBYTE data)
 {
    if(mWriteEnableBank1) {
       ULONG address=(mShifter<<mShiftCount1)+(mCounter&mCountMask1);
+      UnshareBank(mCartBank1,mOwnBank1,mMaskBank1+1);
       mCartBank1[address&mMaskBank1]=data;
    }
    if(!mStrobe) {
@@ -498,6 +609,7 @@ void CCart::Poke1A(UBYTE data)
 {
 	if(mWriteEnableBank1) {
        ULONG address=(mShifter<<mShiftCount1)+(mCounter&mCountMask1);
+       UnshareBank(mCartBank1A,mOwnBank1A,mMaskBank1+1);
        mCartBank1A[address&mMaskBank1]=data;		
 	}
 	if(!mStrobe) {
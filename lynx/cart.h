@@ -46,6 +46,8 @@
 #ifndef CART_H
 #define CART_H
 
+#include <memory>
+
 #define EPYX_HEADER_OLD 512
 #define EPYX_HEADER_NEW 410
 
@@ -108,6 +110,30 @@ typedef struct
 } LYNX_DB;
 
 
+//
+// The ROM contents of a cartridge, built once per game and shared by every
+// CCart that loads the same image (i.e. all consoles of a multi player
+// session). It is never written to, a CCart that needs to write into one of
+// its banks takes a private copy of that bank first.
+//
+class CCartImage
+{
+   public:
+      static std::shared_ptr<CCartImage> Acquire(const UBYTE *gamedata, ULONG gamesize, ULONG crc32,
+                                                 int headersize, ULONG bank0size, ULONG bank1size, bool audin);
+      ~CCartImage();
+
+   private:
+      CCartImage() {};
+      friend class CCart;
+
+      UBYTE	*mBank0;
+      UBYTE	*mBank1;
+      UBYTE	*mBank0A;
+      UBYTE	*mBank1A;
+};
+
+
 class CCart : public CLynxBase
 {
 
@@ -115,6 +141,7 @@ class CCart : public CLynxBase
 
    public:
       CCart(CSystem &parent, const UBYTE *gamedata, ULONG gamesize);
+      CCart(CSystem &parent, const CCart &origin);
       ~CCart();
 
    public:
@@ -168,14 +195,24 @@ class CCart : public CLynxBase
       ULONG	mMaskBank1;
       UBYTE     mEEPROMType;
 
+   private:
+      void	UnshareBank(UBYTE *&bank, bool &own, ULONG size);
+
    private:
       CSystem &mSystem;
       EMMODE	mBank;
 
+      std::shared_ptr<CCartImage> mImage;
+
+      // Point into mImage until written to (copy on write)
       UBYTE	*mCartBank0;
       UBYTE	*mCartBank1;
       UBYTE	*mCartBank0A;
       UBYTE	*mCartBank1A;
+      bool	mOwnBank0;
+      bool	mOwnBank1;
+      bool	mOwnBank0A;
+      bool	mOwnBank1A;
       char	mName[33];
       char	mManufacturer[17];
       ULONG	mRotation;
@@ -81,12 +81,10 @@
 void CMemMap::Reset(void)
 {
 
-   // Initialise ALL pointers to RAM then overload to correct
-   for(int loop=0;loop<SYSTEM_SIZE;loop++) mSystem.mMemoryHandlers[loop]=mSystem.mRam;
-
-   // Special case for ourselves.
-   mSystem.mMemoryHandlers[0xFFF8]=mSystem.mRam;
-   mSystem.mMemoryHandlers[0xFFF9]=mSystem.mMemMap;
+   // Initialise ALL pointers to RAM then overload to correct, $FFF8 (RAM)
+   // and $FFF9 (ourselves) are fixed in CSystem::MemoryHandler()
+   for(int loop=0;loop<TOP_PAGES;loop++) mSystem.mTopPageHandlers[loop]=mSystem.mRam;
+   mSystem.mVectorHandler=mSystem.mRam;
 
    mSusieEnabled=-1;
    mMikieEnabled=-1;
@@ -140,57 +138,36 @@ bool CMemMap::ContextLoad(LSS_FILE *fp)
 
 inline void CMemMap::Poke(ULONG addr, UBYTE data)
 {
-   int newstate,loop;
+   int newstate;
 
    // FC00-FCFF Susie area
    newstate=(data&0x01)?FALSE:TRUE;
    if(newstate!=mSusieEnabled) {
       mSusieEnabled=newstate;
-
-      if(mSusieEnabled) {
-         for(loop=SUSIE_START;loop<SUSIE_START+SUSIE_SIZE;loop++) mSystem.mMemoryHandlers[loop]=mSystem.mSusie;
-      } else {
-         for(loop=SUSIE_START;loop<SUSIE_START+SUSIE_SIZE;loop++) mSystem.mMemoryHandlers[loop]=mSystem.mRam;
-      }
+      mSystem.mTopPageHandlers[(SUSIE_START>>8)&(TOP_PAGES-1)]=mSusieEnabled?(CLynxBase*)mSystem.mSusie:(CLynxBase*)mSystem.mRam;
    }
 
    // FD00-FCFF Mikie area
    newstate=(data&0x02)?FALSE:TRUE;
    if(newstate!=mMikieEnabled) {
       mMikieEnabled=newstate;
-
-      if(mMikieEnabled) {
-         for(loop=MIKIE_START;loop<MIKIE_START+MIKIE_SIZE;loop++) mSystem.mMemoryHandlers[loop]=mSystem.mMikie;
-      } else {
-         for(loop=MIKIE_START;loop<MIKIE_START+MIKIE_SIZE;loop++) mSystem.mMemoryHandlers[loop]=mSystem.mRam;
-      }
+      mSystem.mTopPageHandlers[(MIKIE_START>>8)&(TOP_PAGES-1)]=mMikieEnabled?(CLynxBase*)mSystem.mMikie:(CLynxBase*)mSystem.mRam;
    }
 
-   // FE00-FFF7 Rom area
+   // FE00-FFF7 Rom area, two pages
    newstate=(data&0x04)?FALSE:TRUE;
    if(newstate!=mRomEnabled) {
       mRomEnabled=newstate;
-
-      if(mRomEnabled) {
-         for(loop=BROM_START;loop<BROM_START+(BROM_SIZE-8);loop++) mSystem.mMemoryHandlers[loop]=mSystem.mRom;
-      } else {
-         for(loop=BROM_START;loop<BROM_START+(BROM_SIZE-8);loop++) mSystem.mMemoryHandlers[loop]=mSystem.mRam;
-      }
+      mSystem.mTopPageHandlers[(BROM_START>>8)&(TOP_PAGES-1)]=mRomEnabled?(CLynxBase*)mSystem.mRom:(CLynxBase*)mSystem.mRam;
+      mSystem.mTopPageHandlers[((BROM_START>>8)+1)&(TOP_PAGES-1)]=mRomEnabled?(CLynxBase*)mSystem.mRom:(CLynxBase*)mSystem.mRam;
    }
 
    // FFFA-FFFF Vector area - Overload ROM space
    newstate=(data&0x08)?FALSE:TRUE;
    if(newstate!=mVectorsEnabled) {
       mVectorsEnabled=newstate;
-
-      if(mVectorsEnabled) {
-         for(loop=VECTOR_START;loop<VECTOR_START+VECTOR_SIZE;loop++) mSystem.mMemoryHandlers[loop]=mSystem.mRom;
-      } else {
-         for(loop=VECTOR_START;loop<VECTOR_START+VECTOR_SIZE;loop++) mSystem.mMemoryHandlers[loop]=mSystem.mRam;
-      }
+      mSystem.mVectorHandler=mVectorsEnabled?(CLynxBase*)mSystem.mRom:(CLynxBase*)mSystem.mRam;
    }
-
-
 }
 
 inline UBYTE CMemMap::Peek(ULONG addr)
@@ -56,6 +56,23 @@
 #include "lynxdef.h"
 #include "handy.h"
 
+// SSSE3 is only used by functions built for it and picked at run time, the
+// rest of the core still runs on any x86
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HANDY_DISPLAY_SSSE3 1
+#include <tmmintrin.h>
+#else
+#define HANDY_DISPLAY_SSSE3 0
+#endif
+
+// Every AArch64 CPU has NEON, and vqtbl1q_u8() is AArch64 only
+#if defined(__aarch64__) && defined(__ARM_NEON) && !defined(__AARCH64EB__)
+#define HANDY_DISPLAY_NEON 1
+#include <arm_neon.h>
+#else
+#define HANDY_DISPLAY_NEON 0
+#endif
+
 inline void CMikie::SetCPUSleep(void) 
 { 
    mSystem.mSystemCPUSleep = TRUE; 
@@ -89,11 +106,17 @@ CMikie::CMikie(CSystem &parent)
    mDisplayRotate = MIKIE_BAD_MODE;
    mDisplayFormat = MIKIE_PIXEL_FORMAT_16BPP_555;
    mpDisplayCallback = NULL;
+   mpDisplayLine = NULL;
+   mDisplaySimd = TRUE;
    mDisplayCallbackObject = 0;
 
    mUART_CABLE_PRESENT = FALSE;
    mpUART_TX_CALLBACK = nullptr;
 
+   mDisplayDirty = TRUE;
+   mDisplayGeneration = 1;
+   memset(mDisplayShadowGeneration, 0, sizeof(mDisplayShadowGeneration));
+
    int loop;
    for (loop = 0; loop < 16; loop++) {
       mPalette[loop].Index = loop;
@@ -122,6 +145,7 @@ void CMikie::Reset(void)
    mLynxLine = 0;
    mLynxLineDMACounter = 0;
    mLynxAddr = 0;
+   mDisplayGeneration++;
 
    mTimerStatusFlags = 0x00; // Initialises to ZERO, i.e No IRQ's
    mTimerInterruptMask = 0x00;
@@ -299,6 +323,7 @@ void CMikie::Reset(void)
 
    for (int loop = 0; loop < 16; loop++) {
       mPalette[loop].Index = loop;
+      DisplayResolvePen(loop);
    }
 
    // Initialise IODAT register
@@ -314,6 +339,7 @@ void CMikie::Reset(void)
    mDISPCTL_Flip = FALSE;
    mDISPCTL_FourColour = 0;
    mDISPCTL_Colour = 0;
+   DisplaySelectLine();
 
    //
    // Initialise the UART variables
@@ -574,12 +600,16 @@ bool CMikie::ContextLoad(LSS_FILE *fp)
    if(!lss_read(teststr,sizeof(char),19,fp)) return 0;
    if(strcmp(teststr,"CMikie::ContextSave")!=0) return 0;
 
+   // Whatever is on screen has nothing to do with the loaded state
+   mDisplayGeneration++;
+
    if(!lss_read(&mDisplayAddress,sizeof(ULONG),1,fp)) return 0;
    if(!lss_read(&mAudioInputComparator,sizeof(ULONG),1,fp)) return 0;
    if(!lss_read(&mTimerStatusFlags,sizeof(ULONG),1,fp)) return 0;
    if(!lss_read(&mTimerInterruptMask,sizeof(ULONG),1,fp)) return 0;
 
    if(!lss_read(mPalette,sizeof(TPALETTE),16,fp)) return 0;
+   for(int pen=0;pen<16;pen++) DisplayResolvePen(pen);
 
    if(!lss_read(&mIODAT,sizeof(ULONG),1,fp)) return 0;
    if(!lss_read(&mIODAT_REST_SIGNAL,sizeof(ULONG),1,fp)) return 0;
@@ -589,6 +619,7 @@ bool CMikie::ContextLoad(LSS_FILE *fp)
    if(!lss_read(&mDISPCTL_Flip,sizeof(ULONG),1,fp)) return 0;
    if(!lss_read(&mDISPCTL_FourColour,sizeof(ULONG),1,fp)) return 0;
    if(!lss_read(&mDISPCTL_Colour,sizeof(ULONG),1,fp)) return 0;
+   DisplaySelectLine();
 
    if(!lss_read(&mTIM_0_BKUP,sizeof(ULONG),1,fp)) return 0;
    if(!lss_read(&mTIM_0_ENABLE_RELOAD,sizeof(ULONG),1,fp)) return 0;
@@ -792,6 +823,7 @@ void CMikie::PresetForHomebrew(void)
    mDISPCTL_Flip=FALSE;
    mDISPCTL_FourColour=0;
    mDISPCTL_Colour=TRUE;
+   DisplaySelectLine();
 }
 
 void CMikie::ComLynxCable(int status)
@@ -830,7 +862,7 @@ void CMikie::ComLynxTxLoopback(int data)
    }
 }
 
-void CMikie::ComLynxTxCallback(void (*function)(int data,ULONG objref),ULONG objref)
+void CMikie::ComLynxTxCallback(CMikie::ComLynxCallback function,ULONG objref)
 {
    mpUART_TX_CALLBACK=function;
    mUART_TX_CALLBACK_OBJECT=objref;
@@ -844,8 +876,10 @@ void CMikie::DisplaySetAttributes(ULONG rotate, ULONG format, ULONG pitch, CMiki
    mDisplayPitch = pitch;
    mpDisplayCallback = callback;
    mDisplayCallbackObject = objref;
+   mDisplayGeneration++;
 
    mpDisplayCurrent=NULL;
+   DisplaySelectLine();
 
    if(mpDisplayCallback) {
       mpDisplayBits = mpDisplayCallback(mDisplayCallbackObject);
@@ -900,6 +934,7 @@ void CMikie::DisplaySetAttributes(ULONG rotate, ULONG format, ULONG pitch, CMiki
          for(Spot.Index=0;Spot.Index<4096;Spot.Index++) mColourMap[Spot.Index]=0;
          break;
    }
+   for(int pen=0;pen<16;pen++) DisplayResolvePen(pen);
 
    // Reset screen related counters/vars
    mTIM_0_CURRENT=0;
@@ -914,10 +949,317 @@ void CMikie::DisplaySetAttributes(ULONG rotate, ULONG format, ULONG pitch, CMiki
 }
 
 
+// One pixel of 'size' bytes. 24 bit pixels go towards lower addresses
+// with the screen upside down, like the rest of the line.
+template<int size,bool backwards>
+static inline void DisplayPixel(UBYTE *bitmap,ULONG pixel)
+{
+   if(size==1) {
+      *bitmap=(UBYTE)pixel;
+   } else if(size==2) {
+      *((UWORD*)bitmap)=(UWORD)pixel;
+   } else if(size==4) {
+      *((ULONG*)bitmap)=pixel;
+   } else if(backwards) {
+      bitmap[0]=(UBYTE)pixel;
+      bitmap[-1]=(UBYTE)(pixel>>8);
+      bitmap[-2]=(UBYTE)(pixel>>16);
+   } else {
+      bitmap[0]=(UBYTE)pixel;
+      bitmap[1]=(UBYTE)(pixel>>8);
+      bitmap[2]=(UBYTE)(pixel>>16);
+   }
+}
+
+// Renders the line at mLynxAddr to mpDisplayCurrent and moves both on to
+// the next one. A flipped screen is read backwards, lower nibble first.
+// Like Mikey's own address counter, reads wrap around the 64K of RAM.
+template<ULONG rotate,int size,bool flip>
+void CMikie::DisplayLine(void)
+{
+   // How far apart the pixels of the line are in the bitmap
+   ptrdiff_t const pitch=mDisplayPitch;
+   ptrdiff_t const step=(rotate==MIKIE_NO_ROTATE)?size:
+                        (rotate==MIKIE_ROTATE_L)?pitch:
+                        (rotate==MIKIE_ROTATE_B)?-size:-pitch;
+   bool const backwards=rotate==MIKIE_ROTATE_B;
+
+   UBYTE *bitmap=mpDisplayCurrent;
+   ULONG const addr=mLynxAddr;
+   for(ULONG loop=0;loop<SCREEN_WIDTH/2;loop++) {
+      ULONG const source=mpRamPointer[(flip?addr-loop:addr+loop)&0xffff];
+      DisplayPixel<size,backwards>(bitmap,mDisplayPalette[flip?source&0x0f:source>>4]);
+      bitmap+=step;
+      DisplayPixel<size,backwards>(bitmap,mDisplayPalette[flip?source>>4:source&0x0f]);
+      bitmap+=step;
+   }
+   mLynxAddr=flip?addr-SCREEN_WIDTH/2:addr+SCREEN_WIDTH/2;
+
+   // And the lines
+   mpDisplayCurrent+=(rotate==MIKIE_NO_ROTATE)?pitch:
+                     (rotate==MIKIE_ROTATE_L)?-size:
+                     (rotate==MIKIE_ROTATE_B)?-pitch:size;
+}
+
+#if HANDY_DISPLAY_SSSE3
+// Sixteen pens to 16 or 32 bit pixels, looking every byte of the pixels
+// up in the palette at once
+template<int size>
+__attribute__((target("ssse3")))
+static inline void DisplayPensSsse3(UBYTE *bitmap,__m128i pens,const __m128i *palette)
+{
+   __m128i const byte0=_mm_shuffle_epi8(palette[0],pens);
+   __m128i const byte1=_mm_shuffle_epi8(palette[1],pens);
+   __m128i const low=_mm_unpacklo_epi8(byte0,byte1);
+   __m128i const high=_mm_unpackhi_epi8(byte0,byte1);
+   if(size==2) {
+      _mm_storeu_si128((__m128i*)bitmap,low);
+      _mm_storeu_si128((__m128i*)(bitmap+16),high);
+   } else {
+      __m128i const byte2=_mm_shuffle_epi8(palette[2],pens);
+      __m128i const byte3=_mm_shuffle_epi8(palette[3],pens);
+      __m128i const low23=_mm_unpacklo_epi8(byte2,byte3);
+      __m128i const high23=_mm_unpackhi_epi8(byte2,byte3);
+      _mm_storeu_si128((__m128i*)bitmap,_mm_unpacklo_epi16(low,low23));
+      _mm_storeu_si128((__m128i*)(bitmap+16),_mm_unpackhi_epi16(low,low23));
+      _mm_storeu_si128((__m128i*)(bitmap+32),_mm_unpacklo_epi16(high,high23));
+      _mm_storeu_si128((__m128i*)(bitmap+48),_mm_unpackhi_epi16(high,high23));
+   }
+}
+
+// DisplayLine() for an unrotated screen, 32 pixels at a time
+template<int size,bool flip>
+__attribute__((target("ssse3")))
+void CMikie::DisplayLineSsse3(void)
+{
+   ULONG const addr=mLynxAddr;
+   ULONG const start=flip?addr-(SCREEN_WIDTH/2-1):addr;
+   if(start>RAM_SIZE-SCREEN_WIDTH/2) {
+      // Wraps around the end of RAM
+      DisplayLine<MIKIE_NO_ROTATE,size,flip>();
+      return;
+   }
+
+   __m128i palette[4];
+   for(int loop=0;loop<size;loop++) palette[loop]=_mm_loadu_si128((const __m128i*)mDisplayPaletteBytes[loop]);
+   __m128i const nibble=_mm_set1_epi8(0x0f);
+   __m128i const reverse=_mm_setr_epi8(15,14,13,12,11,10,9,8,7,6,5,4,3,2,1,0);
+
+   UBYTE *bitmap=mpDisplayCurrent;
+   const UBYTE *source=mpRamPointer+start;
+   for(int loop=0;loop<SCREEN_WIDTH/2;loop+=16) {
+      __m128i bytes;
+      if(flip) {
+         bytes=_mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(source+SCREEN_WIDTH/2-16-loop)),reverse);
+      } else {
+         bytes=_mm_loadu_si128((const __m128i*)(source+loop));
+      }
+      __m128i const upper=_mm_and_si128(_mm_srli_epi16(bytes,4),nibble);
+      __m128i const lower=_mm_and_si128(bytes,nibble);
+      DisplayPensSsse3<size>(bitmap,flip?_mm_unpacklo_epi8(lower,upper):_mm_unpacklo_epi8(upper,lower),palette);
+      bitmap+=16*size;
+      DisplayPensSsse3<size>(bitmap,flip?_mm_unpackhi_epi8(lower,upper):_mm_unpackhi_epi8(upper,lower),palette);
+      bitmap+=16*size;
+   }
+   mLynxAddr=flip?addr-SCREEN_WIDTH/2:addr+SCREEN_WIDTH/2;
+   mpDisplayCurrent+=mDisplayPitch;
+}
+
+#endif
+
+#if HANDY_DISPLAY_NEON
+// The same with NEON table lookups. vst2q_u8() and vst4q_u8() put the
+// bytes of each pixel back together as they store them.
+template<int size>
+static inline void DisplayPensNeon(UBYTE *bitmap,uint8x16_t pens,const uint8x16_t *palette)
+{
+   if(size==2) {
+      uint8x16x2_t pixels;
+      pixels.val[0]=vqtbl1q_u8(palette[0],pens);
+      pixels.val[1]=vqtbl1q_u8(palette[1],pens);
+      vst2q_u8(bitmap,pixels);
+   } else {
+      uint8x16x4_t pixels;
+      pixels.val[0]=vqtbl1q_u8(palette[0],pens);
+      pixels.val[1]=vqtbl1q_u8(palette[1],pens);
+      pixels.val[2]=vqtbl1q_u8(palette[2],pens);
+      pixels.val[3]=vqtbl1q_u8(palette[3],pens);
+      vst4q_u8(bitmap,pixels);
+   }
+}
+
+template<int size,bool flip>
+void CMikie::DisplayLineNeon(void)
+{
+   ULONG const addr=mLynxAddr;
+   ULONG const start=flip?addr-(SCREEN_WIDTH/2-1):addr;
+   if(start>RAM_SIZE-SCREEN_WIDTH/2) {
+      // Wraps around the end of RAM
+      DisplayLine<MIKIE_NO_ROTATE,size,flip>();
+      return;
+   }
+
+   uint8x16_t palette[4];
+   for(int loop=0;loop<size;loop++) palette[loop]=vld1q_u8(mDisplayPaletteBytes[loop]);
+   uint8x16_t const nibble=vdupq_n_u8(0x0f);
+
+   UBYTE *bitmap=mpDisplayCurrent;
+   const UBYTE *source=mpRamPointer+start;
+   for(int loop=0;loop<SCREEN_WIDTH/2;loop+=16) {
+      uint8x16_t bytes;
+      if(flip) {
+         bytes=vrev64q_u8(vld1q_u8(source+SCREEN_WIDTH/2-16-loop));
+         bytes=vextq_u8(bytes,bytes,8);
+      } else {
+         bytes=vld1q_u8(source+loop);
+      }
+      uint8x16_t const upper=vshrq_n_u8(bytes,4);
+      uint8x16_t const lower=vandq_u8(bytes,nibble);
+      DisplayPensNeon<size>(bitmap,flip?vzip1q_u8(lower,upper):vzip1q_u8(upper,lower),palette);
+      bitmap+=16*size;
+      DisplayPensNeon<size>(bitmap,flip?vzip2q_u8(lower,upper):vzip2q_u8(upper,lower),palette);
+      bitmap+=16*size;
+   }
+   mLynxAddr=flip?addr-SCREEN_WIDTH/2:addr+SCREEN_WIDTH/2;
+   mpDisplayCurrent+=mDisplayPitch;
+}
+#endif
+
+bool CMikie::DisplayHasSimd(void)
+{
+#if HANDY_DISPLAY_SSSE3
+   static bool const has=__builtin_cpu_supports("ssse3");
+   return has;
+#elif HANDY_DISPLAY_NEON
+   return TRUE;
+#else
+   return FALSE;
+#endif
+}
+
+// The SIMD line renderer for an unrotated screen, if there is one
+CMikie::TDisplayLine CMikie::DisplaySimdLine(int size,bool flip)
+{
+#if HANDY_DISPLAY_SSSE3
+   if(DisplayHasSimd()) {
+      if(size==2) return flip?&CMikie::DisplayLineSsse3<2,true>:&CMikie::DisplayLineSsse3<2,false>;
+      if(size==4) return flip?&CMikie::DisplayLineSsse3<4,true>:&CMikie::DisplayLineSsse3<4,false>;
+   }
+#elif HANDY_DISPLAY_NEON
+   if(size==2) return flip?&CMikie::DisplayLineNeon<2,true>:&CMikie::DisplayLineNeon<2,false>;
+   if(size==4) return flip?&CMikie::DisplayLineNeon<4,true>:&CMikie::DisplayLineNeon<4,false>;
+#endif
+   return NULL;
+}
+
+#define DISPLAY_LINES(rotate)	{ { &CMikie::DisplayLine<rotate,1,false>, &CMikie::DisplayLine<rotate,1,true> }, \
+                                  { &CMikie::DisplayLine<rotate,2,false>, &CMikie::DisplayLine<rotate,2,true> }, \
+                                  { &CMikie::DisplayLine<rotate,3,false>, &CMikie::DisplayLine<rotate,3,true> }, \
+                                  { &CMikie::DisplayLine<rotate,4,false>, &CMikie::DisplayLine<rotate,4,true> } }
+
+const CMikie::TDisplayLine CMikie::mDisplayLines[4][4][2]={
+   DISPLAY_LINES(MIKIE_NO_ROTATE),
+   DISPLAY_LINES(MIKIE_ROTATE_L),
+   DISPLAY_LINES(MIKIE_ROTATE_B),
+   DISPLAY_LINES(MIKIE_ROTATE_R)
+};
+
+// Picks the line renderer for the rotation, format and flip, none for a
+// rotation or format it doesn't know
+void CMikie::DisplaySelectLine(void)
+{
+   int size=0;
+   switch(mDisplayFormat) {
+      case MIKIE_PIXEL_FORMAT_8BPP:
+         size=1;
+         break;
+      case MIKIE_PIXEL_FORMAT_16BPP_BGR555:
+      case MIKIE_PIXEL_FORMAT_16BPP_555:
+      case MIKIE_PIXEL_FORMAT_16BPP_565:
+         size=2;
+         break;
+      case MIKIE_PIXEL_FORMAT_24BPP:
+         size=3;
+         break;
+      case MIKIE_PIXEL_FORMAT_32BPP:
+         size=4;
+         break;
+      default:
+         break;
+   }
+
+   if(!size || mDisplayRotate<MIKIE_NO_ROTATE || mDisplayRotate>MIKIE_ROTATE_R) {
+      mpDisplayLine=NULL;
+   } else {
+      mpDisplayLine=mDisplayLines[mDisplayRotate-MIKIE_NO_ROTATE][size-1][mDISPCTL_Flip?1:0];
+   }
+
+   if(mpDisplayLine && mDisplaySimd && mDisplayRotate==MIKIE_NO_ROTATE) {
+      TDisplayLine const simd=DisplaySimdLine(size,mDISPCTL_Flip);
+      if(simd) mpDisplayLine=simd;
+   }
+}
+
+bool CMikie::DisplayCheckSimd(ULONG addr)
+{
+   int size=0;
+   switch(mDisplayFormat) {
+      case MIKIE_PIXEL_FORMAT_16BPP_BGR555:
+      case MIKIE_PIXEL_FORMAT_16BPP_555:
+      case MIKIE_PIXEL_FORMAT_16BPP_565:
+         size=2;
+         break;
+      case MIKIE_PIXEL_FORMAT_32BPP:
+         size=4;
+         break;
+      default:
+         break;
+   }
+
+   UBYTE *const current=mpDisplayCurrent;
+   ULONG const lynx_addr=mLynxAddr;
+   bool same=TRUE;
+   for(int flip=0;flip<2;flip++) {
+      TDisplayLine const simd=DisplaySimdLine(size,flip);
+      if(!simd) continue;
+
+      // Different fills so a pixel neither wrote can't pass either
+      UBYTE expected[SCREEN_WIDTH*4];
+      UBYTE got[SCREEN_WIDTH*4];
+      memset(expected,0x55,sizeof(expected));
+      memset(got,0xaa,sizeof(got));
+
+      mpDisplayCurrent=expected;
+      mLynxAddr=addr;
+      (this->*mDisplayLines[0][size-1][flip])();
+      ULONG const next=mLynxAddr;
+
+      mpDisplayCurrent=got;
+      mLynxAddr=addr;
+      (this->*simd)();
+      if(mLynxAddr!=next || memcmp(expected,got,SCREEN_WIDTH*size)) same=FALSE;
+   }
+   mpDisplayCurrent=current;
+   mLynxAddr=lynx_addr;
+   return same;
+}
+
+void CMikie::SetDisplaySimd(bool simd)
+{
+   mDisplaySimd=simd;
+   DisplaySelectLine();
+}
+
+// Looks the pen's colour up again after it or the colour map changed
+void CMikie::DisplayResolvePen(ULONG pen)
+{
+   ULONG const pixel=mColourMap[mPalette[pen].Index];
+   mDisplayPalette[pen]=pixel;
+   for(int loop=0;loop<4;loop++) mDisplayPaletteBytes[loop][pen]=(UBYTE)(pixel>>(8*loop));
+}
+
 ULONG CMikie::DisplayRenderLine(void)
 {
-   UBYTE *bitmap_tmp=NULL;
-   ULONG source,loop;
    ULONG work_done=0;
 
    if(!mpDisplayBits) return 0;
@@ -965,386 +1307,23 @@ ULONG CMikie::DisplayRenderLine(void)
       if(mSystem.mSkipFrame)
          return work_done;
 
+      // Check whether this line will look any different from last time
+      {
+         ULONG line=(SCREEN_HEIGHT-1)-mLynxLineDMACounter;
+         ULONG start=mDISPCTL_Flip?mLynxAddr-(SCREEN_WIDTH/2-1):mLynxAddr;
+         if(start+SCREEN_WIDTH/2>RAM_SIZE) {
+            mDisplayShadowGeneration[line]=0;
+            mDisplayDirty=TRUE;
+         } else if(mDisplayShadowGeneration[line]!=mDisplayGeneration || memcmp(mDisplayShadow[line],mpRamPointer+start,SCREEN_WIDTH/2)) {
+            memcpy(mDisplayShadow[line],mpRamPointer+start,SCREEN_WIDTH/2);
+            mDisplayShadowGeneration[line]=mDisplayGeneration;
+            mDisplayDirty=TRUE;
+         }
+      }
+
       // Mikie screen DMA can only see the system RAM....
       // (Step through bitmap, line at a time)
-
-      // Assign the temporary pointer;
-      bitmap_tmp=mpDisplayCurrent;
-
-      switch(mDisplayRotate) {
-         case MIKIE_NO_ROTATE:
-            if(mDisplayFormat==MIKIE_PIXEL_FORMAT_8BPP) {
-               for(loop=0;loop<SCREEN_WIDTH/2;loop++) {
-                  source=mpRamPointer[mLynxAddr];
-                  if(mDISPCTL_Flip) {
-                     mLynxAddr--;
-                     *(bitmap_tmp)=(UBYTE)mColourMap[mPalette[source&0x0f].Index];
-                     bitmap_tmp+=sizeof(UBYTE);
-                     *(bitmap_tmp)=(UBYTE)mColourMap[mPalette[source>>4].Index];
-                     bitmap_tmp+=sizeof(UBYTE);
-                  } else {
-                     mLynxAddr++;
-                     *(bitmap_tmp)=(UBYTE)mColourMap[mPalette[source>>4].Index];
-                     bitmap_tmp+=sizeof(UBYTE);
-                     *(bitmap_tmp)=(UBYTE)mColourMap[mPalette[source&0x0f].Index];
-                     bitmap_tmp+=sizeof(UBYTE);
-                  }
-               }
-            } else if(mDisplayFormat==MIKIE_PIXEL_FORMAT_16BPP_BGR555 || mDisplayFormat==MIKIE_PIXEL_FORMAT_16BPP_555 || mDisplayFormat==MIKIE_PIXEL_FORMAT_16BPP_565) {
-               for(loop=0;loop<SCREEN_WIDTH/2;loop++) {
-                  source=mpRamPointer[mLynxAddr];
-                  if(mDISPCTL_Flip) {
-                     mLynxAddr--;
-                     *((UWORD*)(bitmap_tmp))=(UWORD)mColourMap[mPalette[source&0x0f].Index];
-                     bitmap_tmp+=sizeof(UWORD);
-                     *((UWORD*)(bitmap_tmp))=(UWORD)mColourMap[mPalette[source>>4].Index];
-                     bitmap_tmp+=sizeof(UWORD);
-                  } else {
-                     mLynxAddr++;
-                     *((UWORD*)(bitmap_tmp))=(UWORD)mColourMap[mPalette[source>>4].Index];
-                     bitmap_tmp+=sizeof(UWORD);
-                     *((UWORD*)(bitmap_tmp))=(UWORD)mColourMap[mPalette[source&0x0f].Index];
-                     bitmap_tmp+=sizeof(UWORD);
-                  }
-               }
-            } else if(mDisplayFormat==MIKIE_PIXEL_FORMAT_24BPP) {
-               ULONG pixel;
-               for(loop=0;loop<SCREEN_WIDTH/2;loop++) {
-                  source=mpRamPointer[mLynxAddr];
-                  if(mDISPCTL_Flip) {
-                     mLynxAddr--;
-                     pixel=mColourMap[mPalette[source&0x0f].Index];
-                     *bitmap_tmp++=(UBYTE)pixel;
-                     pixel>>=8;
-                     *bitmap_tmp++=(UBYTE)pixel;
-                     pixel>>=8;
-                     *bitmap_tmp++=(UBYTE)pixel;
-                     pixel=mColourMap[mPalette[source>>4].Index];
-                     *bitmap_tmp++=(UBYTE)pixel;
-                     pixel>>=8;
-                     *bitmap_tmp++=(UBYTE)pixel;
-                     pixel>>=8;
-                     *bitmap_tmp++=(UBYTE)pixel;
-                  } else {
-                     mLynxAddr++;
-                     pixel=mColourMap[mPalette[source>>4].Index];
-                     *bitmap_tmp++=(UBYTE)pixel;
-                     pixel>>=8;
-                     *bitmap_tmp++=(UBYTE)pixel;
-                     pixel>>=8;
-                     *bitmap_tmp++=(UBYTE)pixel;
-                     pixel=mColourMap[mPalette[source&0x0f].Index];
-                     *bitmap_tmp++=(UBYTE)pixel;
-                     pixel>>=8;
-                     *bitmap_tmp++=(UBYTE)pixel;
-                     pixel>>=8;
-                     *bitmap_tmp++=(UBYTE)pixel;
-                  }
-               }
-            } else if(mDisplayFormat==MIKIE_PIXEL_FORMAT_32BPP) {
-               for(loop=0;loop<SCREEN_WIDTH/2;loop++) {
-                  source=mpRamPointer[mLynxAddr];
-                  if(mDISPCTL_Flip) {
-                     mLynxAddr--;
-                     *((ULONG*)(bitmap_tmp))=mColourMap[mPalette[source&0x0f].Index];
-                     bitmap_tmp+=sizeof(ULONG);
-                     *((ULONG*)(bitmap_tmp))=mColourMap[mPalette[source>>4].Index];
-                     bitmap_tmp+=sizeof(ULONG);
-                  } else {
-                     mLynxAddr++;
-                     *((ULONG*)(bitmap_tmp))=mColourMap[mPalette[source>>4].Index];
-                     bitmap_tmp+=sizeof(ULONG);
-                     *((ULONG*)(bitmap_tmp))=mColourMap[mPalette[source&0x0f].Index];
-                     bitmap_tmp+=sizeof(ULONG);
-                  }
-               }
-            }
-            mpDisplayCurrent+=mDisplayPitch;
-            break;
-         case MIKIE_ROTATE_L:
-            if(mDisplayFormat==MIKIE_PIXEL_FORMAT_8BPP) {
-               for(loop=0;loop<SCREEN_WIDTH/2;loop++) {
-                  source=mpRamPointer[mLynxAddr];
-                  if(mDISPCTL_Flip) {
-                     mLynxAddr--;
-                     *(bitmap_tmp)=(UBYTE)mColourMap[mPalette[source&0x0f].Index];
-                     bitmap_tmp+=mDisplayPitch;
-                     *(bitmap_tmp)=(UBYTE)mColourMap[mPalette[source>>4].Index];
-                     bitmap_tmp+=mDisplayPitch;
-                  } else {
-                     mLynxAddr++;
-                     *(bitmap_tmp)=(UBYTE)mColourMap[mPalette[source>>4].Index];
-                     bitmap_tmp+=mDisplayPitch;
-                     *(bitmap_tmp)=(UBYTE)mColourMap[mPalette[source&0x0f].Index];
-                     bitmap_tmp+=mDisplayPitch;
-                  }
-               }
-               mpDisplayCurrent-=sizeof(UBYTE);
-            } else if(mDisplayFormat==MIKIE_PIXEL_FORMAT_16BPP_BGR555 || mDisplayFormat==MIKIE_PIXEL_FORMAT_16BPP_555 || mDisplayFormat==MIKIE_PIXEL_FORMAT_16BPP_565) {
-               for(loop=0;loop<SCREEN_WIDTH/2;loop++) {
-                  source=mpRamPointer[mLynxAddr];
-                  if(mDISPCTL_Flip) {
-                     mLynxAddr--;
-                     *((UWORD*)(bitmap_tmp))=(UWORD)mColourMap[mPalette[source&0x0f].Index];
-                     bitmap_tmp+=mDisplayPitch;
-                     *((UWORD*)(bitmap_tmp))=(UWORD)mColourMap[mPalette[source>>4].Index];
-                     bitmap_tmp+=mDisplayPitch;
-                  } else {
-                     mLynxAddr++;
-                     *((UWORD*)(bitmap_tmp))=(UWORD)mColourMap[mPalette[source>>4].Index];
-                     bitmap_tmp+=mDisplayPitch;
-                     *((UWORD*)(bitmap_tmp))=(UWORD)mColourMap[mPalette[source&0x0f].Index];
-                     bitmap_tmp+=mDisplayPitch;
-                  }
-               }
-               mpDisplayCurrent-=sizeof(UWORD);
-            } else if(mDisplayFormat==MIKIE_PIXEL_FORMAT_24BPP) {
-               ULONG pixel;
-               for(loop=0;loop<SCREEN_WIDTH/2;loop++) {
-                  source=mpRamPointer[mLynxAddr];
-                  if(mDISPCTL_Flip) {
-                     mLynxAddr--;
-                     pixel=mColourMap[mPalette[source&0x0f].Index];
-                     *(bitmap_tmp)=(UBYTE)pixel;
-                     pixel>>=8;
-                     *(bitmap_tmp+1)=(UBYTE)pixel;
-                     pixel>>=8;
-                     *(bitmap_tmp+2)=(UBYTE)pixel;
-                     bitmap_tmp+=mDisplayPitch;
-                     pixel=mColourMap[mPalette[source>>4].Index];
-                     *(bitmap_tmp)=(UBYTE)pixel;
-                     pixel>>=8;
-                     *(bitmap_tmp+1)=(UBYTE)pixel;
-                     pixel>>=8;
-                     *(bitmap_tmp+2)=(UBYTE)pixel;
-                     bitmap_tmp+=mDisplayPitch;
-                  } else {
-                     mLynxAddr++;
-                     pixel=mColourMap[mPalette[source>>4].Index];
-                     *(bitmap_tmp)=(UBYTE)pixel;
-                     pixel>>=8;
-                     *(bitmap_tmp+1)=(UBYTE)pixel;
-                     pixel>>=8;
-                     *(bitmap_tmp+2)=(UBYTE)pixel;
-                     bitmap_tmp+=mDisplayPitch;
-                     pixel=mColourMap[mPalette[source&0x0f].Index];
-                     *(bitmap_tmp)=(UBYTE)pixel;
-                     pixel>>=8;
-                     *(bitmap_tmp+1)=(UBYTE)pixel;
-                     pixel>>=8;
-                     *(bitmap_tmp+2)=(UBYTE)pixel;
-                     bitmap_tmp+=mDisplayPitch;
-                  }
-               }
-               mpDisplayCurrent-=3;
-            } else if(mDisplayFormat==MIKIE_PIXEL_FORMAT_32BPP) {
-               for(loop=0;loop<SCREEN_WIDTH/2;loop++) {
-                  source=mpRamPointer[mLynxAddr];
-                  if(mDISPCTL_Flip) {
-                     mLynxAddr--;
-                     *((ULONG*)(bitmap_tmp))=mColourMap[mPalette[source&0x0f].Index];
-                     bitmap_tmp+=mDisplayPitch;
-                     *((ULONG*)(bitmap_tmp))=mColourMap[mPalette[source>>4].Index];
-                     bitmap_tmp+=mDisplayPitch;
-                  } else {
-                     mLynxAddr++;
-                     *((ULONG*)(bitmap_tmp))=mColourMap[mPalette[source>>4].Index];
-                     bitmap_tmp+=mDisplayPitch;
-                     *((ULONG*)(bitmap_tmp))=mColourMap[mPalette[source&0x0f].Index];
-                     bitmap_tmp+=mDisplayPitch;
-                  }
-               }
-               mpDisplayCurrent-=sizeof(ULONG);
-            }
-            break;
-         case MIKIE_ROTATE_B:
-            if(mDisplayFormat==MIKIE_PIXEL_FORMAT_8BPP) {
-               for(loop=0;loop<SCREEN_WIDTH/2;loop++) {
-                  source=mpRamPointer[mLynxAddr];
-                  if(mDISPCTL_Flip) {
-                     mLynxAddr--;
-                     *(bitmap_tmp)=(UBYTE)mColourMap[mPalette[source&0x0f].Index];
-                     bitmap_tmp-=sizeof(UBYTE);
-                     *(bitmap_tmp)=(UBYTE)mColourMap[mPalette[source>>4].Index];
-                     bitmap_tmp-=sizeof(UBYTE);
-                  } else {
-                     mLynxAddr++;
-                     *(bitmap_tmp)=(UBYTE)mColourMap[mPalette[source>>4].Index];
-                     bitmap_tmp-=sizeof(UBYTE);
-                     *(bitmap_tmp)=(UBYTE)mColourMap[mPalette[source&0x0f].Index];
-                     bitmap_tmp-=sizeof(UBYTE);
-                  }
-               }
-            } else if(mDisplayFormat==MIKIE_PIXEL_FORMAT_16BPP_BGR555 || mDisplayFormat==MIKIE_PIXEL_FORMAT_16BPP_555 || mDisplayFormat==MIKIE_PIXEL_FORMAT_16BPP_565) {
-               for(loop=0;loop<SCREEN_WIDTH/2;loop++) {
-                  source=mpRamPointer[mLynxAddr];
-                  if(mDISPCTL_Flip) {
-                     mLynxAddr--;
-                     *((UWORD*)(bitmap_tmp))=(UWORD)mColourMap[mPalette[source&0x0f].Index];
-                     bitmap_tmp-=sizeof(UWORD);
-                     *((UWORD*)(bitmap_tmp))=(UWORD)mColourMap[mPalette[source>>4].Index];
-                     bitmap_tmp-=sizeof(UWORD);
-                  } else {
-                     mLynxAddr++;
-                     *((UWORD*)(bitmap_tmp))=(UWORD)mColourMap[mPalette[source>>4].Index];
-                     bitmap_tmp-=sizeof(UWORD);
-                     *((UWORD*)(bitmap_tmp))=(UWORD)mColourMap[mPalette[source&0x0f].Index];
-                     bitmap_tmp-=sizeof(UWORD);
-                  }
-               }
-            } else if(mDisplayFormat==MIKIE_PIXEL_FORMAT_24BPP) {
-               ULONG pixel;
-               for(loop=0;loop<SCREEN_WIDTH/2;loop++) {
-                  source=mpRamPointer[mLynxAddr];
-                  if(mDISPCTL_Flip) {
-                     mLynxAddr--;
-                     pixel=mColourMap[mPalette[source&0x0f].Index];
-                     *bitmap_tmp--=(UBYTE)pixel;
-                     pixel>>=8;
-                     *bitmap_tmp--=(UBYTE)pixel;
-                     pixel>>=8;
-                     *bitmap_tmp--=(UBYTE)pixel;
-                     pixel=mColourMap[mPalette[source>>4].Index];
-                     *bitmap_tmp--=(UBYTE)pixel;
-                     pixel>>=8;
-                     *bitmap_tmp--=(UBYTE)pixel;
-                     pixel>>=8;
-                     *bitmap_tmp--=(UBYTE)pixel;
-                  } else {
-                     mLynxAddr++;
-                     pixel=mColourMap[mPalette[source>>4].Index];
-                     *bitmap_tmp--=(UBYTE)pixel;
-                     pixel>>=8;
-                     *bitmap_tmp--=(UBYTE)pixel;
-                     pixel>>=8;
-                     *bitmap_tmp--=(UBYTE)pixel;
-                     pixel=mColourMap[mPalette[source&0x0f].Index];
-                     *bitmap_tmp--=(UBYTE)pixel;
-                     pixel>>=8;
-                     *bitmap_tmp--=(UBYTE)pixel;
-                     pixel>>=8;
-                     *bitmap_tmp--=(UBYTE)pixel;
-                  }
-               }
-            } else if(mDisplayFormat==MIKIE_PIXEL_FORMAT_32BPP) {
-               for(loop=0;loop<SCREEN_WIDTH/2;loop++) {
-                  source=mpRamPointer[mLynxAddr];
-                  if(mDISPCTL_Flip) {
-                     mLynxAddr--;
-                     *((ULONG*)(bitmap_tmp))=mColourMap[mPalette[source&0x0f].Index];
-                     bitmap_tmp-=sizeof(ULONG);
-                     *((ULONG*)(bitmap_tmp))=mColourMap[mPalette[source>>4].Index];
-                     bitmap_tmp-=sizeof(ULONG);
-                  } else {
-                     mLynxAddr++;
-                     *((ULONG*)(bitmap_tmp))=mColourMap[mPalette[source>>4].Index];
-                     bitmap_tmp-=sizeof(ULONG);
-                     *((ULONG*)(bitmap_tmp))=mColourMap[mPalette[source&0x0f].Index];
-                     bitmap_tmp-=sizeof(ULONG);
-                  }
-               }
-            }
-            mpDisplayCurrent-=mDisplayPitch;
-            break;
-         case MIKIE_ROTATE_R:
-            if(mDisplayFormat==MIKIE_PIXEL_FORMAT_8BPP) {
-               for(loop=0;loop<SCREEN_WIDTH/2;loop++) {
-                  source=mpRamPointer[mLynxAddr];
-                  if(mDISPCTL_Flip) {
-                     mLynxAddr--;
-                     *(bitmap_tmp)=(UBYTE)mColourMap[mPalette[source&0x0f].Index];
-                     bitmap_tmp-=mDisplayPitch;
-                     *(bitmap_tmp)=(UBYTE)mColourMap[mPalette[source>>4].Index];
-                     bitmap_tmp-=mDisplayPitch;
-                  } else {
-                     mLynxAddr++;
-                     *(bitmap_tmp)=(UBYTE)mColourMap[mPalette[source>>4].Index];
-                     bitmap_tmp-=mDisplayPitch;
-                     *(bitmap_tmp)=(UBYTE)mColourMap[mPalette[source&0x0f].Index];
-                     bitmap_tmp-=mDisplayPitch;
-                  }
-               }
-               mpDisplayCurrent+=sizeof(UBYTE);
-            } else if(mDisplayFormat==MIKIE_PIXEL_FORMAT_16BPP_BGR555 || mDisplayFormat==MIKIE_PIXEL_FORMAT_16BPP_555 || mDisplayFormat==MIKIE_PIXEL_FORMAT_16BPP_565) {
-               for(loop=0;loop<SCREEN_WIDTH/2;loop++) {
-                  source=mpRamPointer[mLynxAddr];
-                  if(mDISPCTL_Flip) {
-                     mLynxAddr--;
-                     *((UWORD*)(bitmap_tmp))=(UWORD)mColourMap[mPalette[source&0x0f].Index];
-                     bitmap_tmp-=mDisplayPitch;
-                     *((UWORD*)(bitmap_tmp))=(UWORD)mColourMap[mPalette[source>>4].Index];
-                     bitmap_tmp-=mDisplayPitch;
-                  } else {
-                     mLynxAddr++;
-                     *((UWORD*)(bitmap_tmp))=(UWORD)mColourMap[mPalette[source>>4].Index];
-                     bitmap_tmp-=mDisplayPitch;
-                     *((UWORD*)(bitmap_tmp))=(UWORD)mColourMap[mPalette[source&0x0f].Index];
-                     bitmap_tmp-=mDisplayPitch;
-                  }
-               }
-               mpDisplayCurrent+=sizeof(UWORD);
-            } else if(mDisplayFormat==MIKIE_PIXEL_FORMAT_24BPP) {
-               ULONG pixel;
-               for(loop=0;loop<SCREEN_WIDTH/2;loop++) {
-                  source=mpRamPointer[mLynxAddr];
-                  if(mDISPCTL_Flip) {
-                     mLynxAddr--;
-                     pixel=mColourMap[mPalette[source&0x0f].Index];
-                     *(bitmap_tmp)=(UBYTE)pixel;
-                     pixel>>=8;
-                     *(bitmap_tmp+1)=(UBYTE)pixel;
-                     pixel>>=8;
-                     *(bitmap_tmp+2)=(UBYTE)pixel;
-                     bitmap_tmp-=mDisplayPitch;
-                     pixel=mColourMap[mPalette[source>>4].Index];
-                     *(bitmap_tmp)=(UBYTE)pixel;
-                     pixel>>=8;
-                     *(bitmap_tmp+1)=(UBYTE)pixel;
-                     pixel>>=8;
-                     *(bitmap_tmp+2)=(UBYTE)pixel;
-                     bitmap_tmp-=mDisplayPitch;
-                  } else {
-                     mLynxAddr++;
-                     pixel=mColourMap[mPalette[source>>4].Index];
-                     *(bitmap_tmp)=(UBYTE)pixel;
-                     pixel>>=8;
-                     *(bitmap_tmp+1)=(UBYTE)pixel;
-                     pixel>>=8;
-                     *(bitmap_tmp+2)=(UBYTE)pixel;
-                     bitmap_tmp-=mDisplayPitch;
-                     pixel=mColourMap[mPalette[source&0x0f].Index];
-                     *(bitmap_tmp)=(UBYTE)pixel;
-                     pixel>>=8;
-                     *(bitmap_tmp+1)=(UBYTE)pixel;
-                     pixel>>=8;
-                     *(bitmap_tmp+2)=(UBYTE)pixel;
-                     bitmap_tmp-=mDisplayPitch;
-                  }
-               }
-               mpDisplayCurrent+=3;
-            } else if(mDisplayFormat==MIKIE_PIXEL_FORMAT_32BPP) {
-               for(loop=0;loop<SCREEN_WIDTH/2;loop++) {
-                  source=mpRamPointer[mLynxAddr];
-                  if(mDISPCTL_Flip) {
-                     mLynxAddr--;
-                     *((ULONG*)(bitmap_tmp))=mColourMap[mPalette[source&0x0f].Index];
-                     bitmap_tmp-=mDisplayPitch;
-                     *((ULONG*)(bitmap_tmp))=mColourMap[mPalette[source>>4].Index];
-                     bitmap_tmp-=mDisplayPitch;
-                  } else {
-                     mLynxAddr++;
-                     *((ULONG*)(bitmap_tmp))=mColourMap[mPalette[source>>4].Index];
-                     bitmap_tmp-=mDisplayPitch;
-                     *((ULONG*)(bitmap_tmp))=mColourMap[mPalette[source&0x0f].Index];
-                     bitmap_tmp-=mDisplayPitch;
-                  }
-               }
-               mpDisplayCurrent+=sizeof(ULONG);
-            }
-            break;
-         default:
-            break;
-      }
+      if(mpDisplayLine) (this->*mpDisplayLine)();
    }
    return work_done;
 }
@@ -1997,9 +1976,11 @@ void CMikie::Poke(ULONG addr, UBYTE data)
             TDISPCTL tmp;
             tmp.Byte=data;
             mDISPCTL_DMAEnable=tmp.Bits.DMAEnable;
+            if(mDISPCTL_Flip!=tmp.Bits.Flip) mDisplayGeneration++;
             mDISPCTL_Flip=tmp.Bits.Flip;
             mDISPCTL_FourColour=tmp.Bits.FourColour;
             mDISPCTL_Colour=tmp.Bits.Colour;
+            DisplaySelectLine();
          }
          break;
       case (PBKUP&0xff):
@@ -2065,7 +2046,9 @@ void CMikie::Poke(ULONG addr, UBYTE data)
       case (GREEND&0xff):
       case (GREENE&0xff):
       case (GREENF&0xff):
+         if(mPalette[addr&0x0f].Colours.Green!=(data&0x0f)) mDisplayGeneration++;
          mPalette[addr&0x0f].Colours.Green=data&0x0f;
+         DisplayResolvePen(addr&0x0f);
          break;
 
       case (BLUERED0&0xff):
@@ -2084,8 +2067,10 @@ void CMikie::Poke(ULONG addr, UBYTE data)
       case (BLUEREDD&0xff):
       case (BLUEREDE&0xff):
       case (BLUEREDF&0xff):
+         if(mPalette[addr&0x0f].Colours.Blue!=((data&0xf0)>>4) || mPalette[addr&0x0f].Colours.Red!=(data&0x0f)) mDisplayGeneration++;
          mPalette[addr&0x0f].Colours.Blue=(data&0xf0)>>4;
          mPalette[addr&0x0f].Colours.Red=data&0x0f;
+         DisplayResolvePen(addr&0x0f);
          break;
 
          // Errors on read only register accesses
@@ -2848,7 +2833,7 @@ inline void CMikie::Update(void)
 
                // If a networking object is attached then use its callback to send the data byte.
                if(mpUART_TX_CALLBACK)
-                  (*mpUART_TX_CALLBACK)(mUART_TX_DATA,mUART_TX_CALLBACK_OBJECT);
+                  mpUART_TX_CALLBACK(mUART_TX_DATA,mUART_TX_CALLBACK_OBJECT);
 
             } else if(!(mUART_TX_COUNTDOWN&UART_TX_INACTIVE)) {
                mUART_TX_COUNTDOWN--;
@@ -174,6 +174,7 @@ class CMikie : public CLynxBase
 {
    public:
       using DisplayCallback = std::function<UBYTE *(ULONG)>;
+      using ComLynxCallback = std::function<void(int data, ULONG objref)>;
 
       CMikie(CSystem& parent);
       ~CMikie();
@@ -196,7 +197,7 @@ class CMikie : public CLynxBase
       void	ComLynxCable(int status);
       void	ComLynxRxData(int data);
       void	ComLynxTxLoopback(int data);
-      void	ComLynxTxCallback(void (*function)(int data,ULONG objref),ULONG objref);
+      void	ComLynxTxCallback(CMikie::ComLynxCallback function,ULONG objref);
 
       void	DisplaySetAttributes(ULONG rotate, ULONG format, ULONG pitch, CMikie::DisplayCallback callback, ULONG objref);
 
@@ -204,6 +205,21 @@ class CMikie : public CLynxBase
 
       ULONG	DisplayRenderLine(void);
       ULONG	DisplayEndOfFrame(void);
+
+      // Set whenever a rendered line came out different from the same line
+      // in the previous frame, until cleared again
+      bool	DisplayDirty(void) { return mDisplayDirty; };
+      void	DisplayClearDirty(void) { mDisplayDirty=FALSE; };
+
+      // Lets unrotated 16 and 32 bit lines be expanded with SSSE3 or NEON
+      // where the host has it, on by default. The pixels are the same either way.
+      void	SetDisplaySimd(bool simd);
+      static bool DisplayHasSimd(void);
+
+      // Renders the line at 'addr' through the SIMD and the plain renderer
+      // of the current pixel format, both ways up, for handy_bench. FALSE
+      // if they came out different.
+      bool	DisplayCheckSimd(ULONG addr);
       void	AudioEndOfFrame(void);
 
       inline void SetCPUSleep(void);
@@ -215,6 +231,18 @@ class CMikie : public CLynxBase
       inline bool SwitchAudInValue(void){ return (mIODAT&0x10);};
 
    private:
+      // One line renderer per rotation, bytes a pixel and flip, picked by
+      // DisplaySelectLine() whenever one of those changes
+      typedef void (CMikie::*TDisplayLine)(void);
+      static const TDisplayLine mDisplayLines[4][4][2];
+
+      template<ULONG rotate,int size,bool flip> void DisplayLine(void);
+      template<int size,bool flip> void DisplayLineSsse3(void);
+      template<int size,bool flip> void DisplayLineNeon(void);
+      void	DisplaySelectLine(void);
+      static TDisplayLine DisplaySimdLine(int size,bool flip);
+      void	DisplayResolvePen(ULONG pen);
+
       CSystem		&mSystem;
 
       // Hardware storage
@@ -415,7 +443,7 @@ class CMikie : public CLynxBase
       ULONG		mUART_PARITY_EVEN;
 
       int			mUART_CABLE_PRESENT;
-      void		(*mpUART_TX_CALLBACK)(int data,ULONG objref);
+      CMikie::ComLynxCallback mpUART_TX_CALLBACK;
       ULONG		mUART_TX_CALLBACK_OBJECT;
 
       int			mUART_Rx_input_queue[UART_MAX_RX_QUEUE];
@@ -442,6 +470,20 @@ class CMikie : public CLynxBase
       ULONG		mDisplayCallbackObject;
 
       CMikie::DisplayCallback mpDisplayCallback;
+      TDisplayLine	mpDisplayLine;
+      bool		mDisplaySimd;
+
+      // Each pen's mColourMap[] entry, kept up to date by DisplayResolvePen(),
+      // and the same split into its bytes for the SIMD lines
+      ULONG		mDisplayPalette[16];
+      UBYTE		mDisplayPaletteBytes[4][16];
+
+      // Dirty tracking, the RAM each line was last rendered from and the
+      // generation of everything else (palette, flip, format) it used
+      ULONG		mDisplayDirty;
+      ULONG		mDisplayGeneration;
+      ULONG		mDisplayShadowGeneration[SCREEN_HEIGHT];
+      UBYTE		mDisplayShadow[SCREEN_HEIGHT][SCREEN_WIDTH/2];
 
       // State within GetLfsrNext()
    
@@ -78,6 +78,19 @@ CRam::CRam(CSystem &parent, const UBYTE *gamedata, ULONG gamesize) : mSystem(par
    Reset();
 }
 
+CRam::CRam(CSystem &parent, const CRam &origin) : mSystem(parent)
+{
+   mFileSize=origin.mFileSize;
+
+   if(mFileSize) {
+      mFileData = new UBYTE[mFileSize];
+      memcpy(mFileData,origin.mFileData,mFileSize);
+   } else {
+      mFileData=NULL;
+   }
+   memcpy(mRamData,origin.mRamData,RAM_SIZE);
+}
+
 CRam::~CRam()
 {
    if(mFileSize) {
@@ -65,6 +65,7 @@ class CRam : public CLynxBase
 
    public:
       CRam(CSystem &parent, const UBYTE *gamedata, ULONG gamesize);
+      CRam(CSystem &parent, const CRam &origin);
       ~CRam();
 
    public:
@@ -50,6 +50,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <chrono>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 #include "system.h"
 #include "susie.h"
 #include "lynxdef.h"
@@ -65,18 +69,21 @@
 
 #define RAM_PEEK(m)				(mRamPointer[(m)])
 #define RAM_PEEKW(m)			(mRamPointer[(m)]+(mRamPointer[(m)+1]<<8))
-#define RAM_POKE(m1,m2)			{mRamPointer[(m1)]=(m2);}
-
-ULONG cycles_used=0;
+#define RAM_POKE(m1,m2)			{mRamPointer[(m1)]=(m2); mSystem.mCpu->RamWritten(m1);}
 
 CSusie::CSusie(CSystem& parent)
    :mSystem(parent)
 {
+   mSpriteCache=NULL;
+   mSpriteCachePixel=NULL;
+   mSpriteCacheCount=NULL;
+   mSpriteCacheUsed=0;
    Reset();
 }
 
 CSusie::~CSusie()
 {
+   SetSpriteCache(FALSE);
 }
 
 void CSusie::Reset(void)
@@ -165,6 +172,8 @@ void CSusie::Reset(void)
 
    mJOYSTICK.Byte=0;
    mSWITCHES.Byte=0;
+
+   SpriteCacheFlush();
 }
 
 bool CSusie::ContextSave(LSS_FILE *fp)
@@ -427,7 +436,9 @@ ULONG CSusie::PaintSprites(void)
       return 0;
    }
 
-   cycles_used=0;
+   auto const start=std::chrono::steady_clock::now();
+   mStats.paints++;
+   mCyclesUsed=0;
 
    do {
       everonscreen=0;// everon has to be reset for every sprite, thus line was moved inside this loop
@@ -472,7 +483,8 @@ ULONG CSusie::PaintSprites(void)
       mSCBNEXT.Word=RAM_PEEKW(mTMPADR.Word);	// Next SCB
       mTMPADR.Word+=2;
 
-      cycles_used+=5*SPR_RDWR_CYC;
+      mCyclesUsed+=5*SPR_RDWR_CYC;
+      mStats.sprites++;
 
       // Initialise the collision depositary
 
@@ -486,6 +498,7 @@ ULONG CSusie::PaintSprites(void)
 
       // Check if this is a skip sprite
 
+      if(mSPRCTL1_SkipSprite) mStats.skipped++;
       if(!mSPRCTL1_SkipSprite)
       {
          mSPRDLINE.Word=RAM_PEEKW(mTMPADR.Word);	// Sprite pack data
@@ -497,7 +510,7 @@ ULONG CSusie::PaintSprites(void)
          mVPOSSTRT.Word=RAM_PEEKW(mTMPADR.Word);	// Sprite vertical start position
          mTMPADR.Word+=2;
 
-         cycles_used+=6*SPR_RDWR_CYC;
+         mCyclesUsed+=6*SPR_RDWR_CYC;
 
          bool enable_sizing  = FALSE;
          bool enable_stretch = FALSE;
@@ -515,7 +528,7 @@ ULONG CSusie::PaintSprites(void)
                mSPRVSIZ.Word=RAM_PEEKW(mTMPADR.Word);	// Sprite Verticalal size
                mTMPADR.Word+=2;
 
-               cycles_used+=4*SPR_RDWR_CYC;
+               mCyclesUsed+=4*SPR_RDWR_CYC;
                break;
 
             case 2:
@@ -531,7 +544,7 @@ ULONG CSusie::PaintSprites(void)
                mSTRETCH.Word=RAM_PEEKW(mTMPADR.Word);	// Sprite stretch
                mTMPADR.Word+=2;
 
-               cycles_used+=6*SPR_RDWR_CYC;
+               mCyclesUsed+=6*SPR_RDWR_CYC;
                break;
 
             case 3:
@@ -551,7 +564,7 @@ ULONG CSusie::PaintSprites(void)
                mTILT.Word=RAM_PEEKW(mTMPADR.Word);		// Sprite tilt
                mTMPADR.Word+=2;
 
-               cycles_used+=8*SPR_RDWR_CYC;
+               mCyclesUsed+=8*SPR_RDWR_CYC;
                break;
 
             default:
@@ -567,7 +580,7 @@ ULONG CSusie::PaintSprites(void)
                mPenIndex[(loop*2)+1]=data_tmp&0x0f;
             }
             // Increment cycle count for the reads
-            cycles_used+=8*SPR_RDWR_CYC;
+            mCyclesUsed+=8*SPR_RDWR_CYC;
          }
 
          // Now we can start painting
@@ -601,6 +614,7 @@ ULONG CSusie::PaintSprites(void)
 
          if((int16_t)mHPOSSTRT.Word<screen_h_start || (int16_t)mHPOSSTRT.Word>=screen_h_end ||
             (int16_t)mVPOSSTRT.Word<screen_v_start || (int16_t)mVPOSSTRT.Word>=screen_v_end) superclip=TRUE;
+         if(superclip) mStats.superclipped++;
 
          // Quadrant mapping is:	SE	NE	NW	SW
          //						0	1	2	3
@@ -632,6 +646,9 @@ ULONG CSusie::PaintSprites(void)
             if(mSPRCTL0_Vflip) vsign=-vsign;
             if(mSPRCTL0_Hflip) hsign=-hsign;
 
+            // Pick the line painter for this sprite type and direction
+            TPaintLine paint_line=mPaintLines[mSPRCTL0_Type][!mSPRCOLL_Collide && !mSPRSYS_NoCollide][hsign>0];
+
             // Two different rendering algorithms used, on-screen & superclip
             // when on screen we draw in x until off screen then skip to next
             // line, BUT on superclip we draw all the way to the end of any
@@ -725,6 +742,11 @@ ULONG CSusie::PaintSprites(void)
                      break;
                   }
 
+                  // Lines drawn more than once, unscaled ones that may be
+                  // painted in one go and all of them for the sprite cache
+                  // get decoded on the first row drawn
+                  mLineRuns=(mPixelHeight>1 || mSPRHSIZ.Word==0x0100 || mSpriteCache)?LINE_RUNS_NONE:LINE_RUNS_UNCACHED;
+
                   // Draw one horizontal line of the sprite
                   for(mLoopV=0;mLoopV<mPixelHeight;mLoopV++) {
                      // Early bailout if the sprite has moved off screen, terminate quad
@@ -750,28 +772,13 @@ ULONG CSusie::PaintSprites(void)
                         if(hsign!=mQuadOffH) mOffH+=hsign;
 
                         // Initialise our line
-                        LineInit(mOffV);
+                        if(mLineRuns==LINE_RUNS_NONE) LineDecode(mOffV);
+                        if(mLineRuns>=0) LineReplay(mOffV);
+                        else LineInit(mOffV);
                         mIsOnscreen=FALSE;
 
                         // Now render an individual destination line
-                        while((mPixel=LineGetPixel())!=LINE_END) {
-                           // This is allowed to update every pixel
-                           mHSIZACUM.Word+=mSPRHSIZ.Word;
-                           mPixelWidth=mHSIZACUM.Byte.High;
-                           mHSIZACUM.Byte.High=0;
-
-                           for(mLoopH=0; mLoopH<mPixelWidth; mLoopH++) {
-                              // Draw if onscreen but break loop on transition to offscreen
-                              if(mOffH>=0 && mOffH<SCREEN_WIDTH) {
-                                 ProcessPixel(mOffH,mPixel);
-                                 mIsOnscreen = TRUE;
-                                 everonscreen=TRUE;
-                              } else {
-                                 if(mIsOnscreen) break;
-                              }
-                              mOffH+=hsign;
-                           }
-                        }
+                        if((this->*paint_line)()) everonscreen=TRUE;
                      }
                      mOffV+=vsign;
 
@@ -880,9 +887,11 @@ ULONG CSusie::PaintSprites(void)
 
    // Fudge factor to fix many flickering issues, also the keypress
    // problem with Hard Drivin and the strange pause in Dirty Larry.
-   //	cycles_used>>=2;
+   //	mCyclesUsed>>=2;
 
-   return cycles_used;
+   mStats.cycles+=mCyclesUsed;
+   mStats.host_ns+=std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()-start).count();
+   return mCyclesUsed;
 }
 
 //
@@ -909,9 +918,10 @@ ULONG CSusie::PaintSprites(void)
 //                        1 0 0 0 0 0 0 0   exclusive-or the data
 //
 
+template<int type,bool collide>
 inline void CSusie::ProcessPixel(ULONG hoff,ULONG pixel)
 {
-   switch(mSPRCTL0_Type) {
+   switch(type) {
       // BACKGROUND SHADOW
       // 1   F is opaque
       // 0   E is collideable
@@ -921,7 +931,7 @@ inline void CSusie::ProcessPixel(ULONG hoff,ULONG pixel)
       // 0   exclusive-or the data
       case sprite_background_shadow:
          WritePixel(hoff,pixel);
-         if(!mSPRCOLL_Collide && !mSPRSYS_NoCollide && pixel!=0x0e) {
+         if(collide && pixel!=0x0e) {
             WriteCollision(hoff,mSPRCOLL_Number);
          }
          break;
@@ -960,7 +970,7 @@ inline void CSusie::ProcessPixel(ULONG hoff,ULONG pixel)
             WritePixel(hoff,pixel);
          }
          if(pixel!=0x00) {
-            if(!mSPRCOLL_Collide && !mSPRSYS_NoCollide) {
+            if(collide) {
                int collision=ReadCollision(hoff);
                if(collision>mCollision) {
                   mCollision=collision;
@@ -983,7 +993,7 @@ inline void CSusie::ProcessPixel(ULONG hoff,ULONG pixel)
       case sprite_normal:
          if(pixel!=0x00) {
             WritePixel(hoff,pixel);
-            if(!mSPRCOLL_Collide && !mSPRSYS_NoCollide) {
+            if(collide) {
                int collision=ReadCollision(hoff);
                if(collision>mCollision) {
                   mCollision=collision;
@@ -1008,7 +1018,7 @@ inline void CSusie::ProcessPixel(ULONG hoff,ULONG pixel)
             WritePixel(hoff,pixel);
          }
          if(pixel!=0x00 && pixel!=0x0e) {
-            if(!mSPRCOLL_Collide && !mSPRSYS_NoCollide) {
+            if(collide) {
                int collision=ReadCollision(hoff);
                if(collision>mCollision) {
                   mCollision=collision;
@@ -1033,7 +1043,7 @@ inline void CSusie::ProcessPixel(ULONG hoff,ULONG pixel)
             WritePixel(hoff,pixel);
          }
          if(pixel!=0x00 && pixel!=0x0e) {
-            if(!mSPRCOLL_Collide && !mSPRSYS_NoCollide) {
+            if(collide) {
                int collision=ReadCollision(hoff);
                if(collision>mCollision) {
                   mCollision=collision;
@@ -1058,7 +1068,7 @@ inline void CSusie::ProcessPixel(ULONG hoff,ULONG pixel)
             WritePixel(hoff,ReadPixel(hoff)^pixel);
          }
          if(pixel!=0x00 && pixel!=0x0e) {
-            if(!mSPRCOLL_Collide && !mSPRSYS_NoCollide && pixel!=0x0e) {
+            if(collide && pixel!=0x0e) {
                int collision=ReadCollision(hoff);
                if(collision>mCollision) {
                   mCollision=collision;
@@ -1093,7 +1103,8 @@ inline void CSusie::WritePixel(ULONG hoff,ULONG pixel)
    RAM_POKE(scr_addr,dest);
 
    // Increment cycle count for the read/modify/write
-   cycles_used+=2*SPR_RDWR_CYC;
+   mCyclesUsed+=2*SPR_RDWR_CYC;
+   mStats.pixels++;
 }
 
 inline ULONG CSusie::ReadPixel(ULONG hoff)
@@ -1110,7 +1121,7 @@ inline ULONG CSusie::ReadPixel(ULONG hoff)
    }
 
    // Increment cycle count for the read/modify/write
-   cycles_used+=SPR_RDWR_CYC;
+   mCyclesUsed+=SPR_RDWR_CYC;
 
    return data;
 }
@@ -1132,7 +1143,8 @@ inline void CSusie::WriteCollision(ULONG hoff,ULONG pixel)
    RAM_POKE(col_addr,dest);
 
    // Increment cycle count for the read/modify/write
-   cycles_used+=2*SPR_RDWR_CYC;
+   mCyclesUsed+=2*SPR_RDWR_CYC;
+   mStats.collision_writes++;
 }
 
 inline ULONG CSusie::ReadCollision(ULONG hoff)
@@ -1149,7 +1161,8 @@ inline ULONG CSusie::ReadCollision(ULONG hoff)
    }
 
    // Increment cycle count for the read/modify/write
-   cycles_used+=SPR_RDWR_CYC;
+   mCyclesUsed+=SPR_RDWR_CYC;
+   mStats.collision_reads++;
 
    return data;
 }
@@ -1202,6 +1215,559 @@ inline ULONG CSusie::LineInit(ULONG voff)
    return offset;
 }
 
+// Which of the pixels a sprite type writes to the screen and the collision
+// buffer, as ProcessPixel() does them
+#define PAINT_WRITES(type,pixel)	((type)==sprite_background_shadow || (type)==sprite_background_noncollide || \
+                                    ((pixel)!=0x00 && ((type)!=sprite_boundary || (pixel)!=0x0f) && \
+                                    ((type)!=sprite_boundary_shadow || ((pixel)!=0x0e && (pixel)!=0x0f))))
+#define PAINT_COLLIDES(type,pixel)	((type)==sprite_background_shadow?(pixel)!=0x0e: \
+                                    ((type)==sprite_boundary || (type)==sprite_normal)?(pixel)!=0x00: \
+                                    ((type)!=sprite_background_noncollide && (type)!=sprite_noncollide && \
+                                    (pixel)!=0x00 && (pixel)!=0x0e))
+
+// Writes 'pixel' to 'count' nibbles of the row at 'base', from 'hoff'
+// rightwards, two at a time where it can
+template<bool exclusive_or>
+inline void CSusie::FillNibbles(ULONG base,int hoff,int count,ULONG pixel)
+{
+   ULONG addr=base+(hoff/2);
+
+   if(hoff&0x01) {
+      UBYTE dest=RAM_PEEK(addr);
+      dest=exclusive_or?(dest^pixel):((dest&0xf0)|pixel);
+      RAM_POKE(addr,dest);
+      addr++;
+      count--;
+   }
+   for(;count>=2;count-=2,addr++) {
+      UBYTE dest=(UBYTE)(pixel*0x11);
+      if(exclusive_or) dest^=RAM_PEEK(addr);
+      RAM_POKE(addr,dest);
+   }
+   if(count) {
+      UBYTE dest=RAM_PEEK(addr);
+      dest=exclusive_or?(dest^(pixel<<4)):((dest&0x0f)|(pixel<<4));
+      RAM_POKE(addr,dest);
+   }
+}
+
+// The highest of 'count' nibbles of the collision buffer row, from 'hoff'
+inline int CSusie::MaxCollision(int hoff,int count)
+{
+   int collision=0;
+   for(ULONG addr=mLineCollisionAddress+(hoff/2);count>0;addr++) {
+      ULONG data=RAM_PEEK(addr);
+      if(!(hoff&0x01)) {
+         if((int)(data>>4)>collision) collision=data>>4;
+         hoff++;
+         count--;
+         if(!count) break;
+      }
+      if((int)(data&0x0f)>collision) collision=data&0x0f;
+      hoff++;
+      count--;
+   }
+   return collision;
+}
+
+// Paints 'pixel' to 'count' on screen positions from 'hoff' rightwards.
+// Every position does the same as ProcessPixel() would, the screen and
+// collision writes just aren't interleaved, which only matters if the
+// two buffers share a row (see PaintLine()).
+template<int type,bool collide>
+inline void CSusie::PaintSpan(int hoff,int count,ULONG pixel)
+{
+   bool const writes=PAINT_WRITES(type,pixel);
+   bool const collides=collide && PAINT_COLLIDES(type,pixel);
+
+   if(writes) {
+      FillNibbles<type==sprite_xor_shadow>(mLineBaseAddress,hoff,count,pixel);
+      mCyclesUsed+=((type==sprite_xor_shadow)?3:2)*SPR_RDWR_CYC*count;
+      mStats.pixels+=count;
+   }
+   if(collides) {
+      if(type!=sprite_background_shadow) {
+         int collision=MaxCollision(hoff,count);
+         if(collision>mCollision) mCollision=collision;
+         mCyclesUsed+=SPR_RDWR_CYC*count;
+         mStats.collision_reads+=count;
+      }
+      FillNibbles<false>(mLineCollisionAddress,hoff,count,mSPRCOLL_Number);
+      mCyclesUsed+=2*SPR_RDWR_CYC*count;
+      mStats.collision_writes+=count;
+   }
+}
+
+// PAINT_WRITES() and PAINT_COLLIDES() as a bit per pixel value
+template<int type>
+static constexpr UWORD PaintWritesMask(void)
+{
+   UWORD mask=0;
+   for(int pixel=0;pixel<16;pixel++) {
+      if(PAINT_WRITES(type,pixel)) mask|=1<<pixel;
+   }
+   return mask;
+}
+
+template<int type>
+static constexpr UWORD PaintCollidesMask(void)
+{
+   UWORD mask=0;
+   for(int pixel=0;pixel<16;pixel++) {
+      if(PAINT_COLLIDES(type,pixel)) mask|=1<<pixel;
+   }
+   return mask;
+}
+
+#if defined(__SSE2__)
+// The same for 16 pixels at once, 0xff where the pixel is written
+template<int type>
+static inline __m128i PaintWritesSimd(__m128i pixels)
+{
+   __m128i const all=_mm_set1_epi8(-1);
+   if(type==sprite_background_shadow || type==sprite_background_noncollide) return all;
+
+   __m128i mask=_mm_xor_si128(_mm_cmpeq_epi8(pixels,_mm_setzero_si128()),all);
+   if(type==sprite_boundary || type==sprite_boundary_shadow) {
+      mask=_mm_andnot_si128(_mm_cmpeq_epi8(pixels,_mm_set1_epi8(0x0f)),mask);
+   }
+   if(type==sprite_boundary_shadow) {
+      mask=_mm_andnot_si128(_mm_cmpeq_epi8(pixels,_mm_set1_epi8(0x0e)),mask);
+   }
+   return mask;
+}
+
+template<int type>
+static inline __m128i PaintCollidesSimd(__m128i pixels)
+{
+   __m128i const all=_mm_set1_epi8(-1);
+   __m128i const not_e=_mm_xor_si128(_mm_cmpeq_epi8(pixels,_mm_set1_epi8(0x0e)),all);
+   __m128i const not_0=_mm_xor_si128(_mm_cmpeq_epi8(pixels,_mm_setzero_si128()),all);
+
+   if(type==sprite_background_shadow) return not_e;
+   if(type==sprite_boundary || type==sprite_normal) return not_0;
+   if(type==sprite_background_noncollide || type==sprite_noncollide) return _mm_setzero_si128();
+   return _mm_and_si128(not_0,not_e);
+}
+
+// How many of the pixels two of those masks are set for
+static inline int PaintCountSimd(__m128i even,__m128i odd)
+{
+   __m128i const one=_mm_set1_epi8(1);
+   __m128i const sum=_mm_sad_epu8(_mm_add_epi8(_mm_and_si128(even,one),_mm_and_si128(odd,one)),_mm_setzero_si128());
+   return _mm_cvtsi128_si32(sum)+_mm_cvtsi128_si32(_mm_srli_si128(sum,8));
+}
+#endif
+
+// Writes the pixels mSpanPixel holds from 'lo' to 'hi' into the screen and
+// collision rows a byte at a time, 16 bytes at a time where the row is
+// long enough. Every pixel costs the same cycles as with ProcessPixel().
+template<int type,bool collide>
+void CSusie::MergeSpan(int lo,int hi)
+{
+   bool const exclusive_or=type==sprite_xor_shadow;
+   bool const collision_read=type!=sprite_background_shadow;
+   UWORD const writes=PaintWritesMask<type>();
+   UWORD const collides=collide?PaintCollidesMask<type>():0;
+   UBYTE const number=(UBYTE)(mSPRCOLL_Number*0x11);
+
+   ULONG pixels=0;
+   ULONG collision_reads=0;
+   ULONG collision_writes=0;
+   int collision=mCollision;
+
+   // One byte, 'nibbles' says which of its pixels are in the span
+   auto const merge_byte=[&](int byte,UBYTE nibbles) {
+      ULONG const upper=mSpanPixel[byte*2]&0x0f;
+      ULONG const lower=mSpanPixel[byte*2+1]&0x0f;
+
+      UBYTE const screen_mask=(((writes>>upper)&1)*0xf0|((writes>>lower)&1)*0x0f)&nibbles;
+      if(screen_mask) {
+         ULONG const addr=mLineBaseAddress+byte;
+         UBYTE const data=(UBYTE)((upper<<4)|lower)&screen_mask;
+         UBYTE dest=RAM_PEEK(addr);
+         if(exclusive_or) dest^=data;
+         else dest=(dest&~screen_mask)|data;
+         RAM_POKE(addr,dest);
+         pixels+=(screen_mask==0xff)?2:1;
+      }
+
+      UBYTE const coll_mask=(((collides>>upper)&1)*0xf0|((collides>>lower)&1)*0x0f)&nibbles;
+      if(coll_mask) {
+         ULONG const addr=mLineCollisionAddress+byte;
+         UBYTE const dest=RAM_PEEK(addr);
+         int const count=(coll_mask==0xff)?2:1;
+         if(collision_read) {
+            if((coll_mask&0xf0) && (dest>>4)>collision) collision=dest>>4;
+            if((coll_mask&0x0f) && (dest&0x0f)>collision) collision=dest&0x0f;
+            collision_reads+=count;
+         }
+         RAM_POKE(addr,(dest&~coll_mask)|(number&coll_mask));
+         collision_writes+=count;
+      }
+   };
+
+   // A span starting on an odd pixel has only the lower nibble of its
+   // first byte, one ending on an even pixel only the upper of its last
+   int byte=lo/2;
+   int const end=hi/2;
+   if(lo&0x01) merge_byte(byte++,0x0f);
+
+#if defined(__SSE2__)
+   for(;byte+16<=end;byte+=16) {
+      // The even pixels are the upper nibbles
+      __m128i const low=_mm_set1_epi16(0x00ff);
+      __m128i const upper=_mm_set1_epi8((char)0xf0);
+      __m128i const lower=_mm_set1_epi8(0x0f);
+      __m128i const first=_mm_and_si128(_mm_loadu_si128((const __m128i*)(mSpanPixel+byte*2)),lower);
+      __m128i const second=_mm_and_si128(_mm_loadu_si128((const __m128i*)(mSpanPixel+byte*2+16)),lower);
+      __m128i const even=_mm_packus_epi16(_mm_and_si128(first,low),_mm_and_si128(second,low));
+      __m128i const odd=_mm_packus_epi16(_mm_srli_epi16(first,8),_mm_srli_epi16(second,8));
+
+      __m128i const write_even=PaintWritesSimd<type>(even);
+      __m128i const write_odd=PaintWritesSimd<type>(odd);
+      __m128i const screen_mask=_mm_or_si128(_mm_and_si128(write_even,upper),_mm_and_si128(write_odd,lower));
+      int const screen_bytes=_mm_movemask_epi8(_mm_cmpeq_epi8(screen_mask,_mm_setzero_si128()))^0xffff;
+      if(screen_bytes) {
+         UBYTE *screen=mRamPointer+mLineBaseAddress+byte;
+         __m128i const data=_mm_and_si128(_mm_or_si128(_mm_slli_epi16(even,4),odd),screen_mask);
+         __m128i dest=_mm_loadu_si128((const __m128i*)screen);
+         if(exclusive_or) dest=_mm_xor_si128(dest,data);
+         else dest=_mm_or_si128(_mm_andnot_si128(screen_mask,dest),data);
+         _mm_storeu_si128((__m128i*)screen,dest);
+         for(int bits=screen_bytes;bits;bits&=bits-1) {
+            mSystem.mCpu->RamWritten(mLineBaseAddress+byte+__builtin_ctz(bits));
+         }
+         pixels+=PaintCountSimd(write_even,write_odd);
+      }
+
+      if(collide) {
+         __m128i const collide_even=PaintCollidesSimd<type>(even);
+         __m128i const collide_odd=PaintCollidesSimd<type>(odd);
+         __m128i const coll_mask=_mm_or_si128(_mm_and_si128(collide_even,upper),_mm_and_si128(collide_odd,lower));
+         int const coll_bytes=_mm_movemask_epi8(_mm_cmpeq_epi8(coll_mask,_mm_setzero_si128()))^0xffff;
+         if(coll_bytes) {
+            UBYTE *coll=mRamPointer+mLineCollisionAddress+byte;
+            __m128i const dest=_mm_loadu_si128((const __m128i*)coll);
+            int const count=PaintCountSimd(collide_even,collide_odd);
+            if(collision_read) {
+               __m128i const read_even=_mm_and_si128(_mm_and_si128(_mm_srli_epi16(dest,4),lower),collide_even);
+               __m128i const read_odd=_mm_and_si128(_mm_and_si128(dest,lower),collide_odd);
+               __m128i highest=_mm_max_epu8(read_even,read_odd);
+               highest=_mm_max_epu8(highest,_mm_srli_si128(highest,8));
+               highest=_mm_max_epu8(highest,_mm_srli_si128(highest,4));
+               highest=_mm_max_epu8(highest,_mm_srli_si128(highest,2));
+               highest=_mm_max_epu8(highest,_mm_srli_si128(highest,1));
+               int const value=_mm_cvtsi128_si32(highest)&0xff;
+               if(value>collision) collision=value;
+               collision_reads+=count;
+            }
+            __m128i const data=_mm_and_si128(_mm_set1_epi8((char)number),coll_mask);
+            _mm_storeu_si128((__m128i*)coll,_mm_or_si128(_mm_andnot_si128(coll_mask,dest),data));
+            for(int bits=coll_bytes;bits;bits&=bits-1) {
+               mSystem.mCpu->RamWritten(mLineCollisionAddress+byte+__builtin_ctz(bits));
+            }
+            collision_writes+=count;
+         }
+      }
+   }
+#endif
+
+   for(;byte<end;byte++) merge_byte(byte,0xff);
+   if(hi&0x01) merge_byte(byte,0xf0);
+
+   mCollision=collision;
+   mCyclesUsed+=((exclusive_or?3:2)*pixels+collision_reads+2*collision_writes)*SPR_RDWR_CYC;
+   mStats.pixels+=pixels;
+   mStats.collision_reads+=collision_reads;
+   mStats.collision_writes+=collision_writes;
+}
+
+// Paints one source pixel, as many times wide as 'width' says, starting
+// at mOffH. Like drawing it a pixel at a time, it stops when the line
+// goes back off screen. True if any of it was on screen. With 'buffer' it
+// only goes into mSpanPixel.
+template<int type,bool collide,int hsign,bool buffer>
+inline bool CSusie::PaintPixels(ULONG pixel,int width,bool spans)
+{
+   int const first=mOffH;
+   bool const offscreen=first<0 || first>=SCREEN_WIDTH;
+
+   if(offscreen && mIsOnscreen) return FALSE;
+
+   // Positions before the line comes on screen, all of them when it
+   // never will
+   int skip=0;
+   if(offscreen) {
+      if(hsign>0) skip=(first<0)?-first:width;
+      else skip=(first>=SCREEN_WIDTH)?first-(SCREEN_WIDTH-1):width;
+      if(skip>=width) {
+         mOffH+=width*hsign;
+         return FALSE;
+      }
+   }
+
+   int const start=first+skip*hsign;
+   int const room=(hsign>0)?SCREEN_WIDTH-start:start+1;
+   int const count=(width-skip<room)?width-skip:room;
+
+   int const lowest=(hsign>0)?start:start-(count-1);
+   if(buffer) {
+      memset(mSpanPixel+lowest,pixel,count);
+      if(lowest<mSpanLo) mSpanLo=lowest;
+      if(lowest+count>mSpanHi) mSpanHi=lowest+count;
+   } else if(spans) {
+      PaintSpan<type,collide>(lowest,count,pixel);
+   } else {
+      for(int loop=0,hoff=start;loop<count;loop++,hoff+=hsign) {
+         ProcessPixel<type,collide>(hoff,pixel);
+      }
+   }
+   mIsOnscreen=TRUE;
+
+   // Either all done or stopped on the first position back off screen
+   mOffH=start+count*hsign;
+   return TRUE;
+}
+
+// Paints the line LineInit() or LineReplay() set up, one of these for
+// every sprite type, with or without collisions and in either direction
+template<int type,bool collide,int hsign>
+bool CSusie::PaintLine(void)
+{
+   bool painted=FALSE;
+
+   // The screen and collision rows don't normally overlap, when they do
+   // the pixels have to be done one by one. A decoded line doesn't need
+   // its data any more, so a long unscaled one whose runs are mostly a
+   // pixel wide is put together in mSpanPixel and painted in one go at
+   // the end. Wider runs are quicker painted as they come.
+   bool const spans=!collide ||
+                    mLineBaseAddress+(SCREEN_WIDTH/2)<=mLineCollisionAddress ||
+                    mLineCollisionAddress+(SCREEN_WIDTH/2)<=mLineBaseAddress;
+   bool const buffer=spans && mLineRuns>=0 && mSPRHSIZ.Word==0x0100 && !mHSIZACUM.Byte.High &&
+                     mLineRunPixels>=SPAN_BUFFER_MIN && mLineRunPixels<2*(ULONG)mLineRuns;
+
+   if(buffer) {
+      mSpanLo=SCREEN_WIDTH;
+      mSpanHi=0;
+      for(int run=0;run<mLineRuns;run++) {
+         mPixel=mLineRunPixel[run];
+         if(PaintPixels<type,collide,hsign,true>(mPixel,mLineRunCount[run],spans)) painted=TRUE;
+      }
+      mPixel=LINE_END;
+
+      if(mSpanLo<mSpanHi) MergeSpan<type,collide>(mSpanLo,mSpanHi);
+   } else if(mLineRuns>=0) {
+      // A run's pixels are the same and side by side, so they can be
+      // painted as one
+      for(int run=0;run<mLineRuns;run++) {
+         int width=0;
+         for(int count=mLineRunCount[run];count;count--) {
+            mHSIZACUM.Word+=mSPRHSIZ.Word;
+            width+=mHSIZACUM.Byte.High;
+            mHSIZACUM.Byte.High=0;
+         }
+         mPixel=mLineRunPixel[run];
+         if(width && PaintPixels<type,collide,hsign,false>(mPixel,width,spans)) painted=TRUE;
+      }
+      mPixel=LINE_END;
+   } else {
+      while((mPixel=LineGetPixel())!=LINE_END) {
+         // This is allowed to update every pixel
+         mHSIZACUM.Word+=mSPRHSIZ.Word;
+         mPixelWidth=mHSIZACUM.Byte.High;
+         mHSIZACUM.Byte.High=0;
+
+         if(mPixelWidth && PaintPixels<type,collide,hsign,false>(mPixel,mPixelWidth,spans)) painted=TRUE;
+      }
+   }
+   return painted;
+}
+
+#define PAINT_LINES(type)	{ { &CSusie::PaintLine<type,false,-1>, &CSusie::PaintLine<type,false,1> }, \
+                              { &CSusie::PaintLine<type,true,-1>, &CSusie::PaintLine<type,true,1> } }
+
+const CSusie::TPaintLine CSusie::mPaintLines[8][2][2]={
+   PAINT_LINES(sprite_background_shadow),
+   PAINT_LINES(sprite_background_noncollide),
+   PAINT_LINES(sprite_boundary_shadow),
+   PAINT_LINES(sprite_boundary),
+   PAINT_LINES(sprite_normal),
+   PAINT_LINES(sprite_noncollide),
+   PAINT_LINES(sprite_xor_shadow),
+   PAINT_LINES(sprite_shadow)
+};
+
+// Decodes the whole line into pixel runs, or takes them from the sprite
+// cache. The line is left uncached when it's too long or the sprite could
+// draw over its own data.
+bool CSusie::LineDecode(ULONG voff)
+{
+   if(mSpriteCache && SpriteCacheFind()) return TRUE;
+
+   ULONG cycles=mCyclesUsed;
+   ULONG pixel;
+
+   LineInit(voff);
+   mLineRuns=0;
+   mLineRunPixels=0;
+   while((pixel=LineGetPixel())!=LINE_END) {
+      mLineRunPixels++;
+      if(mLineRuns && mLineRunPixel[mLineRuns-1]==pixel && mLineRunCount[mLineRuns-1]<0xff) {
+         mLineRunCount[mLineRuns-1]++;
+      } else if(mLineRuns<LINE_RUNS_MAX) {
+         mLineRunPixel[mLineRuns]=(UBYTE)pixel;
+         mLineRunCount[mLineRuns]=1;
+         mLineRuns++;
+      } else {
+         break;
+      }
+   }
+
+   mLineRunCycles=mCyclesUsed-cycles;
+   mCyclesUsed=cycles;
+   if(pixel!=LINE_END || !LineUnpainted(mSPRDLINE.Word,mTMPADR.Word)) {
+      mLineRuns=LINE_RUNS_UNCACHED;
+      return FALSE;
+   }
+
+   mLineEndTMPADR=mTMPADR.Word;
+   mLineEndType=mLineType;
+   mLineEndShiftRegCount=mLineShiftRegCount;
+   mLineEndShiftReg=mLineShiftReg;
+   mLineEndRepeatCount=mLineRepeatCount;
+   mLineEndPacketBitsLeft=mLinePacketBitsLeft;
+
+   if(mSpriteCache) SpriteCacheAdd();
+   return TRUE;
+}
+
+// True when the line's data from 'start' to 'end' is out of the way of
+// the rows of the screen and collision buffers, the only RAM painting it
+// can change
+bool CSusie::LineUnpainted(ULONG start,ULONG end)
+{
+   ULONG const size=SCREEN_HEIGHT*(SCREEN_WIDTH/2);
+   return end>=start &&
+          (end<=mVIDBAS.Word || start>=mVIDBAS.Word+size) &&
+          (end<=mCOLLBAS.Word || start>=mCOLLBAS.Word+size);
+}
+
+void CSusie::SetSpriteCache(bool cache)
+{
+   if(cache==(mSpriteCache!=NULL)) return;
+   delete[] mSpriteCache;
+   delete[] mSpriteCachePixel;
+   delete[] mSpriteCacheCount;
+   mSpriteCache=NULL;
+   mSpriteCachePixel=NULL;
+   mSpriteCacheCount=NULL;
+   if(cache) {
+      mSpriteCache=new CSusieCachedLine[SPRITE_CACHE_LINES];
+      mSpriteCachePixel=new UBYTE[SPRITE_CACHE_RUNS];
+      mSpriteCacheCount=new UBYTE[SPRITE_CACHE_RUNS];
+      SpriteCacheFlush();
+   }
+}
+
+void CSusie::SpriteCacheFlush(void)
+{
+   if(!mSpriteCache) return;
+   for(int index=0;index<SPRITE_CACHE_LINES;index++) mSpriteCache[index].runs=-1;
+   mSpriteCacheUsed=0;
+}
+
+// Where a line is kept, if it is
+#define SPRITE_CACHE_INDEX(start)	(((start)^((start)>>10))&(SPRITE_CACHE_LINES-1))
+
+// Sets the line at mSPRDLINE up just like LineDecode() would when the
+// cache has it for this sprite's pixel depth, literal flag and pens and
+// nothing wrote to its data since
+bool CSusie::SpriteCacheFind(void)
+{
+   ULONG const start=mSPRDLINE.Word;
+   CSusieCachedLine &line=mSpriteCache[SPRITE_CACHE_INDEX(start)];
+   C65C02 &cpu=*mSystem.mCpu;
+
+   if(line.runs<0 || line.start!=start ||
+      line.bits!=mSPRCTL0_PixelBits || line.literal!=mSPRCTL1_Literal ||
+      memcmp(line.pens,mPenIndex,sizeof(line.pens)) ||
+      line.generation[0]!=cpu.GetPageGeneration(start>>8) ||
+      line.generation[1]!=cpu.GetPageGeneration((line.end-1)>>8) ||
+      !LineUnpainted(start,line.end)) {
+      mStats.cache_misses++;
+      return FALSE;
+   }
+
+   mLineRuns=line.runs;
+   mLineRunPixels=line.pixels;
+   mLineRunCycles=line.cycles;
+   memcpy(mLineRunPixel,mSpriteCachePixel+line.first,line.runs);
+   memcpy(mLineRunCount,mSpriteCacheCount+line.first,line.runs);
+   mLineEndTMPADR=line.end;
+   mLineEndType=line.type;
+   mLineEndShiftRegCount=line.shift_reg_count;
+   mLineEndShiftReg=line.shift_reg;
+   mLineEndRepeatCount=line.repeat_count;
+   mLineEndPacketBitsLeft=line.packet_bits_left;
+   mStats.cache_hits++;
+   return TRUE;
+}
+
+// Keeps the line LineDecode() just decoded. Data the CPU only reaches
+// through the memory map, above $FC00, isn't watched for writes and so
+// never kept.
+void CSusie::SpriteCacheAdd(void)
+{
+   ULONG const start=mSPRDLINE.Word;
+   ULONG const end=mLineEndTMPADR;
+   if(end>SUSIE_START) return;
+
+   if(mSpriteCacheUsed+mLineRuns>SPRITE_CACHE_RUNS) SpriteCacheFlush();
+
+   CSusieCachedLine &line=mSpriteCache[SPRITE_CACHE_INDEX(start)];
+   C65C02 &cpu=*mSystem.mCpu;
+
+   cpu.MarkSpriteData(start,end);
+   line.runs=mLineRuns;
+   line.first=mSpriteCacheUsed;
+   line.pixels=mLineRunPixels;
+   line.cycles=mLineRunCycles;
+   line.start=(UWORD)start;
+   line.end=(UWORD)end;
+   line.bits=(UBYTE)mSPRCTL0_PixelBits;
+   line.literal=(UBYTE)mSPRCTL1_Literal;
+   memcpy(line.pens,mPenIndex,sizeof(line.pens));
+   line.generation[0]=cpu.GetPageGeneration(start>>8);
+   line.generation[1]=cpu.GetPageGeneration((end-1)>>8);
+   line.type=mLineEndType;
+   line.shift_reg_count=mLineEndShiftRegCount;
+   line.shift_reg=mLineEndShiftReg;
+   line.repeat_count=mLineEndRepeatCount;
+   line.packet_bits_left=mLineEndPacketBitsLeft;
+
+   memcpy(mSpriteCachePixel+line.first,mLineRunPixel,mLineRuns);
+   memcpy(mSpriteCacheCount+line.first,mLineRunCount,mLineRuns);
+   mSpriteCacheUsed+=mLineRuns;
+}
+
+// Leaves everything as if the line had been decoded again for row 'voff'
+void CSusie::LineReplay(ULONG voff)
+{
+   mTMPADR.Word=mLineEndTMPADR;
+   mLineType=mLineEndType;
+   mLineShiftRegCount=mLineEndShiftRegCount;
+   mLineShiftReg=mLineEndShiftReg;
+   mLineRepeatCount=mLineEndRepeatCount;
+   mLinePacketBitsLeft=mLineEndPacketBitsLeft;
+   mLinePixel=LINE_END;
+   mCyclesUsed+=mLineRunCycles;
+
+   mLineBaseAddress=mVIDBAS.Word+(voff*(SCREEN_WIDTH/2));
+   mLineCollisionAddress=mCOLLBAS.Word+(voff*(SCREEN_WIDTH/2));
+}
+
 inline ULONG CSusie::LineGetPixel()
 {
    if(!mLineRepeatCount) {
@@ -1290,7 +1856,7 @@ inline ULONG CSusie::LineGetBits(ULONG bits)
       mLineShiftRegCount+=24;
 
       // Increment cycle count for the read
-      cycles_used+=3*SPR_RDWR_CYC;
+      mCyclesUsed+=3*SPR_RDWR_CYC;
    }
 
    // Extract the return value
@@ -56,6 +56,16 @@ class CSystem;
 
 #define LINE_END		0x80
 
+// Pixel runs a decoded sprite line can hold, longer lines aren't cached
+#define LINE_RUNS_MAX	2048
+#define LINE_RUNS_NONE	-1		// Not decoded yet
+#define LINE_RUNS_UNCACHED	-2	// Decoded every time, see LineDecode()
+#define SPAN_BUFFER_MIN	32		// Shortest unscaled line painted through mSpanPixel
+
+// What the sprite cache holds, see CSusie::SetSpriteCache()
+#define SPRITE_CACHE_LINES	1024	// Decoded lines, a power of two
+#define SPRITE_CACHE_RUNS	(64*1024)	// Pixel runs of all of them together
+
 //
 // Define button values
 //
@@ -83,6 +93,44 @@ enum {sprite_background_shadow=0,
    sprite_xor_shadow,
    sprite_shadow};
 
+// What the sprite engine did since its stats were last cleared
+struct CSusieStats
+{
+   ULONG paints;				// PaintSprites() runs, one per SPRGO
+   ULONG sprites;				// SCBs processed
+   ULONG skipped;				// ...of them with the skip bit set
+   ULONG superclipped;			// ...of them drawn with superclipping
+   ULONG pixels;				// Screen pixels written
+   ULONG collision_reads;		// Collision buffer pixels read
+   ULONG collision_writes;		// ...and written
+   ULONG cache_hits;			// Lines the sprite cache had decoded already
+   ULONG cache_misses;			// ...and had to be decoded for it
+   uint64_t cycles;				// Emulated cycles the CPU slept for them
+   uint64_t host_ns;			// Host time spent in PaintSprites()
+};
+
+// A sprite line in the sprite cache, decoded into pixel runs along with
+// what LineReplay() needs. It's good for as long as the generations of
+// the pages its data came from stay the same, see C65C02::MarkSpriteData().
+struct CSusieCachedLine
+{
+   int runs;					// -1 when the entry is free
+   ULONG first;					// Where its runs are in the cache
+   ULONG pixels;
+   ULONG cycles;
+   UWORD start;					// mSPRDLINE
+   UWORD end;					// Just past the last byte read
+   UBYTE bits;					// mSPRCTL0_PixelBits
+   UBYTE literal;				// mSPRCTL1_Literal
+   UBYTE pens[16];				// mPenIndex
+   ULONG generation[2];			// Of the pages 'start' and 'end'-1 are in
+   ULONG type;
+   ULONG shift_reg_count;
+   ULONG shift_reg;
+   ULONG repeat_count;
+   ULONG packet_bits_left;
+};
+
 // Define register typdefs
 
 typedef struct 
@@ -336,14 +384,41 @@ class CSusie : public CLynxBase
 
       ULONG	PaintSprites(void);
 
+      inline const CSusieStats& GetStats(void) { return mStats; }
+      inline void ClearStats(void) { memset(&mStats,0,sizeof(mStats)); }
+
+      // Keeps the sprite lines it decodes, so graphics drawn again and
+      // again don't have to be unpacked every time, for as long as the RAM
+      // they came from isn't written. Off by default.
+      void	SetSpriteCache(bool cache);
+      inline bool GetSpriteCache(void) { return mSpriteCache!=NULL; }
+
    private:
       void	DoMathDivide(void);
       void	DoMathMultiply(void);
       ULONG	LineInit(ULONG voff);
       ULONG	LineGetPixel(void);
       ULONG	LineGetBits(ULONG bits);
-
-      void	ProcessPixel(ULONG hoff,ULONG pixel);
+      bool	LineDecode(ULONG voff);
+      void	LineReplay(ULONG voff);
+      bool	LineUnpainted(ULONG start,ULONG end);
+      bool	SpriteCacheFind(void);
+      void	SpriteCacheAdd(void);
+      void	SpriteCacheFlush(void);
+
+      // One line painter per sprite type, collisions on or off and
+      // direction, see PaintLine()
+      typedef bool (CSusie::*TPaintLine)(void);
+      static const TPaintLine mPaintLines[8][2][2];
+
+      template<int type,bool collide,int hsign> bool PaintLine(void);
+      template<int type,bool collide,int hsign,bool buffer> bool PaintPixels(ULONG pixel,int width,bool spans);
+      template<int type,bool collide> void PaintSpan(int hoff,int count,ULONG pixel);
+      template<int type,bool collide> void MergeSpan(int lo,int hi);
+      template<bool exclusive_or> void FillNibbles(ULONG base,int hoff,int count,ULONG pixel);
+      int		MaxCollision(int hoff,int count);
+
+      template<int type,bool collide> void ProcessPixel(ULONG hoff,ULONG pixel);
       void	WritePixel(ULONG hoff,ULONG pixel);
       ULONG	ReadPixel(ULONG hoff);
       void	WriteCollision(ULONG hoff,ULONG pixel);
@@ -439,6 +514,29 @@ class CSusie : public CLynxBase
       ULONG		mLineBaseAddress;
       ULONG		mLineCollisionAddress;
 
+      // The source line of a vertically scaled sprite, decoded once and
+      // replayed for every row it's drawn on. The decoder's state at the
+      // end of the line and the cycles it took are replayed with it.
+      int			mLineRuns;
+      UBYTE		mLineRunPixel[LINE_RUNS_MAX];
+      UBYTE		mLineRunCount[LINE_RUNS_MAX];
+      ULONG		mLineRunCycles;
+      ULONG		mLineRunPixels;
+      UWORD		mLineEndTMPADR;
+      ULONG		mLineEndType;
+      ULONG		mLineEndShiftRegCount;
+      ULONG		mLineEndShiftReg;
+      ULONG		mLineEndRepeatCount;
+      ULONG		mLineEndPacketBitsLeft;
+
+      // Decoded lines kept from one sprite to the next, NULL when the
+      // sprite cache is off. Their runs are in the two arrays, handed out
+      // from the start again when they're full.
+      CSusieCachedLine *mSpriteCache;
+      UBYTE		*mSpriteCachePixel;
+      UBYTE		*mSpriteCacheCount;
+      ULONG		mSpriteCacheUsed;
+
       // Joystick switches
 
       TJOYSTICK	mJOYSTICK;
@@ -446,6 +544,7 @@ class CSusie : public CLynxBase
 
 
       // State within PaintSprites()
+      ULONG mCyclesUsed=0;  // ex-global, per console so several can paint at once
       int mPixelHeight=0;  // ex-static
       int mPixelWidth=0;  // ex-static
       int mPixel=0;  // ex-static
@@ -455,6 +554,13 @@ class CSusie : public CLynxBase
       int mQuadOffV=0;  // ex-static
       int mQuadOffH=0;  // ex-static
 
+      CSusieStats mStats={};
+
+      // The pixels of the row being painted, merged into the screen and
+      // collision buffers at the end of it, see MergeSpan()
+      UBYTE mSpanPixel[SCREEN_WIDTH];
+      int mSpanLo=0,mSpanHi=0;
+
 };
 
 #endif
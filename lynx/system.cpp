@@ -122,6 +122,8 @@ CSystem::CSystem(const char *gamefile,
    UBYTE *howard_memory     = NULL;
    ULONG howard_memory_size = 0;
 
+   ID=player_id;
+
    // Select the default filetype
    mFileType=HANDY_FILETYPE_ILLEGAL;
 
@@ -283,6 +285,51 @@ CSystem::CSystem(const char *gamefile,
    mEEPROM->Load();
 }
 
+CSystem::CSystem(CSystem &origin, int player_id)
+ : mCart(NULL),
+   mRom(NULL),
+   mMemMap(NULL),
+   mRam(NULL),
+   mCpu(NULL),
+   mMikie(NULL),
+   mSusie(NULL),
+   mEEPROM(NULL)
+{
+   ID=player_id;
+   mFileType=origin.mFileType;
+   mCycleCountBreakpoint=origin.mCycleCountBreakpoint;
+
+   // Take over the loaded BIOS, cartridge and EEPROM as they are, there
+   // is no need to find, check and decrypt all of that again
+
+   mRom = new CRom(*origin.mRom);
+   mEEPROM = new CEEPROM(*origin.mEEPROM);
+   mCart = new CCart(*this, *origin.mCart);
+   mRam = new CRam(*this, *origin.mRam);
+   mMikie = new CMikie(*this);
+   mSusie = new CSusie(*this);
+   mMemMap = new CMemMap(*this);
+   mCpu = new C65C02(*this);
+
+   Reset();
+
+   // Then bring everything else in line with the original through a snapshot
+
+   LSS_FILE fp;
+   ULONG size=origin.ContextSize();
+   UBYTE *snapshot=new UBYTE[size];
+
+   fp.memptr      = snapshot;
+   fp.index       = 0;
+   fp.index_limit = size;
+   fp.nul_stream  = 0;
+
+   origin.ContextSave(&fp);
+   ContextLoad(&fp);
+
+   delete[] snapshot;
+}
+
 void CSystem::SaveEEPROM(void)
 {
    if(mEEPROM!=NULL) mEEPROM->Save();
@@ -304,6 +351,9 @@ CSystem::~CSystem()
 
 void CSystem::Update(void)
 {
+   // A debugger breakpoint stops the CPU until someone clears the hit
+   if(mBreakpointHit) return;
+
    // Only update if there is a predicted timer event
    if(mSystemCycleCount>=mNextTimerEvent) 
       mMikie->Update();
@@ -315,6 +365,31 @@ void CSystem::Update(void)
       mSystemCycleCount=mNextTimerEvent;
 }
 
+void CSystem::RunUntil(ULONG target)
+{
+   // A debugger breakpoint stops the run until someone clears the hit
+   while((int32_t)(mSystemCycleCount-target)<0 && !mBreakpointHit) {
+      if(mSystemCycleCount>=mNextTimerEvent)
+         mMikie->Update();
+      mCpu->Run(target);
+
+      if(mSystemCPUSleep)
+         mSystemCycleCount=mNextTimerEvent;
+   }
+}
+
+void CSystem::SetCycleBreakpoint(ULONG breakpoint)
+{
+   mCycleCountBreakpoint=breakpoint;
+   mCpu->DebugArm();
+}
+
+void CSystem::SetSingleStepMode(bool step)
+{
+   mSingleStepMode=step;
+   mCpu->DebugArm();
+}
+
 void CSystem::Overclock(void)
 {
    if(mSystemCPUSleep) return;
@@ -351,6 +426,7 @@ void CSystem::HLE_BIOS_FE19(void)
    // (not) initial jump from reset vector
    // Clear full 64k memory!
    mRam->Clear();
+   mCpu->FlushCode();	// Nothing the CPU decoded is left
 
    // Set Load adresse to $200 ($05,$06)
    mRam->Poke(0x0005,0x00);
@@ -378,8 +454,10 @@ void CSystem::HLE_BIOS_FE4A(void)
 
    lynx_decrypt(res, buff, 51);
 
+   // Tell the CPU, that may overwrite code it translated or predecoded
    for (int i = 0; i < 50*blockcount; ++i) {
-      Poke_CPU(addr++, res[i]);
+      Poke_CPU(addr, res[i]);
+      mCpu->RamWritten(addr++);
    }
 
    // Load Block(s), decode to ($05,$06)
@@ -114,6 +114,7 @@ struct C6502_REGS;   // fwd decl
 #define TOP_START   0xfc00
 #define TOP_MASK    0x03ff
 #define TOP_SIZE    0x400
+#define TOP_PAGES   (TOP_SIZE>>8)
 #define SYSTEM_SIZE 65536
 
 #define LSS_VERSION_OLD "LSS2"
@@ -129,6 +130,7 @@ class CSystem
               bool useEmu,
               const char *eepromfile, 
               int player_id);
+      CSystem(CSystem &origin, int player_id);
       ~CSystem();
     void SaveEEPROM(void);
       uint8_t ID = 0;
@@ -145,6 +147,10 @@ class CSystem
 
       void Update(void);
 
+      // Same as calling Update() until the cycle count reaches 'target',
+      // but the CPU only comes back out for the timers.
+      void RunUntil(ULONG target);
+
       void Overclock(void);
 
       inline void FetchAudioSamples(void)
@@ -165,10 +171,24 @@ class CSystem
       //
       // CPU
       //
-      inline void  Poke_CPU(ULONG addr, UBYTE data) { mMemoryHandlers[addr]->Poke(addr,data);};
-      inline UBYTE Peek_CPU(ULONG addr) { return mMemoryHandlers[addr]->Peek(addr);};
-      inline void  PokeW_CPU(ULONG addr,UWORD data) { mMemoryHandlers[addr]->Poke(addr,data&0xff);addr++;mMemoryHandlers[addr]->Poke(addr,data>>8);};
-      inline UWORD PeekW_CPU(ULONG addr) {return ((mMemoryHandlers[addr]->Peek(addr))+(mMemoryHandlers[addr]->Peek(addr+1)<<8));};
+      // Everything below $FC00 is RAM. Above it Suzy, Mikey and the ROM are
+      // switched in per page by CMemMap, except for the last few bytes:
+      // $FFF8 is always RAM, $FFF9 is the map register itself and the
+      // vectors at $FFFA-$FFFF are switched on their own.
+      //
+      inline CLynxBase* MemoryHandler(ULONG addr)
+      {
+         if(addr<TOP_START) return mRam;
+         if(addr<0xfff8) return mTopPageHandlers[(addr>>8)&(TOP_PAGES-1)];
+         if(addr==0xfff9) return mMemMap;
+         if(addr<0xfffa) return mRam;
+         return mVectorHandler;
+      };
+
+      inline void  Poke_CPU(ULONG addr, UBYTE data) { MemoryHandler(addr)->Poke(addr,data);};
+      inline UBYTE Peek_CPU(ULONG addr) { return MemoryHandler(addr)->Peek(addr);};
+      inline void  PokeW_CPU(ULONG addr,UWORD data) { MemoryHandler(addr)->Poke(addr,data&0xff);addr++;MemoryHandler(addr)->Poke(addr,data>>8);};
+      inline UWORD PeekW_CPU(ULONG addr) {CLynxBase *handler=MemoryHandler(addr); return ((handler->Peek(addr))+(handler->Peek(addr+1)<<8));};
 
       //
       // RAM
@@ -216,24 +236,38 @@ class CSystem
          mMikie->DisplaySetAttributes(rotate, format, pitch, callback, objref); 
       };
 
+      bool   DisplayDirty(void) { return mMikie->DisplayDirty(); };
+      void   DisplayClearDirty(void) { mMikie->DisplayClearDirty(); };
+      void   SetDisplaySimd(bool simd) { mMikie->SetDisplaySimd(simd); };
+
       void   ComLynxCable(int status) { mMikie->ComLynxCable(status); };
       void   ComLynxRxData(int data)  { mMikie->ComLynxRxData(data); };
-      void   ComLynxTxCallback(void (*function)(int data, ULONG objref), ULONG objref) { mMikie->ComLynxTxCallback(function, objref); };
+      void   ComLynxTxCallback(CMikie::ComLynxCallback function, ULONG objref) { mMikie->ComLynxTxCallback(function, objref); };
 
       // Suzy system interfacing
 
       ULONG  PaintSprites(void) {return mSusie->PaintSprites();};
+      const CSusieStats& GetSpriteStats(void) {return mSusie->GetStats();};
+      void   ClearSpriteStats(void) {mSusie->ClearStats();};
+      void   SetSpriteCache(bool cache) {mSusie->SetSpriteCache(cache);};
 
       // Miscellaneous
 
       void   SetButtonData(ULONG data) {mSusie->SetButtonData(data);};
       ULONG  GetButtonData(void) {return mSusie->GetButtonData();};
-      void   SetCycleBreakpoint(ULONG breakpoint) {mCycleCountBreakpoint=breakpoint;};
+      void   SetCycleBreakpoint(ULONG breakpoint);
+      void   ClearCycleBreakpoint(void) {SetCycleBreakpoint(0xffffffff);};
+      void   SetSingleStepMode(bool step);
+
+      // Set when the debugger stopped the CPU, see C65C02::SetDebugCallback()
+      bool   GetBreakpointHit(void) {return mBreakpointHit;};
+      void   SetBreakpointHit(bool hit) {mBreakpointHit=hit;};
       UBYTE* GetRamPointer(void) {return mRam->GetRamPointer();};
 
    public:
       ULONG         mCycleCountBreakpoint;
-      CLynxBase     *mMemoryHandlers[SYSTEM_SIZE];
+      CLynxBase     *mTopPageHandlers[TOP_PAGES];
+      CLynxBase     *mVectorHandler;
       CCart         *mCart;
       CRom          *mRom;
       CMemMap       *mMemMap;
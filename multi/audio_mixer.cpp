@@ -0,0 +1,137 @@
+// MIT License
+//
+// Copyright (c) 2024 superKoder (github.com/superKoder/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The ABOVE COPYRIGHT notice and this permission notice SHALL BE INCLUDED in all
+// copies or substantial portions of the Software.
+//
+// The software is provided "as is", without warranty of any kind, express or
+// implied, including but not limited to the warranties of merchantability,
+// fitness for a particular purpose and noninfringement. In no event shall the
+// authors or copyright holders be liable for any claim, damages or other
+// liability, whether in an action of contract, tort or otherwise, arising from,
+// out of or in connection with the software or the use or other dealings in the
+// software.
+
+#include "audio_mixer.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HANDY_MP_MIX_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define HANDY_MP_MIX_NEON
+#endif
+
+// kFullGain is taken to mean 1.0 exactly, so a console at full volume
+// comes out unchanged rather than a hair quieter.
+static inline int16_t ScaleSample(int16_t sample, int16_t gain) {
+    if (gain == AudioMixer::kFullGain) {
+        return sample;
+    }
+    return static_cast<int16_t>((int32_t{sample} * gain) >> 15);
+}
+
+static inline int16_t AddSaturated(int16_t a, int16_t b) {
+    return static_cast<int16_t>(std::clamp(int32_t{a} + b, -32768, 32767));
+}
+
+static void MixScalar(int16_t *out, int16_t const *in, size_t count, int16_t left, int16_t right) {
+    for (size_t i = 0; i + 1 < count; i += 2) {
+        out[i] = AddSaturated(out[i], ScaleSample(in[i], left));
+        out[i + 1] = AddSaturated(out[i + 1], ScaleSample(in[i + 1], right));
+    }
+}
+
+static void Mix(int16_t *out, int16_t const *in, size_t count, int16_t left, int16_t right) {
+    size_t i = 0;
+#if defined(HANDY_MP_MIX_SSE2)
+    // 8 samples (4 stereo frames) per step. The full 32 bit products are
+    // put back together from mulhi and mullo to get an exact >> 15.
+    __m128i const gain = _mm_set1_epi32(static_cast<int32_t>((uint32_t(uint16_t(right)) << 16) | uint16_t(left)));
+    __m128i const unity = _mm_cmpeq_epi16(gain, _mm_set1_epi16(AudioMixer::kFullGain));
+    for (; i + 8 <= count; i += 8) {
+        __m128i const s = _mm_loadu_si128(reinterpret_cast<__m128i const *>(in + i));
+        __m128i const hi = _mm_mulhi_epi16(s, gain);
+        __m128i const lo = _mm_mullo_epi16(s, gain);
+        __m128i scaled = _mm_or_si128(_mm_slli_epi16(hi, 1), _mm_srli_epi16(lo, 15));
+        scaled = _mm_or_si128(_mm_and_si128(unity, s), _mm_andnot_si128(unity, scaled));
+        __m128i const acc = _mm_loadu_si128(reinterpret_cast<__m128i const *>(out + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_adds_epi16(acc, scaled));
+    }
+#elif defined(HANDY_MP_MIX_NEON)
+    // vqdmulh is (2 * s * g) >> 16, which is the same as (s * g) >> 15
+    int16_t const gains[8] = {left, right, left, right, left, right, left, right};
+    int16x8_t const gain = vld1q_s16(gains);
+    uint16x8_t const unity = vceqq_s16(gain, vdupq_n_s16(AudioMixer::kFullGain));
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t const s = vld1q_s16(in + i);
+        int16x8_t const scaled = vbslq_s16(unity, s, vqdmulhq_s16(s, gain));
+        vst1q_s16(out + i, vqaddq_s16(vld1q_s16(out + i), scaled));
+    }
+#endif
+    MixScalar(out + i, in + i, count - i, left, right);
+}
+
+AudioMixer::AudioMixer(size_t capacity)
+    : buffer_(capacity) {
+}
+
+void AudioMixer::SetPlayerCount(int players) {
+    gains_.resize(players);
+}
+
+void AudioMixer::SetPlayerGain(int player, float volume, float pan) {
+    volume = std::clamp(volume, 0.0f, 1.0f);
+    pan = std::clamp(pan, -1.0f, 1.0f);
+    auto &gain = gains_[player];
+    gain.left = static_cast<int16_t>(kFullGain * volume * std::min(1.0f, 1.0f - pan));
+    gain.right = static_cast<int16_t>(kFullGain * volume * std::min(1.0f, 1.0f + pan));
+}
+
+bool AudioMixer::IsPlayerAudible(int player) const {
+    return gains_[player].left || gains_[player].right;
+}
+
+void AudioMixer::Begin(size_t count) {
+    size_ = std::min(count, buffer_.size());
+    std::fill_n(buffer_.begin(), size_, int16_t{0});
+    empty_ = true;
+}
+
+void AudioMixer::Add(int player, int16_t const *samples, size_t count) {
+    auto const &gain = gains_[player];
+    if (!gain.left && !gain.right) {
+        return;
+    }
+    count = std::min(count, size_);
+    if (empty_ && gain.left == kFullGain && gain.right == kFullGain) {
+        // The common single player case, nothing to scale or add to
+        std::memcpy(buffer_.data(), samples, count * sizeof(int16_t));
+    } else {
+        Mix(buffer_.data(), samples, count, gain.left, gain.right);
+    }
+    empty_ = false;
+}
+
+int16_t *AudioMixer::Buffer() {
+    return buffer_.data();
+}
+
+size_t AudioMixer::Size() const {
+    return size_;
+}
+
+void AudioMixer::Truncate(size_t size) {
+    size_ = std::min(size_, size);
+}
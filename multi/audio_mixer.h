@@ -0,0 +1,77 @@
+// MIT License
+//
+// Copyright (c) 2024 superKoder (github.com/superKoder/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The ABOVE COPYRIGHT notice and this permission notice SHALL BE INCLUDED in all
+// copies or substantial portions of the Software.
+//
+// The software is provided "as is", without warranty of any kind, express or
+// implied, including but not limited to the warranties of merchantability,
+// fitness for a particular purpose and noninfringement. In no event shall the
+// authors or copyright holders be liable for any claim, damages or other
+// liability, whether in an action of contract, tort or otherwise, arising from,
+// out of or in connection with the software or the use or other dealings in the
+// software.
+
+#ifndef HANDY_MP_AUDIO_MIXER_H_
+#define HANDY_MP_AUDIO_MIXER_H_
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Mixes the interleaved 16 bit stereo output of several consoles into one
+ * buffer, with a separate left and right gain for every console.
+ *
+ * Gains are Q15 fixed point (0x7fff is full volume) and sums saturate
+ * instead of wrapping around. The SSE2 and NEON paths produce exactly
+ * the same samples as the plain C++ one.
+ */
+class AudioMixer
+{
+public:
+    static constexpr int16_t kFullGain = 0x7fff;
+
+    explicit AudioMixer(size_t capacity);
+
+    void SetPlayerCount(int players);
+
+    /**
+     * `volume` goes from 0 to 1, `pan` from -1 (left) to 1 (right).
+     */
+    void SetPlayerGain(int player, float volume, float pan);
+    bool IsPlayerAudible(int player) const;
+
+    /**
+     * Starts a new batch of `count` samples, all silent.
+     */
+    void Begin(size_t count);
+    void Add(int player, int16_t const *samples, size_t count);
+
+    int16_t *Buffer();
+    size_t Size() const;
+    void Truncate(size_t size);
+
+private:
+    struct Gain
+    {
+        int16_t left = kFullGain;
+        int16_t right = kFullGain;
+    };
+
+    std::vector<Gain> gains_;
+    std::vector<int16_t> buffer_;
+    size_t size_ = {};
+    bool empty_ = true;
+};
+
+#endif // HANDY_MP_AUDIO_MIXER_H_
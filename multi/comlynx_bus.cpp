@@ -0,0 +1,91 @@
+// MIT License
+//
+// Copyright (c) 2024 superKoder (github.com/superKoder/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The ABOVE COPYRIGHT notice and this permission notice SHALL BE INCLUDED in all
+// copies or substantial portions of the Software.
+//
+// The software is provided "as is", without warranty of any kind, express or
+// implied, including but not limited to the warranties of merchantability,
+// fitness for a particular purpose and noninfringement. In no event shall the
+// authors or copyright holders be liable for any claim, damages or other
+// liability, whether in an action of contract, tort or otherwise, arising from,
+// out of or in connection with the software or the use or other dealings in the
+// software.
+
+#include "comlynx_bus.h"
+
+#include "system.h"
+
+bool ComLynxBus::Ring::Push(int value) {
+    uint32_t const h = head.load(std::memory_order_relaxed);
+    if (h - tail.load(std::memory_order_acquire) == kRingSize) {
+        // Receiver is not keeping up, a real UART would overrun as well
+        return false;
+    }
+    data[h % kRingSize] = value;
+    head.store(h + 1, std::memory_order_release);
+    return true;
+}
+
+bool ComLynxBus::Ring::Pop(int &value) {
+    uint32_t const t = tail.load(std::memory_order_relaxed);
+    if (t == head.load(std::memory_order_acquire)) {
+        return false;
+    }
+    value = data[t % kRingSize];
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+}
+
+ComLynxBus::ComLynxBus(int players)
+    : players_{players}
+    , rings_(players * players)
+    , pending_(players) {
+}
+
+void ComLynxBus::Attach(std::vector<CSystem *> const &systems) {
+    for (size_t player = 0; player < systems.size(); ++player) {
+        systems[player]->ComLynxCable(1);
+        systems[player]->ComLynxTxCallback([this](int data, ULONG objref) {
+            Transmit(static_cast<int>(objref), data);
+        }, static_cast<ULONG>(player));
+    }
+}
+
+void ComLynxBus::Transmit(int sender, int data) {
+    for (int receiver = 0; receiver < players_; ++receiver) {
+        if (receiver == sender) {
+            continue;
+        }
+        // Count first, so the receiver never sees more bytes than pending
+        auto &pending = pending_[receiver].count;
+        pending.fetch_add(1, std::memory_order_relaxed);
+        if (!RingFor(sender, receiver).Push(data)) {
+            pending.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+void ComLynxBus::Deliver(int receiver, CSystem &system) {
+    if (!HasPending(receiver)) {
+        return;
+    }
+    for (int sender = 0; sender < players_; ++sender) {
+        if (sender == receiver) {
+            continue;
+        }
+        int data;
+        while (RingFor(sender, receiver).Pop(data)) {
+            system.ComLynxRxData(data);
+            pending_[receiver].count.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+}
@@ -0,0 +1,100 @@
+// MIT License
+//
+// Copyright (c) 2024 superKoder (github.com/superKoder/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The ABOVE COPYRIGHT notice and this permission notice SHALL BE INCLUDED in all
+// copies or substantial portions of the Software.
+//
+// The software is provided "as is", without warranty of any kind, express or
+// implied, including but not limited to the warranties of merchantability,
+// fitness for a particular purpose and noninfringement. In no event shall the
+// authors or copyright holders be liable for any claim, damages or other
+// liability, whether in an action of contract, tort or otherwise, arising from,
+// out of or in connection with the software or the use or other dealings in the
+// software.
+
+#ifndef HANDY_MP_COMLYNX_BUS_H_
+#define HANDY_MP_COMLYNX_BUS_H_
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class CSystem;
+
+/**
+ * The ComLynx cable between all consoles.
+ *
+ * Whatever a console transmits is put in a receive ring of every other
+ * console, one ring per sender and receiver pair. That makes each ring
+ * single-producer/single-consumer, so consoles can transmit and receive
+ * from different threads without locks. A byte costs O(players) and
+ * nothing is ever allocated after construction.
+ */
+class ComLynxBus
+{
+public:
+    explicit ComLynxBus(int players);
+
+    ComLynxBus(ComLynxBus const &) = delete;
+    ComLynxBus &operator=(ComLynxBus const &) = delete;
+
+    /**
+     * Connects the consoles to the bus, the bus must outlive them.
+     */
+    void Attach(std::vector<CSystem *> const &systems);
+
+    /**
+     * Called from the thread running `sender`.
+     */
+    void Transmit(int sender, int data);
+
+    /**
+     * Hands everything that was sent to `receiver` to its UART. Must be
+     * called from the thread running `receiver`.
+     */
+    void Deliver(int receiver, CSystem &system);
+
+    bool HasPending(int receiver) const {
+        return pending_[receiver].count.load(std::memory_order_acquire) != 0;
+    }
+
+private:
+    // Same depth as the UART's own receive queue
+    static constexpr uint32_t kRingSize = 32;
+
+    struct Ring
+    {
+        bool Push(int data);
+        bool Pop(int &data);
+
+        std::array<int, kRingSize> data = {};
+        alignas(64) std::atomic<uint32_t> head = {};
+        alignas(64) std::atomic<uint32_t> tail = {};
+    };
+
+    struct alignas(64) Pending
+    {
+        std::atomic<uint32_t> count = {};
+    };
+
+    Ring &RingFor(int sender, int receiver) {
+        return rings_[receiver * players_ + sender];
+    }
+
+    int const players_;
+    std::vector<Ring> rings_;
+    std::vector<Pending> pending_;
+};
+
+#endif // HANDY_MP_COMLYNX_BUS_H_
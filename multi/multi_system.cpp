@@ -23,8 +23,7 @@
 #include "multi_system.h"
 
 #include <algorithm>
-#include <chrono>
-#include <thread>
+#include <cstring>
 
 MultiSystem::MultiSystem(Layout layout,
                          FileStreamPath bios_path,
@@ -35,7 +34,9 @@ MultiSystem::MultiSystem(Layout layout,
     , path_bios_{bios_path}
     , path_eeprom_{eeprom_path}
     , use_emu_{use_emu}
-    , cb_button_feed_{button_callback} {
+    , cb_button_feed_{button_callback}
+    , audio_mixer_{HANDY_AUDIO_BUFFER_SIZE / sizeof(int16_t)} {
+    audio_mixer_.SetPlayerCount(std::clamp(layout_.players, 1, 16));
 }
 
 MultiSystem::~MultiSystem() {
@@ -50,45 +51,64 @@ void MultiSystem::BootGame(FileStreamPath game_path,
                            size_t game_size,
                            bool connect_comlynx) {
     int const players = std::clamp(layout_.players, 1, 16);
-    for (int i = 0; i < players; ++i)
-    {
-        systems_.push_back(std::make_unique<CSystem>(game_path,
-                                                     game_data,
-                                                     game_size,
-                                                     path_bios_,
-                                                     use_emu_,
-                                                     path_eeprom_,
-                                                     i));
-
-        // This sleep is to make sure the individual Lynx systems
-        // don't all boot up at once. This is required to decide
-        // player 1, player 2, etc...
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
-    }
+    systems_.push_back(std::make_unique<CSystem>(game_path,
+                                                 game_data,
+                                                 game_size,
+                                                 path_bios_,
+                                                 use_emu_,
+                                                 path_eeprom_,
+                                                 0));
     first_system_ = systems_[0].get();
 
+    // Everyone else starts out as a copy of the first console, that way the
+    // cart, BIOS and EEPROM are only loaded (and checked) once.
+    for (int i = 1; i < players; ++i) {
+        systems_.push_back(std::make_unique<CSystem>(*first_system_, i));
+    }
+
     if (!connect_comlynx) {
         return;
     }
 
-    for (int i = 0; i < players; ++i) {
-        auto &system = systems_[i];
+    std::vector<CSystem *> linked;
+    for (auto &system : systems_) {
+        linked.push_back(system.get());
+    }
+    comlynx_bus_ = std::make_unique<ComLynxBus>(players);
+    comlynx_bus_->Attach(linked);
 
-        // This sleep is to make sure the individual Lynx systems
-        // don't all boot up at once. This is required to decide
-        // player 1, player 2, etc...
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
-        system->Update();
+    // Identical consoles running in lockstep would all make the same choice
+    // when the game works out who is player 1, player 2, etc... So every
+    // player starts one instruction ahead of the one before.
+    for (int i = 0; i < players; ++i) {
+        for (int step = 0; step <= i; ++step) {
+            systems_[i]->Update();
+        }
     }
     comlynx_connected_ = true;
+    UpdateComLynx();
 }
 
 void MultiSystem::UnbootGame() {
     if (comlynx_connected_) {
+        for (auto &system : systems_) {
+            system->ComLynxTxCallback(nullptr, 0);
+            system->ComLynxCable(0);
+        }
+        comlynx_bus_.reset();
         comlynx_connected_ = false;
     }
 }
 
+void MultiSystem::UpdateComLynx() {
+    if (!comlynx_bus_) {
+        return;
+    }
+    for (size_t player = 0; player < systems_.size(); ++player) {
+        comlynx_bus_->Deliver(static_cast<int>(player), *systems_[player]);
+    }
+}
+
 void MultiSystem::Overclock(int times) {
     for (auto &system : systems_) {
         system->Overclock();
@@ -114,8 +134,24 @@ void MultiSystem::UpdateButtons() {
 }
 
 void MultiSystem::FetchAudioSamples() {
-    for (auto &system : systems_) {
-        system->FetchAudioSamples();
+    ForEachSystem([&](size_t player) {
+        systems_[player]->FetchAudioSamples();
+    });
+
+    ULONG samples = 0;
+    for (size_t player = 0; player < systems_.size(); ++player) {
+        if (audio_mixer_.IsPlayerAudible(player)) {
+            samples = std::max(samples, systems_[player]->mAudioBufferPointer);
+        }
+    }
+
+    audio_mixer_.Begin(samples);
+    for (size_t player = 0; player < systems_.size(); ++player) {
+        auto &system = systems_[player];
+        if (audio_mixer_.IsPlayerAudible(player)) {
+            audio_mixer_.Add(player, reinterpret_cast<int16_t const *>(system->mAudioBuffer), system->mAudioBufferPointer);
+        }
+        system->mAudioBufferPointer = 0;
     }
 }
 
@@ -146,6 +182,25 @@ void MultiSystem::DisplaySetAttributes(Layout::Orientation rotate,
     }
 }
 
+bool MultiSystem::IsPlayerDisplayDirty(int player) const {
+    return systems_[player]->DisplayDirty();
+}
+
+bool MultiSystem::IsAnyDisplayDirty() const {
+    for (auto const &system : systems_) {
+        if (system->DisplayDirty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void MultiSystem::ClearDisplayDirty() {
+    for (auto &system : systems_) {
+        system->DisplayClearDirty();
+    }
+}
+
 bool MultiSystem::IsAnySkippingFrame() const {
     for (auto const &system : systems_) {
         if (system->mSkipFrame) {
@@ -170,14 +225,73 @@ void MultiSystem::SetIsSkippingFrame(bool skipping) {
     }
 }
 
+void MultiSystem::SetThreadCount(unsigned threads) {
+    // Thread count includes the frontend's thread, that one always helps out.
+    unsigned const workers = (threads > 1) ? threads - 1 : 0;
+    if (workers == (thread_pool_ ? thread_pool_->WorkerCount() : 0)) {
+        return;
+    }
+    thread_pool_.reset();
+    if (workers) {
+        thread_pool_ = std::make_unique<ThreadPool>(workers);
+    }
+}
+
+unsigned MultiSystem::GetThreadCount() const {
+    return thread_pool_ ? thread_pool_->WorkerCount() + 1 : 1;
+}
+
+void MultiSystem::SetIdleLoopSkip(bool skip) {
+    for (auto &system : systems_) {
+        system->mCpu->SetIdleLoopSkip(skip);
+    }
+}
+
+void MultiSystem::SetPredecode(bool predecode) {
+    for (auto &system : systems_) {
+        system->mCpu->SetPredecode(predecode);
+    }
+}
+
+void MultiSystem::SetJit(bool jit) {
+    for (auto &system : systems_) {
+        system->mCpu->SetJit(jit);
+    }
+}
+
+void MultiSystem::SetSpriteCache(bool cache) {
+    for (auto &system : systems_) {
+        system->SetSpriteCache(cache);
+    }
+}
+
+void MultiSystem::SetDisplaySimd(bool simd) {
+    for (auto &system : systems_) {
+        system->SetDisplaySimd(simd);
+    }
+}
+
+CSusieStats MultiSystem::GetSpriteStats(int player) const {
+    return systems_[player]->GetSpriteStats();
+}
+
+void MultiSystem::ClearSpriteStats() {
+    for (auto &system : systems_) {
+        system->ClearSpriteStats();
+    }
+}
+
 void MultiSystem::NoteLastCycleCounts() {
     for (auto &system : systems_) {
         system->mLastRunCycleCount = system->mSystemCycleCount;
     }
 }
 
+// A console stopped at a debugger breakpoint isn't behind, it sits out
+// the rest of the frame like RunUntil() would have it.
 inline static bool IsBehind(CSystem *system, ULONG cycles_per_frame) {
-    return (system->mSystemCycleCount - system->mLastRunCycleCount) < cycles_per_frame;
+    return (system->mSystemCycleCount - system->mLastRunCycleCount) < cycles_per_frame &&
+           !system->GetBreakpointHit();
 }
 
 inline static bool IsAnyBehind(CSystemVect const &systems, ULONG cycles_per_frame) {
@@ -191,50 +305,191 @@ inline static bool IsAnyBehind(CSystemVect const &systems, ULONG cycles_per_fram
 
 // VERSION 1: CATCH UP TOGETHER!
 void MultiSystem::CatchUpAllSystems(ULONG cycles_per_frame, unsigned overclock) {
+    // Consoles that aren't linked don't affect each other, so each one can
+    // run its whole frame in one go, on its own worker if there are any.
+    if (!comlynx_connected_) {
+        ForEachSystem([&](size_t player) {
+            CatchUpSystem(static_cast<int>(player), cycles_per_frame, overclock);
+        });
+        return;
+    }
+
+    // The ComLynx bus would work across threads, but when and in which
+    // order bytes arrive would then depend on the host's scheduling.
+    // Linked consoles stay in lockstep on one thread to keep replays,
+    // rewind and netplay deterministic.
     while (IsAnyBehind(systems_, cycles_per_frame)) {
-        for (auto &system : systems_) {
-            if (IsBehind(system.get(), cycles_per_frame)) {
+        for (size_t player = 0; player < systems_.size(); ++player) {
+            CSystem *system = systems_[player].get();
+            if (IsBehind(system, cycles_per_frame)) {
                 system->Update();
+                comlynx_bus_->Deliver(static_cast<int>(player), *system);
             }
         }
     }
+
+    // Nothing is left in flight between frames, so savestates don't
+    // need to hold the bus.
+    UpdateComLynx();
 }
 
 // // VERSION 2: DON'T CATCH UP TOGETHER
 void MultiSystem::CatchUpSystem(int player, ULONG cycles_per_frame, unsigned overclock) {
     CSystem *system = systems_[player].get();
+    if (!comlynx_bus_) {
+        system->RunUntil(system->mLastRunCycleCount + cycles_per_frame);
+        return;
+    }
     while (IsBehind(system, cycles_per_frame)) {
         system->Update();
+        comlynx_bus_->Deliver(player, *system);
     }
 }
 
+void MultiSystem::SetPlayerAudio(int player, float volume, float pan) {
+    audio_mixer_.SetPlayerGain(player, volume, pan);
+    SetAudioEnabled(audio_enabled_);
+}
+
 void MultiSystem::SetAudioEnabled(bool enabled) {
-    // TODO: only enabling the first lynx
-    first_system_->mAudioEnabled = enabled;
+    audio_enabled_ = enabled;
+    for (size_t player = 0; player < systems_.size(); ++player) {
+        systems_[player]->mAudioEnabled = enabled && audio_mixer_.IsPlayerAudible(player);
+    }
 }
 
 int16_t *MultiSystem::GetAudioBuffer() {
-    return (int16_t *)(&first_system_->mAudioBuffer);
+    return audio_mixer_.Buffer();
 }
 
 ULONG MultiSystem::GetAudioBufferPointer() {
-    return first_system_->mAudioBufferPointer;
+    return audio_mixer_.Size();
 }
 
 void MultiSystem::SetAudioBufferPointer(ULONG ptr) {
-    first_system_->mAudioBufferPointer = ptr;
+    audio_mixer_.Truncate(ptr);
+}
+
+static char const kContextMagic[] = "HMPS";
+static ULONG const kContextVersion = 1;
+
+void MultiSystem::ForEachSystem(ThreadPool::Job const &job) const {
+    if (thread_pool_) {
+        thread_pool_->RunAndWait(systems_.size(), job);
+        return;
+    }
+    for (size_t player = 0; player < systems_.size(); ++player) {
+        job(player);
+    }
+}
+
+size_t MultiSystem::ContextHeaderSize() const {
+    // magic, version, players, ComLynx, then one section size per player
+    return 4 + (3 + systems_.size()) * sizeof(ULONG);
 }
 
 size_t MultiSystem::ContextSize() const {
-    return first_system_->ContextSize();
+    std::vector<size_t> sizes(systems_.size());
+    ForEachSystem([&](size_t player) {
+        sizes[player] = systems_[player]->ContextSize();
+    });
+
+    size_t total = ContextHeaderSize();
+    for (auto size : sizes) {
+        total += size;
+    }
+    return total;
 }
 
 bool MultiSystem::ContextLoad(LSS_FILE *fp) {
-    return first_system_->ContextLoad(fp);
+    fp->index = 0;
+
+    char magic[5] = {};
+    if (!lss_read(magic, sizeof(char), 4, fp)) {
+        return false;
+    }
+    if (strcmp(magic, kContextMagic) != 0) {
+        // A single console snapshot, like the ones from before there was a header
+        return first_system_->ContextLoad(fp);
+    }
+
+    ULONG version = {};
+    ULONG players = {};
+    ULONG comlynx = {};
+    lss_read(&version, sizeof(ULONG), 1, fp);
+    lss_read(&players, sizeof(ULONG), 1, fp);
+    lss_read(&comlynx, sizeof(ULONG), 1, fp);
+    if (version != kContextVersion || players != systems_.size() || bool(comlynx) != comlynx_connected_) {
+        handy_log(RETRO_LOG_ERROR, "Savestate is for %u players%s, running %u%s, aborting load.\n",
+                  (unsigned)players, comlynx ? " (linked)" : "",
+                  (unsigned)systems_.size(), comlynx_connected_ ? " (linked)" : "");
+        return false;
+    }
+
+    std::vector<LSS_FILE> sections(systems_.size());
+    ULONG offset = ContextHeaderSize();
+    for (auto &section : sections) {
+        ULONG size = {};
+        if (!lss_read(&size, sizeof(ULONG), 1, fp) || offset + size > fp->index_limit) {
+            return false;
+        }
+        section.memptr = fp->memptr + offset;
+        section.index = 0;
+        section.index_limit = size;
+        section.nul_stream = fp->nul_stream;
+        offset += size;
+    }
+
+    std::vector<char> loaded(systems_.size());
+    ForEachSystem([&](size_t player) {
+        loaded[player] = systems_[player]->ContextLoad(&sections[player]);
+    });
+    fp->index = offset;
+
+    return std::all_of(loaded.begin(), loaded.end(), [](char ok) { return ok; });
 }
 
 bool MultiSystem::ContextSave(LSS_FILE *fp) {
-    return first_system_->ContextSave(fp);
+    // Every console gets its own slice of the buffer, so they can all
+    // be written at the same time.
+    std::vector<size_t> sizes(systems_.size());
+    ForEachSystem([&](size_t player) {
+        sizes[player] = systems_[player]->ContextSize();
+    });
+
+    fp->index = 0;
+    ULONG version = kContextVersion;
+    ULONG players = systems_.size();
+    ULONG comlynx = comlynx_connected_;
+    lss_printf(fp, kContextMagic);
+    lss_write(&version, sizeof(ULONG), 1, fp);
+    lss_write(&players, sizeof(ULONG), 1, fp);
+    lss_write(&comlynx, sizeof(ULONG), 1, fp);
+
+    std::vector<LSS_FILE> sections(systems_.size());
+    ULONG offset = ContextHeaderSize();
+    for (size_t player = 0; player < sections.size(); ++player) {
+        ULONG size = sizes[player];
+        lss_write(&size, sizeof(ULONG), 1, fp);
+
+        auto &section = sections[player];
+        section.memptr = fp->nul_stream ? nullptr : fp->memptr + offset;
+        section.index = 0;
+        section.index_limit = size;
+        section.nul_stream = fp->nul_stream;
+        offset += size;
+    }
+    if (offset > fp->index_limit && !fp->nul_stream) {
+        return false;
+    }
+
+    std::vector<char> saved(systems_.size());
+    ForEachSystem([&](size_t player) {
+        saved[player] = systems_[player]->ContextSave(&sections[player]);
+    });
+    fp->index = offset;
+
+    return std::all_of(saved.begin(), saved.end(), [](char ok) { return ok; });
 }
 
 void MultiSystem::SaveEEPROM() {
@@ -252,5 +507,5 @@ UBYTE *MultiSystem::GetRamPointer(void) {
 }
 
 CSystem *MultiSystem::GetSystem(int player) {
-    return systems_[0].get();
+    return systems_[player].get();
 }
@@ -24,8 +24,11 @@
 #define HANDY_MP_MULTI_SYSTEM_H_
 #pragma once
 
+#include "audio_mixer.h"
+#include "comlynx_bus.h"
 #include "handy.h"
 #include "layout.h"
+#include "thread_pool.h"
 
 #include <vector>
 #include <memory>
@@ -85,19 +88,88 @@ public:
                               unsigned pitch,
                               DisplayBufferProvidingCallback buffer_provider);
 
+    /**
+     * A player's screen is dirty when any of its lines came out different
+     * since the last `ClearDisplayDirty()`. Clean screens still hold exactly
+     * what was in the framebuffer back then.
+     */
+    bool IsPlayerDisplayDirty(int player) const;
+    bool IsAnyDisplayDirty() const;
+    void ClearDisplayDirty();
+
     bool IsAnySkippingFrame() const;
     bool IsNoneSkippingFrame() const;
     void SetIsSkippingFrame(bool);
 
+    /**
+     * Opt-in: run each console's frame budget on its own worker.
+     * `threads` counts the calling thread, so 0 or 1 disables threading.
+     */
+    void SetThreadCount(unsigned threads);
+    unsigned GetThreadCount() const;
+
+    /**
+     * Lets the CPUs skip ahead through loops that only wait for the next
+     * timer event, see C65C02::IdleLoop(). Off by default.
+     */
+    void SetIdleLoopSkip(bool skip);
+
+    /**
+     * Has the CPUs keep the instructions they run in a predecode cache,
+     * see C65C02::SetPredecode(). Off by default.
+     */
+    void SetPredecode(bool predecode);
+
+    /**
+     * Runs the CPUs through the 65C02 recompiler where it can, see
+     * C65C02Jit. Off by default, and a no-op where it isn't available.
+     */
+    void SetJit(bool jit);
+
+    /**
+     * Has the sprite engines keep the sprite lines they decode, see
+     * CSusie::SetSpriteCache(). Off by default.
+     */
+    void SetSpriteCache(bool cache);
+
+    /**
+     * Lets the screens be rendered with SSSE3 or NEON where the host has
+     * it, see CMikie::SetDisplaySimd(). On by default.
+     */
+    void SetDisplaySimd(bool simd);
+
+    /**
+     * What a console's sprite engine did since the last
+     * `ClearSpriteStats()`, see CSusieStats. Clearing them every frame
+     * gives per frame counts.
+     */
+    CSusieStats GetSpriteStats(int player) const;
+    void ClearSpriteStats();
+
     void NoteLastCycleCounts();
     void CatchUpAllSystems(ULONG cycles_per_frame, unsigned overclock);
     void CatchUpSystem(int player, ULONG cycles_per_frame, unsigned overclock);
 
+    /**
+     * Every console is mixed into the audio output. `volume` goes from 0
+     * to 1 and `pan` from -1 (left) to 1 (right), consoles that are at 0
+     * volume don't even synthesize their audio.
+     */
+    void SetPlayerAudio(int player, float volume, float pan);
+
     void SetAudioEnabled(bool enabled);
     int16_t *GetAudioBuffer();
     ULONG GetAudioBufferPointer();
     void SetAudioBufferPointer(ULONG);
 
+    /**
+     * Savestates hold every console. They start with a small header (player
+     * count, ComLynx state and the size of each console's section), followed
+     * by one regular LSS snapshot per console. The sections are written and
+     * read in parallel when threading is enabled.
+     *
+     * A plain single console LSS snapshot still loads into player 1.
+     */
     size_t ContextSize() const;
 
     bool ContextLoad(LSS_FILE *fp);
@@ -113,6 +185,9 @@ public:
     CSystem *GetSystem(int player);
 
 private:
+    void ForEachSystem(ThreadPool::Job const &job) const;
+    size_t ContextHeaderSize() const;
+
     Layout const layout_;
     FileStreamPath path_bios_;
     FileStreamPath path_eeprom_;
@@ -122,6 +197,12 @@ private:
     CSystemVect systems_;
     CSystem *first_system_ = {};
     bool comlynx_connected_ = {};
+    std::unique_ptr<ComLynxBus> comlynx_bus_;
+
+    AudioMixer audio_mixer_;
+    bool audio_enabled_ = {};
+
+    std::unique_ptr<ThreadPool> thread_pool_;
 };
 
 #endif // HANDY_MP_MULTI_SYSTEM_H_
@@ -0,0 +1,104 @@
+// MIT License
+//
+// Copyright (c) 2024 superKoder (github.com/superKoder/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The ABOVE COPYRIGHT notice and this permission notice SHALL BE INCLUDED in all
+// copies or substantial portions of the Software.
+//
+// The software is provided "as is", without warranty of any kind, express or
+// implied, including but not limited to the warranties of merchantability,
+// fitness for a particular purpose and noninfringement. In no event shall the
+// authors or copyright holders be liable for any claim, damages or other
+// liability, whether in an action of contract, tort or otherwise, arising from,
+// out of or in connection with the software or the use or other dealings in the
+// software.
+
+#include "thread_pool.h"
+
+ThreadPool::ThreadPool(unsigned workers) {
+    workers_.reserve(workers);
+    for (unsigned i = 0; i < workers; ++i) {
+        workers_.emplace_back([this] { WorkerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_start_.notify_all();
+    for (auto &worker : workers_) {
+        worker.join();
+    }
+}
+
+unsigned ThreadPool::WorkerCount() const {
+    return static_cast<unsigned>(workers_.size());
+}
+
+void ThreadPool::RunAndWait(size_t count, Job const &job) {
+    if (workers_.empty() || count < 2) {
+        for (size_t i = 0; i < count; ++i) {
+            job(i);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job_ = &job;
+        job_count_ = count;
+        next_index_.store(0, std::memory_order_relaxed);
+        busy_workers_ = WorkerCount();
+        ++generation_;
+    }
+    cv_start_.notify_all();
+
+    // The calling thread works too, rather than idling on the barrier.
+    Drain();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_done_.wait(lock, [this] { return busy_workers_ == 0; });
+    job_ = nullptr;
+}
+
+void ThreadPool::WorkerLoop() {
+    uint64_t seen_generation = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_start_.wait(lock, [&] { return stopping_ || generation_ != seen_generation; });
+            if (stopping_) {
+                return;
+            }
+            seen_generation = generation_;
+        }
+
+        Drain();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--busy_workers_ == 0) {
+                cv_done_.notify_one();
+            }
+        }
+    }
+}
+
+void ThreadPool::Drain() {
+    for (;;) {
+        size_t const index = next_index_.fetch_add(1, std::memory_order_relaxed);
+        if (index >= job_count_) {
+            return;
+        }
+        (*job_)(index);
+    }
+}
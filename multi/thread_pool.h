@@ -0,0 +1,82 @@
+// MIT License
+//
+// Copyright (c) 2024 superKoder (github.com/superKoder/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The ABOVE COPYRIGHT notice and this permission notice SHALL BE INCLUDED in all
+// copies or substantial portions of the Software.
+//
+// The software is provided "as is", without warranty of any kind, express or
+// implied, including but not limited to the warranties of merchantability,
+// fitness for a particular purpose and noninfringement. In no event shall the
+// authors or copyright holders be liable for any claim, damages or other
+// liability, whether in an action of contract, tort or otherwise, arising from,
+// out of or in connection with the software or the use or other dealings in the
+// software.
+
+#ifndef HANDY_MP_THREAD_POOL_H_
+#define HANDY_MP_THREAD_POOL_H_
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * A small pool of persistent worker threads.
+ *
+ * The pool is driven in batches: `RunAndWait()` hands out the indices
+ * [0, count) to the workers and to the calling thread, and only returns
+ * once every index has been processed. This makes every batch a barrier,
+ * which is what a frame is for MultiSystem.
+ */
+class ThreadPool
+{
+public:
+    using Job = std::function<void(size_t index)>;
+
+    /**
+     * Creates `workers` threads, in addition to the calling thread
+     * which always takes part in a batch.
+     */
+    explicit ThreadPool(unsigned workers);
+
+    ~ThreadPool();
+
+    ThreadPool(ThreadPool const &) = delete;
+    ThreadPool &operator=(ThreadPool const &) = delete;
+
+    unsigned WorkerCount() const;
+
+    void RunAndWait(size_t count, Job const &job);
+
+private:
+    void WorkerLoop();
+    void Drain();
+
+    std::vector<std::thread> workers_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_start_;
+    std::condition_variable cv_done_;
+
+    Job const *job_ = {};
+    size_t job_count_ = {};
+    std::atomic<size_t> next_index_ = {};
+    unsigned busy_workers_ = {};
+    uint64_t generation_ = {};
+    bool stopping_ = {};
+};
+
+#endif // HANDY_MP_THREAD_POOL_H_